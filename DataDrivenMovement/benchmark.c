@@ -0,0 +1,767 @@
+//------------------------------------------------------------------------------------
+// Headless benchmark for the simulation code, does not need raylib or a window.
+//
+// Build (Linux):   cc -O2 -o benchmark benchmark.c grid.c cell_grid.c bit_grid.c hashlife.c worker_pool.c entities.c spatial_grid.c -lpthread -lm
+// Build (MSVC):    cl /O2 benchmark.c grid.c cell_grid.c bit_grid.c hashlife.c worker_pool.c entities.c spatial_grid.c
+//
+// Usage:           benchmark [--quick] [--csv] [--threads N] [grid] [tracking] [hashlife] [entities] [spatial]
+//
+// Every case is warmed up, then timed over several repetitions; the median and the fastest
+// repetition are reported per step, together with the cost per cell or entity.
+// --csv prints one machine readable line per case, so runs on different commits can be diffed.
+// --threads caps the thread sweep (it defaults to the number of cores).
+// Suites first check their code paths against a reference and print mismatches on stderr.
+// Without suite names every suite runs.
+//------------------------------------------------------------------------------------
+
+// clock_gettime is POSIX, not plain C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "grid.h"
+#include "hashlife.h"
+#include "entities.h"
+#include "spatial_grid.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Repetitions are stretched to at least this long so short steps are not lost in timer noise
+#define BENCHMARK_MIN_REPETITION_SECONDS 0.005
+
+#define BENCHMARK_MAX_REPETITIONS 32
+
+struct BenchmarkSettings
+{
+    int bQuick;
+    int bCsv;
+    int MaxThreadsNum;
+    int WarmUpSteps;
+    int Repetitions;
+};
+
+// Seconds per step over the repetitions
+struct BenchmarkTiming
+{
+    double Median;
+    double Fastest;
+};
+
+typedef void (*BenchmarkStep)(void* Context);
+
+static struct BenchmarkSettings Settings;
+
+static double GetTimeSeconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER Frequency, Counter;
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&Counter);
+    return (double)Counter.QuadPart / (double)Frequency.QuadPart;
+#else
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec + Time.tv_nsec * 1e-9;
+#endif
+}
+
+static int CompareDoubles(const void* First, const void* Second)
+{
+    double A = *(const double*)First;
+    double B = *(const double*)Second;
+    return (A > B) - (A < B);
+}
+
+static struct BenchmarkTiming SummariseSamples(double* Samples, int SamplesNum)
+{
+    qsort(Samples, SamplesNum, sizeof(double), CompareDoubles);
+
+    struct BenchmarkTiming Timing;
+    Timing.Fastest = Samples[0];
+    Timing.Median = SamplesNum % 2 ? Samples[SamplesNum / 2] : 0.5 * (Samples[SamplesNum / 2 - 1] + Samples[SamplesNum / 2]);
+    return Timing;
+}
+
+// Warms up, picks how many steps make one repetition long enough, then times every repetition
+static struct BenchmarkTiming MeasureSteps(BenchmarkStep Step, void* Context)
+{
+    double StartTime = GetTimeSeconds();
+    for (int i = 0; i < Settings.WarmUpSteps; ++i)
+    {
+        Step(Context);
+    }
+    double WarmUpStepTime = (GetTimeSeconds() - StartTime) / Settings.WarmUpSteps;
+
+    int StepsPerRepetition = 1;
+    if (0.0 < WarmUpStepTime && WarmUpStepTime < BENCHMARK_MIN_REPETITION_SECONDS)
+    {
+        StepsPerRepetition = (int)ceil(BENCHMARK_MIN_REPETITION_SECONDS / WarmUpStepTime);
+    }
+
+    double Samples[BENCHMARK_MAX_REPETITIONS];
+    for (int Repetition = 0; Repetition < Settings.Repetitions; ++Repetition)
+    {
+        StartTime = GetTimeSeconds();
+        for (int i = 0; i < StepsPerRepetition; ++i)
+        {
+            Step(Context);
+        }
+        Samples[Repetition] = (GetTimeSeconds() - StartTime) / StepsPerRepetition;
+    }
+    return SummariseSamples(Samples, Settings.Repetitions);
+}
+
+static void PrintHeader(const char* Title)
+{
+    if (!Settings.bCsv)
+    {
+        printf("\n%s\n", Title);
+    }
+}
+
+// ItemsNum is the cells or entities processed by one step
+static void ReportTiming(const char* Suite, const char* Case, long long ItemsNum, int ThreadsNum,
+                         struct BenchmarkTiming Timing, const char* Notes)
+{
+    double NanosecondsPerItem = Timing.Median * 1e9 / ItemsNum;
+    double ItemsPerSecond = ItemsNum / Timing.Median;
+    if (Settings.bCsv)
+    {
+        printf("%s,%s,%lld,%d,%.6f,%.6f,%.4f,%.0f\n", Suite, Case, ItemsNum, ThreadsNum,
+               Timing.Median * 1e3, Timing.Fastest * 1e3, NanosecondsPerItem, ItemsPerSecond);
+        return;
+    }
+    printf("%-9s %-30s %10lld items %2d threads  median %10.3f ms  fastest %10.3f ms  %9.3f ns/item  %8.1f M/s  %s\n",
+           Suite, Case, ItemsNum, ThreadsNum, Timing.Median * 1e3, Timing.Fastest * 1e3,
+           NanosecondsPerItem, ItemsPerSecond * 1e-6, Notes == NULL ? "" : Notes);
+}
+
+// Self checks are reported on stderr so they never end up in the CSV
+static void ReportMismatches(const char* Suite, const char* Case, int MismatchesNum)
+{
+    if (MismatchesNum != 0)
+    {
+        fprintf(stderr, "%s %s: %d mismatches against the reference\n", Suite, Case, MismatchesNum);
+    }
+}
+
+// 1, 2, 4, ... up to the thread cap, plus the cap itself when it is not a power of two
+static int GetThreadCounts(int* ThreadCounts, int MaxCountsNum)
+{
+    int CountsNum = 0;
+    for (int Threads = 1; Threads <= Settings.MaxThreadsNum && CountsNum < MaxCountsNum; Threads *= 2)
+    {
+        ThreadCounts[CountsNum++] = Threads;
+    }
+    if (ThreadCounts[CountsNum - 1] != Settings.MaxThreadsNum && CountsNum < MaxCountsNum)
+    {
+        ThreadCounts[CountsNum++] = Settings.MaxThreadsNum;
+    }
+    return CountsNum;
+}
+
+//------------------------------------------------------------------------------------
+// Grid step: sizes x backends x threads
+//------------------------------------------------------------------------------------
+
+static void StepGrid(void* Context)
+{
+    GridStep((struct Grid*)Context);
+}
+
+static int GridMatchesReference(const struct Grid* Grid, const struct Grid* Reference)
+{
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        return BitGridMatchesCells(Grid->Bits, Reference->Cells);
+    }
+    for (int i = 0; i < Grid->Rows * Grid->Columns; ++i)
+    {
+        if (Grid->Cells[i].State != Reference->Cells[i].State)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Steps a grid next to a single threaded struct Cell grid from the same random boards and counts the
+// generations in which they differ. The size is not a multiple of the word or tile size, so the edges are covered
+static int CountGridMismatches(enum GridBackend Backend, int ThreadsNum, int bTracked)
+{
+    const int BOARDS_NUM = 3;
+    const int GENERATIONS_NUM = 200;
+    const int ROWS = 203;
+    const int COLUMNS = 317;
+
+    struct WorkerPool* Pool = CreateWorkerPool(ThreadsNum);
+    int MismatchesNum = 0;
+    for (int Board = 0; Board < BOARDS_NUM; ++Board)
+    {
+        srand(Board + 1);
+        struct Grid* Reference = GridCreate(ROWS, COLUMNS, GRID_BACKEND_CELLS);
+        srand(Board + 1);
+        struct Grid* Grid = GridCreate(ROWS, COLUMNS, Backend);
+        GridSetWorkerPool(Grid, Pool);
+        GridSetChangeTracking(Grid, bTracked);
+
+        for (int i = 0; i < GENERATIONS_NUM; ++i)
+        {
+            GridStep(Reference);
+            GridStep(Grid);
+            MismatchesNum += !GridMatchesReference(Grid, Reference);
+        }
+
+        GridDestroy(Grid);
+        GridDestroy(Reference);
+    }
+    DestroyWorkerPool(Pool);
+    return MismatchesNum;
+}
+
+// Every bit grid kernel the CPU has, one thread and the thread cap, and the struct Cell bands against one thread
+static void CheckGridBackends(void)
+{
+    const char* KERNEL_NAMES[] = {"auto", "scalar", "sse2", "avx2"};
+    int ThreadsNum = Settings.MaxThreadsNum < 2 ? 2 : Settings.MaxThreadsNum;
+    char Case[64];
+
+    snprintf(Case, sizeof(Case), "cells %d threads", ThreadsNum);
+    ReportMismatches("grid", Case, CountGridMismatches(GRID_BACKEND_CELLS, ThreadsNum, 0));
+
+    enum BitGridKernel PreviousKernel = GetBitGridKernel();
+    for (int Kernel = BIT_GRID_KERNEL_SCALAR; Kernel <= BIT_GRID_KERNEL_AVX2; ++Kernel)
+    {
+        SetBitGridKernel((enum BitGridKernel)Kernel);
+        if (GetBitGridKernel() != (enum BitGridKernel)Kernel)
+        {
+            continue;
+        }
+        snprintf(Case, sizeof(Case), "bits %s 1 thread", KERNEL_NAMES[Kernel]);
+        ReportMismatches("grid", Case, CountGridMismatches(GRID_BACKEND_BITS, 1, 0));
+        snprintf(Case, sizeof(Case), "bits %s %d threads", KERNEL_NAMES[Kernel], ThreadsNum);
+        ReportMismatches("grid", Case, CountGridMismatches(GRID_BACKEND_BITS, ThreadsNum, 0));
+    }
+    SetBitGridKernel(PreviousKernel);
+}
+
+static void BenchmarkGridSweep(void)
+{
+    // The struct Cell backend is far slower, so it stops at a smaller size
+    const int SIZES[] = {256, 1024, 4096};
+    const int CELLS_BACKEND_MAX_SIZE = 1024;
+
+    PrintHeader("Grid step (ns per cell)");
+    CheckGridBackends();
+
+    int ThreadCounts[16];
+    int ThreadCountsNum = GetThreadCounts(ThreadCounts, 16);
+    int SizesNum = Settings.bQuick ? 2 : 3;
+
+    for (int SizeIndex = 0; SizeIndex < SizesNum; ++SizeIndex)
+    {
+        int Size = SIZES[SizeIndex];
+        for (int Backend = GRID_BACKEND_CELLS; Backend <= GRID_BACKEND_BITS; ++Backend)
+        {
+            if (Backend == GRID_BACKEND_CELLS && CELLS_BACKEND_MAX_SIZE < Size)
+            {
+                continue;
+            }
+            for (int i = 0; i < ThreadCountsNum; ++i)
+            {
+                srand(1);
+                struct WorkerPool* Pool = CreateWorkerPool(ThreadCounts[i]);
+                struct Grid* Grid = GridCreate(Size, Size, (enum GridBackend)Backend);
+                GridSetWorkerPool(Grid, Pool);
+
+                char Case[64];
+                snprintf(Case, sizeof(Case), "%s %dx%d", Backend == GRID_BACKEND_BITS ? "bits" : "cells", Size, Size);
+                ReportTiming("grid", Case, (long long)Size * Size, ThreadCounts[i], MeasureSteps(StepGrid, Grid), NULL);
+
+                GridDestroy(Grid);
+                DestroyWorkerPool(Pool);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Change tracking: full against tracked steps of the same bit grid
+//------------------------------------------------------------------------------------
+
+// Empty board with a lattice of blocks (still lifes) and a patch of blinkers in one corner
+static void FillSettledBoard(struct Grid* Grid)
+{
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            GridSetCell(Grid, i, j, DEAD);
+        }
+    }
+    for (int i = 1; i + 1 < Grid->Rows; i += 8)
+    {
+        for (int j = 1; j + 1 < Grid->Columns; j += 8)
+        {
+            int bBlinker = i < Grid->Rows / 8 && j < Grid->Columns / 8;
+            GridSetCell(Grid, i, j, ALIVE);
+            GridSetCell(Grid, i, j + 1, ALIVE);
+            GridSetCell(Grid, bBlinker ? i : i + 1, bBlinker ? j + 2 : j, ALIVE);
+            if (!bBlinker)
+            {
+                GridSetCell(Grid, i + 1, j + 1, ALIVE);
+            }
+        }
+    }
+}
+
+static void BenchmarkChangeTracking(const char* Name, int Rows, int Columns, int SettleSteps, int bLattice)
+{
+    srand(1);
+    struct Grid* Grid = GridCreate(Rows, Columns, GRID_BACKEND_BITS);
+    if (bLattice)
+    {
+        FillSettledBoard(Grid);
+    }
+    for (int i = 0; i < SettleSteps; ++i)
+    {
+        GridStep(Grid);
+    }
+
+    char Case[64];
+    snprintf(Case, sizeof(Case), "%s full", Name);
+    ReportTiming("tracking", Case, (long long)Rows * Columns, 1, MeasureSteps(StepGrid, Grid), NULL);
+
+    // The warm-up also settles the tiles marked dirty by enabling tracking
+    GridSetChangeTracking(Grid, 1);
+    struct BenchmarkTiming Tracked = MeasureSteps(StepGrid, Grid);
+
+    char Notes[64];
+    snprintf(Notes, sizeof(Notes), "changed tiles %d/%d", GetBitGridChangedTilesNum(Grid->Bits),
+             Grid->Bits->TileRowsNum * Grid->Bits->TileColumnsNum);
+    snprintf(Case, sizeof(Case), "%s tracked", Name);
+    ReportTiming("tracking", Case, (long long)Rows * Columns, 1, Tracked, Notes);
+
+    GridDestroy(Grid);
+}
+
+static void BenchmarkChangeTrackingSuite(void)
+{
+    PrintHeader("Change tracking (bit grid, one thread)");
+    ReportMismatches("tracking", "tracked 1 thread", CountGridMismatches(GRID_BACKEND_BITS, 1, 1));
+    ReportMismatches("tracking", "tracked 4 threads", CountGridMismatches(GRID_BACKEND_BITS, 4, 1));
+    BenchmarkChangeTracking("random 2048", 2048, 2048, 0, 0);
+    BenchmarkChangeTracking("random 2048 settled", 2048, 2048, Settings.bQuick ? 300 : 3000, 0);
+    BenchmarkChangeTracking("still lifes 4096", 4096, 4096, 0, 1);
+}
+
+//------------------------------------------------------------------------------------
+// Hashlife: a fresh universe per repetition, since a repeated step would hit the cache
+//------------------------------------------------------------------------------------
+
+static void BenchmarkHashlife(int Size, int StepLog2, size_t MaxNodesNum)
+{
+    srand(1);
+    struct Grid* Grid = GridCreate(Size, Size, GRID_BACKEND_BITS);
+
+    int Repetitions = Settings.Repetitions < 3 ? Settings.Repetitions : 3;
+    double Samples[BENCHMARK_MAX_REPETITIONS];
+    size_t NodesNum = 0;
+    for (int Repetition = 0; Repetition < Repetitions; ++Repetition)
+    {
+        struct Hashlife* Universe = CreateHashlife(MaxNodesNum);
+        LoadHashlifeFromGrid(Universe, Grid);
+
+        double StartTime = GetTimeSeconds();
+        StepHashlife(Universe, StepLog2);
+        Samples[Repetition] = GetTimeSeconds() - StartTime;
+
+        NodesNum = Universe->NodesNum;
+        DestroyHashlife(Universe);
+    }
+
+    // One "item" is a cell of the starting board advanced by one generation
+    char Case[64];
+    char Notes[64];
+    snprintf(Case, sizeof(Case), "soup %dx%d 2^%d generations", Size, Size, StepLog2);
+    snprintf(Notes, sizeof(Notes), "nodes %zu", NodesNum);
+    ReportTiming("hashlife", Case, (long long)Size * Size << StepLog2, 1, SummariseSamples(Samples, Repetitions), Notes);
+
+    GridDestroy(Grid);
+}
+
+// A random patch in the middle of an empty board, with margins wider than the distance anything can travel
+// in the checked generations, so the unbounded plane and the flat grid have to agree. Two steps of 2^StepLog2
+// generations also cover the cached results. Returns the number of cells that differ
+static int CountHashlifeMismatches(int StepLog2)
+{
+    const int PATCH_SIZE = 48;
+    const int STEPS_NUM = 2;
+    int GenerationsNum = STEPS_NUM << StepLog2;
+    int Size = PATCH_SIZE + 2 * (GenerationsNum + 1);
+
+    srand(1);
+    struct Grid* Patch = GridCreate(PATCH_SIZE, PATCH_SIZE, GRID_BACKEND_BITS);
+    struct Grid* Reference = GridCreate(Size, Size, GRID_BACKEND_CELLS);
+    for (int i = 0; i < Size; ++i)
+    {
+        for (int j = 0; j < Size; ++j)
+        {
+            int PatchRow = i - GenerationsNum - 1;
+            int PatchColumn = j - GenerationsNum - 1;
+            int bInPatch = 0 <= PatchRow && PatchRow < PATCH_SIZE && 0 <= PatchColumn && PatchColumn < PATCH_SIZE;
+            GridSetCell(Reference, i, j, bInPatch ? GridGetCell(Patch, PatchRow, PatchColumn) : DEAD);
+        }
+    }
+
+    struct Hashlife* Universe = CreateHashlife(1000000);
+    LoadHashlifeFromGrid(Universe, Reference);
+    for (int i = 0; i < STEPS_NUM; ++i)
+    {
+        StepHashlife(Universe, StepLog2);
+    }
+    for (int i = 0; i < GenerationsNum; ++i)
+    {
+        GridStep(Reference);
+    }
+
+    struct Grid* Result = GridCreate(Size, Size, GRID_BACKEND_BITS);
+    StoreHashlifeToGrid(Universe, Result);
+    int MismatchesNum = 0;
+    for (int i = 0; i < Size; ++i)
+    {
+        for (int j = 0; j < Size; ++j)
+        {
+            MismatchesNum += GridGetCell(Result, i, j) != GridGetCell(Reference, i, j);
+        }
+    }
+
+    GridDestroy(Result);
+    DestroyHashlife(Universe);
+    GridDestroy(Reference);
+    GridDestroy(Patch);
+    return MismatchesNum;
+}
+
+static void BenchmarkHashlifeSuite(void)
+{
+    PrintHeader("Hashlife (unbounded plane)");
+    ReportMismatches("hashlife", "patch 2x2^0 generations", CountHashlifeMismatches(0));
+    ReportMismatches("hashlife", "patch 2x2^6 generations", CountHashlifeMismatches(6));
+    BenchmarkHashlife(256, 10, 4000000);
+    if (!Settings.bQuick)
+    {
+        BenchmarkHashlife(256, 16, 4000000);
+        BenchmarkHashlife(512, 11, 4000000);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Entities: layouts x counts x threads
+//------------------------------------------------------------------------------------
+
+#define BENCHMARK_BOUNDS_X 1600.0f
+#define BENCHMARK_BOUNDS_Y 900.0f
+#define BENCHMARK_DELTA_TIME 0.016f
+
+struct EntitiesContext
+{
+    struct EntityData* Entities;
+    int EntitiesNum;
+    struct EntityStore* Store;
+    struct WorkerPool* Pool;
+};
+
+static void StepEntityStructs(void* Context)
+{
+    struct EntitiesContext* Entities = (struct EntitiesContext*)Context;
+    UpdatePositions(Entities->Entities, Entities->EntitiesNum, BENCHMARK_DELTA_TIME, BENCHMARK_BOUNDS_X, BENCHMARK_BOUNDS_Y);
+}
+
+static void StepEntityColumns(void* Context)
+{
+    struct EntitiesContext* Entities = (struct EntitiesContext*)Context;
+    UpdateEntityStoreOnPool(Entities->Store, Entities->Pool, BENCHMARK_DELTA_TIME, BENCHMARK_BOUNDS_X, BENCHMARK_BOUNDS_Y);
+}
+
+// Both layouts run the same float operations, so after the same number of steps they agree exactly
+static int CountEntityMismatches(int EntitiesNum)
+{
+    const int STEPS_NUM = 100;
+
+    srand(1);
+    struct EntityData* Entities = CreateEntities(EntitiesNum, (int)BENCHMARK_BOUNDS_X, (int)BENCHMARK_BOUNDS_Y);
+    struct EntityStore* Store = CreateEntityStore(EntitiesNum);
+    LoadEntityStore(Store, Entities, EntitiesNum);
+    for (int i = 0; i < STEPS_NUM; ++i)
+    {
+        UpdatePositions(Entities, EntitiesNum, BENCHMARK_DELTA_TIME, BENCHMARK_BOUNDS_X, BENCHMARK_BOUNDS_Y);
+        UpdateEntityStore(Store, BENCHMARK_DELTA_TIME, BENCHMARK_BOUNDS_X, BENCHMARK_BOUNDS_Y);
+    }
+
+    int MismatchesNum = 0;
+    for (int i = 0; i < EntitiesNum; ++i)
+    {
+        struct EntityData Entity = GetEntity(Store, i);
+        MismatchesNum += Entity.positionX != Entities[i].positionX || Entity.positionY != Entities[i].positionY ||
+                         Entity.velocityX != Entities[i].velocityX || Entity.velocityY != Entities[i].velocityY;
+    }
+
+    DestroyEntityStore(Store);
+    free(Entities);
+    return MismatchesNum;
+}
+
+static void BenchmarkEntitiesSweep(void)
+{
+    const int COUNTS[] = {10000, 100000, 1000000, 4000000};
+
+    PrintHeader("Entities (ns per entity)");
+    ReportMismatches("entities", "structs against columns", CountEntityMismatches(10007));
+
+    int ThreadCounts[16];
+    int ThreadCountsNum = GetThreadCounts(ThreadCounts, 16);
+    int CountsNum = Settings.bQuick ? 3 : 4;
+
+    for (int CountIndex = 0; CountIndex < CountsNum; ++CountIndex)
+    {
+        struct EntitiesContext Context;
+        Context.EntitiesNum = COUNTS[CountIndex];
+        srand(1);
+        Context.Entities = CreateEntities(Context.EntitiesNum, (int)BENCHMARK_BOUNDS_X, (int)BENCHMARK_BOUNDS_Y);
+        Context.Store = CreateEntityStore(Context.EntitiesNum);
+        LoadEntityStore(Context.Store, Context.Entities, Context.EntitiesNum);
+        Context.Pool = NULL;
+
+        char Case[64];
+        snprintf(Case, sizeof(Case), "structs %d", Context.EntitiesNum);
+        ReportTiming("entities", Case, Context.EntitiesNum, 1, MeasureSteps(StepEntityStructs, &Context), NULL);
+
+        snprintf(Case, sizeof(Case), "columns %d", Context.EntitiesNum);
+        for (int i = 0; i < ThreadCountsNum; ++i)
+        {
+            Context.Pool = CreateWorkerPool(ThreadCounts[i]);
+            ReportTiming("entities", Case, Context.EntitiesNum, ThreadCounts[i], MeasureSteps(StepEntityColumns, &Context), NULL);
+            DestroyWorkerPool(Context.Pool);
+        }
+
+        DestroyEntityStore(Context.Store);
+        free(Context.Entities);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Spatial grid: rebuild, one neighbour query per entity and collisions, every frame.
+// The bounds grow with the entity count so the density stays the same
+//------------------------------------------------------------------------------------
+
+#define BENCHMARK_AREA_PER_ENTITY 100.0f
+#define BENCHMARK_MAX_NEIGHBOURS_NUM 256
+
+struct SpatialContext
+{
+    struct EntityStore* Store;
+    struct SpatialGrid* Grid;
+    float BoundsX;
+    float BoundsY;
+    float EntityRadius;
+    int bReorder;
+
+    // Accumulated over every frame, for the split between the phases
+    double PhaseTimes[3];
+    long long NeighboursNum;
+};
+
+static void StepSpatialFrame(void* Context)
+{
+    struct SpatialContext* Spatial = (struct SpatialContext*)Context;
+    int Neighbours[BENCHMARK_MAX_NEIGHBOURS_NUM];
+
+    double StartTime = GetTimeSeconds();
+    RebuildSpatialGrid(Spatial->Grid, Spatial->Store);
+    if (Spatial->bReorder)
+    {
+        ReorderEntityStoreByCell(Spatial->Grid, Spatial->Store);
+    }
+    double RebuiltTime = GetTimeSeconds();
+
+    for (int i = 0; i < Spatial->Store->EntitiesNum; ++i)
+    {
+        Spatial->NeighboursNum += QueryEntityNeighbours(Spatial->Grid, Spatial->Store, i, 2.0f * Spatial->EntityRadius,
+                                                        Neighbours, BENCHMARK_MAX_NEIGHBOURS_NUM);
+    }
+    double QueriedTime = GetTimeSeconds();
+
+    ResolveEntityCollisions(Spatial->Grid, Spatial->Store, Spatial->EntityRadius);
+    double CollidedTime = GetTimeSeconds();
+
+    UpdateEntityStore(Spatial->Store, BENCHMARK_DELTA_TIME, Spatial->BoundsX, Spatial->BoundsY);
+
+    Spatial->PhaseTimes[0] += RebuiltTime - StartTime;
+    Spatial->PhaseTimes[1] += QueriedTime - RebuiltTime;
+    Spatial->PhaseTimes[2] += CollidedTime - QueriedTime;
+}
+
+// Brute force check of a few queries against every entity
+static int CountSpatialMismatches(struct SpatialContext* Spatial)
+{
+    const int CHECKED_ENTITIES_NUM = 100;
+
+    struct EntityStore* Store = Spatial->Store;
+    float QueryRadius = 2.0f * Spatial->EntityRadius;
+    int Neighbours[BENCHMARK_MAX_NEIGHBOURS_NUM];
+
+    RebuildSpatialGrid(Spatial->Grid, Store);
+    int MismatchesNum = 0;
+    for (int i = 0; i < CHECKED_ENTITIES_NUM && i < Store->EntitiesNum; ++i)
+    {
+        int Expected = 0;
+        for (int j = 0; j < Store->EntitiesNum; ++j)
+        {
+            float DeltaX = Store->PositionX[j] - Store->PositionX[i];
+            float DeltaY = Store->PositionY[j] - Store->PositionY[i];
+            Expected += j != i && DeltaX * DeltaX + DeltaY * DeltaY <= QueryRadius * QueryRadius;
+        }
+        MismatchesNum += Expected != QueryEntityNeighbours(Spatial->Grid, Store, i, QueryRadius, Neighbours, BENCHMARK_MAX_NEIGHBOURS_NUM);
+    }
+    return MismatchesNum;
+}
+
+static void BenchmarkSpatialGrid(int EntitiesNum, float EntityRadius, int bReorder)
+{
+    struct SpatialContext Spatial;
+    Spatial.BoundsX = floorf(sqrtf(EntitiesNum * BENCHMARK_AREA_PER_ENTITY * 16.0f / 9.0f));
+    Spatial.BoundsY = floorf(Spatial.BoundsX * 9.0f / 16.0f);
+    Spatial.EntityRadius = EntityRadius;
+    Spatial.bReorder = bReorder;
+    Spatial.PhaseTimes[0] = Spatial.PhaseTimes[1] = Spatial.PhaseTimes[2] = 0.0;
+    Spatial.NeighboursNum = 0;
+
+    srand(1);
+    struct EntityData* Entities = CreateEntities(EntitiesNum, (int)Spatial.BoundsX, (int)Spatial.BoundsY);
+    Spatial.Store = CreateEntityStore(EntitiesNum);
+    LoadEntityStore(Spatial.Store, Entities, EntitiesNum);
+    free(Entities);
+
+    // Cells about one entity spacing wide, so a sparse scene does not sweep mostly empty cells
+    float CellSize = fmaxf(2.0f * EntityRadius, sqrtf(BENCHMARK_AREA_PER_ENTITY));
+    Spatial.Grid = CreateSpatialGrid(Spatial.BoundsX, Spatial.BoundsY, CellSize);
+
+    struct BenchmarkTiming Timing = MeasureSteps(StepSpatialFrame, &Spatial);
+
+    double TotalTime = Spatial.PhaseTimes[0] + Spatial.PhaseTimes[1] + Spatial.PhaseTimes[2];
+    char Case[64];
+    char Notes[96];
+    snprintf(Case, sizeof(Case), "frame %d%s", EntitiesNum, bReorder ? " reordered" : "");
+    snprintf(Notes, sizeof(Notes), "rebuild %.0f%%  queries %.0f%%  collisions %.0f%%",
+             100.0 * Spatial.PhaseTimes[0] / TotalTime, 100.0 * Spatial.PhaseTimes[1] / TotalTime,
+             100.0 * Spatial.PhaseTimes[2] / TotalTime);
+    ReportTiming("spatial", Case, EntitiesNum, 1, Timing, Notes);
+    ReportMismatches("spatial", Case, CountSpatialMismatches(&Spatial));
+
+    DestroySpatialGrid(Spatial.Grid);
+    DestroyEntityStore(Spatial.Store);
+}
+
+static void BenchmarkSpatialSuite(void)
+{
+    PrintHeader("Spatial grid (one thread, ns per entity per frame)");
+    BenchmarkSpatialGrid(100000, 2.0f, 0);
+    BenchmarkSpatialGrid(100000, 2.0f, 1);
+    if (!Settings.bQuick)
+    {
+        BenchmarkSpatialGrid(1000000, 2.0f, 0);
+        BenchmarkSpatialGrid(1000000, 2.0f, 1);
+    }
+}
+
+//------------------------------------------------------------------------------------
+
+struct BenchmarkSuite
+{
+    const char* Name;
+    void (*Run)(void);
+};
+
+int main(int ArgumentsNum, char** Arguments)
+{
+    const struct BenchmarkSuite SUITES[] = {
+        {"grid", BenchmarkGridSweep},
+        {"tracking", BenchmarkChangeTrackingSuite},
+        {"hashlife", BenchmarkHashlifeSuite},
+        {"entities", BenchmarkEntitiesSweep},
+        {"spatial", BenchmarkSpatialSuite},
+    };
+    const int SUITES_NUM = sizeof(SUITES) / sizeof(SUITES[0]);
+
+    Settings.bQuick = 0;
+    Settings.bCsv = 0;
+    Settings.MaxThreadsNum = GetCoresNum();
+
+    int bSelected[sizeof(SUITES) / sizeof(SUITES[0])] = {0};
+    int bAnySelected = 0;
+    for (int i = 1; i < ArgumentsNum; ++i)
+    {
+        if (strcmp(Arguments[i], "--quick") == 0)
+        {
+            Settings.bQuick = 1;
+        }
+        else if (strcmp(Arguments[i], "--csv") == 0)
+        {
+            Settings.bCsv = 1;
+        }
+        else if (strcmp(Arguments[i], "--threads") == 0 && i + 1 < ArgumentsNum)
+        {
+            Settings.MaxThreadsNum = atoi(Arguments[++i]);
+        }
+        else
+        {
+            int bKnown = 0;
+            for (int j = 0; j < SUITES_NUM; ++j)
+            {
+                if (strcmp(Arguments[i], SUITES[j].Name) == 0)
+                {
+                    bSelected[j] = bKnown = bAnySelected = 1;
+                }
+            }
+            if (!bKnown)
+            {
+                fprintf(stderr, "Unknown argument %s\n", Arguments[i]);
+                return 1;
+            }
+        }
+    }
+    Settings.MaxThreadsNum = Settings.MaxThreadsNum < 1 ? 1 : Settings.MaxThreadsNum;
+    Settings.WarmUpSteps = Settings.bQuick ? 2 : 5;
+    Settings.Repetitions = Settings.bQuick ? 3 : 9;
+
+    if (Settings.bCsv)
+    {
+        printf("suite,case,items,threads,median_ms,fastest_ms,ns_per_item,items_per_second\n");
+    }
+    else
+    {
+        const char* KERNEL_NAMES[] = {"auto", "scalar", "sse2", "avx2"};
+        printf("%d cores, %d warm-up steps, %d repetitions, bit grid kernel %s\n",
+               GetCoresNum(), Settings.WarmUpSteps, Settings.Repetitions, KERNEL_NAMES[GetBitGridKernel()]);
+    }
+
+    for (int i = 0; i < SUITES_NUM; ++i)
+    {
+        if (!bAnySelected || bSelected[i])
+        {
+            SUITES[i].Run();
+        }
+    }
+
+    return 0;
+}
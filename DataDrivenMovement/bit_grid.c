@@ -0,0 +1,551 @@
+#include "bit_grid.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BIT_GRID_HAS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define BIT_GRID_HAS_X86 0
+#endif
+
+// GCC and Clang only emit vector instructions inside functions marked for them,
+// MSVC allows the intrinsics anywhere
+#if BIT_GRID_HAS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define BIT_GRID_TARGET(Isa) __attribute__((target(Isa)))
+#else
+#define BIT_GRID_TARGET(Isa)
+#endif
+
+// The widest kernel works on 4 words at once, so every row is padded to a multiple of that
+#define BIT_GRID_CHUNK_WORDS 4
+
+static enum BitGridKernel ActiveKernel = BIT_GRID_KERNEL_AUTO;
+
+static uint64_t* GetRowWords(const struct BitGrid* Grid, uint64_t* Buffer, int Row)
+{
+    // +1 row for the zero row above the grid, +1 word for the zero word left of the row
+    return Buffer + (size_t)(Row + 1) * Grid->RowStride + 1;
+}
+
+static uint64_t GetTailMask(const struct BitGrid* Grid)
+{
+    int UsedBits = Grid->Columns % 64;
+    return UsedBits == 0 ? ~(uint64_t)0 : (((uint64_t)1 << UsedBits) - 1);
+}
+
+//------------------------------------------------------------------------------------
+// Step kernels
+// Each output bit is computed from the eight neighbour bits with a tree of bitwise
+// full adders, so one word operation updates 64 cells at once.
+// West/East neighbours are produced by shifting the row by one bit and carrying the
+// edge bit over from the previous/next word.
+//------------------------------------------------------------------------------------
+
+static uint64_t ComputeNextWord(uint64_t UpWest, uint64_t Up, uint64_t UpEast,
+                                uint64_t West, uint64_t Alive, uint64_t East,
+                                uint64_t DownWest, uint64_t Down, uint64_t DownEast)
+{
+    // Summing the neighbours in groups of three, three and two
+    uint64_t UpXor = UpWest ^ Up;
+    uint64_t UpOnes = UpXor ^ UpEast;
+    uint64_t UpTwos = (UpWest & Up) | (UpEast & UpXor);
+
+    uint64_t SideXor = West ^ East;
+    uint64_t SideOnes = SideXor ^ DownWest;
+    uint64_t SideTwos = (West & East) | (DownWest & SideXor);
+
+    uint64_t DownOnes = Down ^ DownEast;
+    uint64_t DownTwos = Down & DownEast;
+
+    // Adding the ones of every group together
+    uint64_t OnesXor = UpOnes ^ SideOnes;
+    uint64_t Ones = OnesXor ^ DownOnes;
+    uint64_t OnesCarry = (UpOnes & SideOnes) | (DownOnes & OnesXor);
+
+    // Adding the four twos together, anything that reaches four is enough to kill the cell
+    uint64_t TwosXor = UpTwos ^ SideTwos;
+    uint64_t TwosPartial = TwosXor ^ DownTwos;
+    uint64_t FoursFirst = (UpTwos & SideTwos) | (DownTwos & TwosXor);
+    uint64_t Twos = TwosPartial ^ OnesCarry;
+    uint64_t FoursSecond = TwosPartial & OnesCarry;
+    uint64_t FoursOrMore = FoursFirst | FoursSecond;
+
+    // Alive with 2 or 3 neighbours stays alive, dead with exactly 3 becomes alive
+    return Twos & ~FoursOrMore & (Ones | Alive);
+}
+
+static void StepRowScalar(const uint64_t* UpRow, const uint64_t* MidRow, const uint64_t* DownRow, uint64_t* OutRow, int WordsNum)
+{
+    for (int i = 0; i < WordsNum; ++i)
+    {
+        uint64_t Up = UpRow[i];
+        uint64_t Mid = MidRow[i];
+        uint64_t Down = DownRow[i];
+        OutRow[i] = ComputeNextWord(
+            (Up << 1) | (UpRow[i - 1] >> 63), Up, (Up >> 1) | (UpRow[i + 1] << 63),
+            (Mid << 1) | (MidRow[i - 1] >> 63), Mid, (Mid >> 1) | (MidRow[i + 1] << 63),
+            (Down << 1) | (DownRow[i - 1] >> 63), Down, (Down >> 1) | (DownRow[i + 1] << 63));
+    }
+}
+
+#if BIT_GRID_HAS_X86
+
+BIT_GRID_TARGET("sse2")
+static __m128i ComputeNextWordsSse2(__m128i UpWest, __m128i Up, __m128i UpEast,
+                                    __m128i West, __m128i Alive, __m128i East,
+                                    __m128i DownWest, __m128i Down, __m128i DownEast)
+{
+    __m128i UpXor = _mm_xor_si128(UpWest, Up);
+    __m128i UpOnes = _mm_xor_si128(UpXor, UpEast);
+    __m128i UpTwos = _mm_or_si128(_mm_and_si128(UpWest, Up), _mm_and_si128(UpEast, UpXor));
+
+    __m128i SideXor = _mm_xor_si128(West, East);
+    __m128i SideOnes = _mm_xor_si128(SideXor, DownWest);
+    __m128i SideTwos = _mm_or_si128(_mm_and_si128(West, East), _mm_and_si128(DownWest, SideXor));
+
+    __m128i DownOnes = _mm_xor_si128(Down, DownEast);
+    __m128i DownTwos = _mm_and_si128(Down, DownEast);
+
+    __m128i OnesXor = _mm_xor_si128(UpOnes, SideOnes);
+    __m128i Ones = _mm_xor_si128(OnesXor, DownOnes);
+    __m128i OnesCarry = _mm_or_si128(_mm_and_si128(UpOnes, SideOnes), _mm_and_si128(DownOnes, OnesXor));
+
+    __m128i TwosXor = _mm_xor_si128(UpTwos, SideTwos);
+    __m128i TwosPartial = _mm_xor_si128(TwosXor, DownTwos);
+    __m128i FoursFirst = _mm_or_si128(_mm_and_si128(UpTwos, SideTwos), _mm_and_si128(DownTwos, TwosXor));
+    __m128i Twos = _mm_xor_si128(TwosPartial, OnesCarry);
+    __m128i FoursSecond = _mm_and_si128(TwosPartial, OnesCarry);
+    __m128i FoursOrMore = _mm_or_si128(FoursFirst, FoursSecond);
+
+    return _mm_and_si128(_mm_andnot_si128(FoursOrMore, Twos), _mm_or_si128(Ones, Alive));
+}
+
+BIT_GRID_TARGET("sse2")
+static void LoadShiftedSse2(const uint64_t* Row, int Index, __m128i* West, __m128i* Centre, __m128i* East)
+{
+    __m128i Previous = _mm_loadu_si128((const __m128i*)(Row + Index - 1));
+    __m128i Current = _mm_loadu_si128((const __m128i*)(Row + Index));
+    __m128i Next = _mm_loadu_si128((const __m128i*)(Row + Index + 1));
+    *West = _mm_or_si128(_mm_slli_epi64(Current, 1), _mm_srli_epi64(Previous, 63));
+    *Centre = Current;
+    *East = _mm_or_si128(_mm_srli_epi64(Current, 1), _mm_slli_epi64(Next, 63));
+}
+
+BIT_GRID_TARGET("sse2")
+static void StepRowSse2(const uint64_t* UpRow, const uint64_t* MidRow, const uint64_t* DownRow, uint64_t* OutRow, int WordsNum)
+{
+    for (int i = 0; i < WordsNum; i += 2)
+    {
+        __m128i UpWest, Up, UpEast, West, Mid, East, DownWest, Down, DownEast;
+        LoadShiftedSse2(UpRow, i, &UpWest, &Up, &UpEast);
+        LoadShiftedSse2(MidRow, i, &West, &Mid, &East);
+        LoadShiftedSse2(DownRow, i, &DownWest, &Down, &DownEast);
+        __m128i Next = ComputeNextWordsSse2(UpWest, Up, UpEast, West, Mid, East, DownWest, Down, DownEast);
+        _mm_storeu_si128((__m128i*)(OutRow + i), Next);
+    }
+}
+
+BIT_GRID_TARGET("avx2")
+static __m256i ComputeNextWordsAvx2(__m256i UpWest, __m256i Up, __m256i UpEast,
+                                    __m256i West, __m256i Alive, __m256i East,
+                                    __m256i DownWest, __m256i Down, __m256i DownEast)
+{
+    __m256i UpXor = _mm256_xor_si256(UpWest, Up);
+    __m256i UpOnes = _mm256_xor_si256(UpXor, UpEast);
+    __m256i UpTwos = _mm256_or_si256(_mm256_and_si256(UpWest, Up), _mm256_and_si256(UpEast, UpXor));
+
+    __m256i SideXor = _mm256_xor_si256(West, East);
+    __m256i SideOnes = _mm256_xor_si256(SideXor, DownWest);
+    __m256i SideTwos = _mm256_or_si256(_mm256_and_si256(West, East), _mm256_and_si256(DownWest, SideXor));
+
+    __m256i DownOnes = _mm256_xor_si256(Down, DownEast);
+    __m256i DownTwos = _mm256_and_si256(Down, DownEast);
+
+    __m256i OnesXor = _mm256_xor_si256(UpOnes, SideOnes);
+    __m256i Ones = _mm256_xor_si256(OnesXor, DownOnes);
+    __m256i OnesCarry = _mm256_or_si256(_mm256_and_si256(UpOnes, SideOnes), _mm256_and_si256(DownOnes, OnesXor));
+
+    __m256i TwosXor = _mm256_xor_si256(UpTwos, SideTwos);
+    __m256i TwosPartial = _mm256_xor_si256(TwosXor, DownTwos);
+    __m256i FoursFirst = _mm256_or_si256(_mm256_and_si256(UpTwos, SideTwos), _mm256_and_si256(DownTwos, TwosXor));
+    __m256i Twos = _mm256_xor_si256(TwosPartial, OnesCarry);
+    __m256i FoursSecond = _mm256_and_si256(TwosPartial, OnesCarry);
+    __m256i FoursOrMore = _mm256_or_si256(FoursFirst, FoursSecond);
+
+    return _mm256_and_si256(_mm256_andnot_si256(FoursOrMore, Twos), _mm256_or_si256(Ones, Alive));
+}
+
+BIT_GRID_TARGET("avx2")
+static void LoadShiftedAvx2(const uint64_t* Row, int Index, __m256i* West, __m256i* Centre, __m256i* East)
+{
+    __m256i Previous = _mm256_loadu_si256((const __m256i*)(Row + Index - 1));
+    __m256i Current = _mm256_loadu_si256((const __m256i*)(Row + Index));
+    __m256i Next = _mm256_loadu_si256((const __m256i*)(Row + Index + 1));
+    *West = _mm256_or_si256(_mm256_slli_epi64(Current, 1), _mm256_srli_epi64(Previous, 63));
+    *Centre = Current;
+    *East = _mm256_or_si256(_mm256_srli_epi64(Current, 1), _mm256_slli_epi64(Next, 63));
+}
+
+BIT_GRID_TARGET("avx2")
+static void StepRowAvx2(const uint64_t* UpRow, const uint64_t* MidRow, const uint64_t* DownRow, uint64_t* OutRow, int WordsNum)
+{
+    for (int i = 0; i < WordsNum; i += 4)
+    {
+        __m256i UpWest, Up, UpEast, West, Mid, East, DownWest, Down, DownEast;
+        LoadShiftedAvx2(UpRow, i, &UpWest, &Up, &UpEast);
+        LoadShiftedAvx2(MidRow, i, &West, &Mid, &East);
+        LoadShiftedAvx2(DownRow, i, &DownWest, &Down, &DownEast);
+        __m256i Next = ComputeNextWordsAvx2(UpWest, Up, UpEast, West, Mid, East, DownWest, Down, DownEast);
+        _mm256_storeu_si256((__m256i*)(OutRow + i), Next);
+    }
+}
+
+#endif
+
+static enum BitGridKernel DetectBitGridKernel(void)
+{
+#if BIT_GRID_HAS_X86
+#if defined(_MSC_VER)
+    int CpuInfo[4];
+    __cpuid(CpuInfo, 0);
+    int MaxLeaf = CpuInfo[0];
+    __cpuid(CpuInfo, 1);
+    int HasSse2 = (CpuInfo[3] >> 26) & 1;
+    // AVX registers are only usable if the OS saves them (OSXSAVE + XCR0 bits)
+    int HasOsAvx = ((CpuInfo[2] >> 27) & 1) && ((CpuInfo[2] >> 28) & 1) && ((_xgetbv(0) & 6) == 6);
+    if (HasOsAvx && 7 <= MaxLeaf)
+    {
+        __cpuidex(CpuInfo, 7, 0);
+        if ((CpuInfo[1] >> 5) & 1)
+        {
+            return BIT_GRID_KERNEL_AVX2;
+        }
+    }
+    if (HasSse2)
+    {
+        return BIT_GRID_KERNEL_SSE2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return BIT_GRID_KERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return BIT_GRID_KERNEL_SSE2;
+    }
+#endif
+#endif
+    return BIT_GRID_KERNEL_SCALAR;
+}
+
+void SetBitGridKernel(enum BitGridKernel Kernel)
+{
+    enum BitGridKernel SupportedKernel = DetectBitGridKernel();
+
+    // Never select an instruction set the CPU does not have
+    ActiveKernel = (Kernel == BIT_GRID_KERNEL_AUTO || SupportedKernel < Kernel) ? SupportedKernel : Kernel;
+}
+
+enum BitGridKernel GetBitGridKernel(void)
+{
+    if (ActiveKernel == BIT_GRID_KERNEL_AUTO)
+    {
+        SetBitGridKernel(BIT_GRID_KERNEL_AUTO);
+    }
+    return ActiveKernel;
+}
+
+//------------------------------------------------------------------------------------
+// Grid
+//------------------------------------------------------------------------------------
+
+static void MarkAllBitGridTilesChanged(struct BitGrid* Grid)
+{
+    memset(Grid->ChangedTiles, 1, Grid->TileRowsNum * Grid->TileColumnsNum);
+}
+
+struct BitGrid* CreateBitGrid(int Rows, int Columns)
+{
+    struct BitGrid* Grid = (struct BitGrid*)malloc(sizeof(struct BitGrid));
+    Grid->Rows = Rows;
+    Grid->Columns = Columns;
+    Grid->WordsPerRow = (Columns + 63) / 64;
+
+    int PaddedWordsPerRow = (Grid->WordsPerRow + BIT_GRID_CHUNK_WORDS - 1) / BIT_GRID_CHUNK_WORDS * BIT_GRID_CHUNK_WORDS;
+    Grid->RowStride = PaddedWordsPerRow + 2;
+
+    size_t WordsNum = (size_t)(Rows + 2) * Grid->RowStride;
+    Grid->Words = (uint64_t*)calloc(WordsNum, sizeof(uint64_t));
+    Grid->NextWords = (uint64_t*)calloc(WordsNum, sizeof(uint64_t));
+
+    Grid->bTrackChanges = 0;
+    Grid->TileRowsNum = (Rows + BIT_GRID_TILE_ROWS - 1) / BIT_GRID_TILE_ROWS;
+    Grid->TileColumnsNum = PaddedWordsPerRow / BIT_GRID_CHUNK_WORDS;
+    Grid->ChangedTiles = (uint8_t*)malloc(Grid->TileRowsNum * Grid->TileColumnsNum);
+    Grid->NextChangedTiles = (uint8_t*)malloc(Grid->TileRowsNum * Grid->TileColumnsNum);
+    MarkAllBitGridTilesChanged(Grid);
+
+    // Resolving the kernel here keeps worker threads from racing on the first lookup
+    GetBitGridKernel();
+
+    return Grid;
+}
+
+void DestroyBitGrid(struct BitGrid* Grid)
+{
+    if (Grid == NULL)
+    {
+        return;
+    }
+    free(Grid->Words);
+    free(Grid->NextWords);
+    free(Grid->ChangedTiles);
+    free(Grid->NextChangedTiles);
+    free(Grid);
+}
+
+enum CellState GetBitGridCell(const struct BitGrid* Grid, int Row, int Column)
+{
+    uint64_t Word = GetRowWords(Grid, Grid->Words, Row)[Column / 64];
+    return ((Word >> (Column % 64)) & 1) ? ALIVE : DEAD;
+}
+
+const uint64_t* GetBitGridRow(const struct BitGrid* Grid, int Row)
+{
+    return GetRowWords(Grid, Grid->Words, Row);
+}
+
+void SetBitGridCell(struct BitGrid* Grid, int Row, int Column, enum CellState State)
+{
+    uint64_t* Word = &GetRowWords(Grid, Grid->Words, Row)[Column / 64];
+    uint64_t Bit = (uint64_t)1 << (Column % 64);
+    *Word = (State == ALIVE) ? (*Word | Bit) : (*Word & ~Bit);
+
+    Grid->ChangedTiles[(Row / BIT_GRID_TILE_ROWS) * Grid->TileColumnsNum + Column / 64 / BIT_GRID_CHUNK_WORDS] = 1;
+}
+
+void LoadBitGridFromCells(struct BitGrid* Grid, const struct Cell* Cells)
+{
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        uint64_t* RowWords = GetRowWords(Grid, Grid->Words, i);
+        memset(RowWords, 0, Grid->WordsPerRow * sizeof(uint64_t));
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            if (Cells[i * Grid->Columns + j].State == ALIVE)
+            {
+                RowWords[j / 64] |= (uint64_t)1 << (j % 64);
+            }
+        }
+    }
+
+    MarkAllBitGridTilesChanged(Grid);
+}
+
+void StoreBitGridToCells(const struct BitGrid* Grid, struct Cell* Cells)
+{
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            Cells[i * Grid->Columns + j].State = GetBitGridCell(Grid, i, j);
+        }
+    }
+}
+
+int BitGridMatchesCells(const struct BitGrid* Grid, const struct Cell* Cells)
+{
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            if (Cells[i * Grid->Columns + j].State != GetBitGridCell(Grid, i, j))
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+typedef void (*BitGridRowKernel)(const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*, int);
+
+static BitGridRowKernel GetBitGridRowKernel(void)
+{
+#if BIT_GRID_HAS_X86
+    switch (GetBitGridKernel())
+    {
+        case BIT_GRID_KERNEL_AVX2: return StepRowAvx2;
+        case BIT_GRID_KERNEL_SSE2: return StepRowSse2;
+        default: break;
+    }
+#endif
+    return StepRowScalar;
+}
+
+// Steps WordsNum words of one row starting at WordBegin (a multiple of the chunk size)
+static void StepBitGridRowWords(struct BitGrid* Grid, BitGridRowKernel StepRow, int Row, int WordBegin, int WordsNum)
+{
+    uint64_t* OutRow = GetRowWords(Grid, Grid->NextWords, Row);
+    StepRow(GetRowWords(Grid, Grid->Words, Row - 1) + WordBegin,
+            GetRowWords(Grid, Grid->Words, Row) + WordBegin,
+            GetRowWords(Grid, Grid->Words, Row + 1) + WordBegin,
+            OutRow + WordBegin, WordsNum);
+
+    // Cells past the last column must stay dead, otherwise they would leak back in as neighbours
+    int WordEnd = WordBegin + WordsNum;
+    if (Grid->WordsPerRow <= WordEnd)
+    {
+        int LastWord = Grid->WordsPerRow - 1;
+        if (WordBegin <= LastWord)
+        {
+            OutRow[LastWord] &= GetTailMask(Grid);
+        }
+        int ClearBegin = WordBegin < Grid->WordsPerRow ? Grid->WordsPerRow : WordBegin;
+        memset(OutRow + ClearBegin, 0, (WordEnd - ClearBegin) * sizeof(uint64_t));
+    }
+}
+
+static int IsBitGridTileNeighbourhoodChanged(const struct BitGrid* Grid, int TileRow, int TileColumn)
+{
+    for (int i = TileRow - 1; i <= TileRow + 1; ++i)
+    {
+        if (i < 0 || Grid->TileRowsNum <= i)
+        {
+            continue;
+        }
+        for (int j = TileColumn - 1; j <= TileColumn + 1; ++j)
+        {
+            if (j < 0 || Grid->TileColumnsNum <= j)
+            {
+                continue;
+            }
+            if (Grid->ChangedTiles[i * Grid->TileColumnsNum + j])
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Steps a run of neighbouring tiles in one tile row with one kernel call per cell row,
+// then records for every tile of the run whether any of its cells changed
+static void StepBitGridTilesRun(struct BitGrid* Grid, BitGridRowKernel StepRow, int TileRow, int TileColumnBegin, int TileColumnEnd)
+{
+    int RowBegin = TileRow * BIT_GRID_TILE_ROWS;
+    int RowEnd = RowBegin + BIT_GRID_TILE_ROWS < Grid->Rows ? RowBegin + BIT_GRID_TILE_ROWS : Grid->Rows;
+    int WordBegin = TileColumnBegin * BIT_GRID_CHUNK_WORDS;
+    int WordsNum = (TileColumnEnd - TileColumnBegin) * BIT_GRID_CHUNK_WORDS;
+
+    for (int i = RowBegin; i < RowEnd; ++i)
+    {
+        StepBitGridRowWords(Grid, StepRow, i, WordBegin, WordsNum);
+    }
+
+    for (int j = TileColumnBegin; j < TileColumnEnd; ++j)
+    {
+        uint64_t Difference = 0;
+        for (int i = RowBegin; i < RowEnd; ++i)
+        {
+            const uint64_t* OldWords = GetRowWords(Grid, Grid->Words, i) + j * BIT_GRID_CHUNK_WORDS;
+            const uint64_t* NewWords = GetRowWords(Grid, Grid->NextWords, i) + j * BIT_GRID_CHUNK_WORDS;
+            for (int k = 0; k < BIT_GRID_CHUNK_WORDS; ++k)
+            {
+                Difference |= OldWords[k] ^ NewWords[k];
+            }
+        }
+        Grid->NextChangedTiles[TileRow * Grid->TileColumnsNum + j] = Difference != 0;
+    }
+}
+
+// Only tiles next to a change are stepped. A skipped tile did not change last generation,
+// so the back buffer already holds its current state and nothing has to be copied
+static void UpdateBitGridTiles(struct BitGrid* Grid, BitGridRowKernel StepRow, int RowBegin, int RowEnd)
+{
+    int TileRowBegin = RowBegin / BIT_GRID_TILE_ROWS;
+    int TileRowEnd = (RowEnd + BIT_GRID_TILE_ROWS - 1) / BIT_GRID_TILE_ROWS;
+
+    for (int i = TileRowBegin; i < TileRowEnd; ++i)
+    {
+        int j = 0;
+        while (j < Grid->TileColumnsNum)
+        {
+            if (!IsBitGridTileNeighbourhoodChanged(Grid, i, j))
+            {
+                Grid->NextChangedTiles[i * Grid->TileColumnsNum + j] = 0;
+                ++j;
+                continue;
+            }
+
+            int RunEnd = j + 1;
+            while (RunEnd < Grid->TileColumnsNum && IsBitGridTileNeighbourhoodChanged(Grid, i, RunEnd))
+            {
+                ++RunEnd;
+            }
+            StepBitGridTilesRun(Grid, StepRow, i, j, RunEnd);
+            j = RunEnd;
+        }
+    }
+}
+
+void UpdateBitGridRows(struct BitGrid* Grid, int RowBegin, int RowEnd)
+{
+    BitGridRowKernel StepRow = GetBitGridRowKernel();
+
+    if (Grid->bTrackChanges)
+    {
+        UpdateBitGridTiles(Grid, StepRow, RowBegin, RowEnd);
+        return;
+    }
+
+    // Vector kernels run over the whole padded row
+    for (int i = RowBegin; i < RowEnd; ++i)
+    {
+        StepBitGridRowWords(Grid, StepRow, i, 0, Grid->RowStride - 2);
+    }
+}
+
+void SwapBitGridBuffers(struct BitGrid* Grid)
+{
+    uint64_t* PreviousWords = Grid->Words;
+    Grid->Words = Grid->NextWords;
+    Grid->NextWords = PreviousWords;
+
+    if (Grid->bTrackChanges)
+    {
+        uint8_t* PreviousChangedTiles = Grid->ChangedTiles;
+        Grid->ChangedTiles = Grid->NextChangedTiles;
+        Grid->NextChangedTiles = PreviousChangedTiles;
+    }
+}
+
+void SetBitGridChangeTracking(struct BitGrid* Grid, int bEnabled)
+{
+    Grid->bTrackChanges = bEnabled;
+
+    // The back buffer is only known to match the front one for tiles that were tracked
+    MarkAllBitGridTilesChanged(Grid);
+}
+
+int GetBitGridChangedTilesNum(const struct BitGrid* Grid)
+{
+    int ChangedTilesNum = 0;
+    for (int i = 0; i < Grid->TileRowsNum * Grid->TileColumnsNum; ++i)
+    {
+        ChangedTilesNum += Grid->ChangedTiles[i];
+    }
+    return ChangedTilesNum;
+}
+
+void UpdateBitGrid(struct BitGrid* Grid)
+{
+    UpdateBitGridRows(Grid, 0, Grid->Rows);
+    SwapBitGridBuffers(Grid);
+}
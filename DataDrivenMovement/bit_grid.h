@@ -0,0 +1,90 @@
+#ifndef BIT_GRID_H
+#define BIT_GRID_H
+
+#include <stdint.h>
+#include "cell_grid.h"
+
+//------------------------------------------------------------------------------------
+// Bit-packed Game of Life grid: one bit per cell, 64 cells per word.
+// Cells outside the grid are always dead, same as in the struct Cell version.
+//------------------------------------------------------------------------------------
+
+// Height of a change-tracking tile. A tile is as wide as one vector chunk (4 words = 256 cells)
+#define BIT_GRID_TILE_ROWS 32
+
+// Which implementation of the word-parallel step is used
+enum BitGridKernel
+{
+    BIT_GRID_KERNEL_AUTO,
+    BIT_GRID_KERNEL_SCALAR,
+    BIT_GRID_KERNEL_SSE2,
+    BIT_GRID_KERNEL_AVX2
+};
+
+struct BitGrid
+{
+    int Rows;
+    int Columns;
+
+    // Number of words that actually hold cells in a row
+    int WordsPerRow;
+
+    // Number of words between two rows in memory. Every row has a zero word on both sides
+    // and is padded so the vector kernels can always work on whole chunks
+    int RowStride;
+
+    // Current generation, with one zero row above and below the grid
+    uint64_t* Words;
+
+    // Buffer the next generation is written to, swapped with Words after each step
+    uint64_t* NextWords;
+
+    // Change tracking: only tiles next to a tile that changed last generation are stepped
+    int bTrackChanges;
+    int TileRowsNum;
+    int TileColumnsNum;
+    uint8_t* ChangedTiles;
+    uint8_t* NextChangedTiles;
+};
+
+struct BitGrid* CreateBitGrid(int Rows, int Columns);
+
+void DestroyBitGrid(struct BitGrid* Grid);
+
+enum CellState GetBitGridCell(const struct BitGrid* Grid, int Row, int Column);
+
+// Words of one row of the current generation, bit (Column % 64) of word (Column / 64) is the cell
+const uint64_t* GetBitGridRow(const struct BitGrid* Grid, int Row);
+
+void SetBitGridCell(struct BitGrid* Grid, int Row, int Column, enum CellState State);
+
+// Conversion from and to the struct Cell grid (Cells[Row * Columns + Column])
+void LoadBitGridFromCells(struct BitGrid* Grid, const struct Cell* Cells);
+
+void StoreBitGridToCells(const struct BitGrid* Grid, struct Cell* Cells);
+
+// Returns 1 if every cell of the bit grid has the same state as in Cells, otherwise 0
+int BitGridMatchesCells(const struct BitGrid* Grid, const struct Cell* Cells);
+
+// Advances the grid by one generation
+void UpdateBitGrid(struct BitGrid* Grid);
+
+// Writes rows [RowBegin, RowEnd) of the next generation into NextWords, reading only Words.
+// Different row ranges can be computed on different threads; SwapBitGridBuffers then publishes them.
+// With change tracking on, the ranges have to start and end on BIT_GRID_TILE_ROWS boundaries (or the last row)
+void UpdateBitGridRows(struct BitGrid* Grid, int RowBegin, int RowEnd);
+
+void SwapBitGridBuffers(struct BitGrid* Grid);
+
+// Turns tile change tracking on or off, so settled regions of the board are not recomputed
+void SetBitGridChangeTracking(struct BitGrid* Grid, int bEnabled);
+
+// Number of tiles that changed during the last generation
+int GetBitGridChangedTilesNum(const struct BitGrid* Grid);
+
+// Kernel selection. AUTO picks the widest instruction set the CPU supports
+void SetBitGridKernel(enum BitGridKernel Kernel);
+
+enum BitGridKernel GetBitGridKernel(void);
+
+#endif
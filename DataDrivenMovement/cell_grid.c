@@ -0,0 +1,80 @@
+#include "cell_grid.h"
+#include <stdlib.h>
+
+struct Cell* CreateCellsGrid(int Rows, int Columns)
+{
+    struct Cell* Cells;
+    Cells = (struct Cell*)malloc(Rows * Columns * sizeof(struct Cell));
+    for (int i = 0; i < Rows; ++i){
+        for (int j = 0; j < Columns; ++j){
+            struct Cell NewCell;
+            NewCell.Row = i;
+            NewCell.Column = j;
+
+            int RandomNumber = rand() % 10;
+            NewCell.State = RandomNumber < 2 ? ALIVE : DEAD;
+            Cells[i * Columns + j] = NewCell;
+        }
+    }
+
+    return Cells;
+}
+
+int GetCellAliveNeighborsNum(const struct Cell* Cells, int CellIndex, int CellRowsNum, int CellsColumnNum)
+{
+    struct Cell TargetCell = Cells[CellIndex];
+    int AliveNeighborsNum = 0;
+    for (int i = TargetCell.Row - 1; i <= TargetCell.Row + 1; ++i)
+    {
+        if (i < 0 || CellRowsNum <= i)
+        {
+            continue;
+        }
+        for (int j = TargetCell.Column - 1; j <= TargetCell.Column + 1; ++j)
+        {
+            if (j < 0 || CellsColumnNum <= j)
+            {
+                continue;
+            }
+            if (i == TargetCell.Row && j == TargetCell.Column)
+            {
+                continue;
+            }
+            if (Cells[i * CellsColumnNum + j].State == ALIVE)
+            {
+                ++AliveNeighborsNum;
+            }
+
+        }
+    }
+
+    return AliveNeighborsNum;
+}
+
+void UpdateCells(const struct Cell* Cells, struct Cell* UpdatedCells, int CellsRowNum, int CellsColumnNum)
+{
+    UpdateCellsRows(Cells, UpdatedCells, CellsRowNum, CellsColumnNum, 0, CellsRowNum);
+}
+
+void UpdateCellsRows(const struct Cell* Cells, struct Cell* UpdatedCells, int CellsRowNum, int CellsColumnNum, int RowBegin, int RowEnd)
+{
+    for (int i = RowBegin; i < RowEnd; ++i)
+    {
+        for (int j = 0; j < CellsColumnNum; ++j)
+        {
+            enum CellState State = Cells[i * CellsColumnNum + j].State;
+            int AliveNeighborsNum = GetCellAliveNeighborsNum(Cells, i * CellsColumnNum + j, CellsRowNum, CellsColumnNum);
+            if (State == ALIVE){
+                if (AliveNeighborsNum < 2 || 3 < AliveNeighborsNum )
+                {
+                    State = DEAD;
+                }
+            }
+
+            else if (AliveNeighborsNum == 3){
+                State = ALIVE;
+            }
+            UpdatedCells[i * CellsColumnNum + j].State = State;
+        }
+    }
+}
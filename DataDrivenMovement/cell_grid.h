@@ -0,0 +1,34 @@
+#ifndef CELL_GRID_H
+#define CELL_GRID_H
+
+//------------------------------------------------------------------------------------
+// Reference Game of Life grid: one struct Cell per cell.
+// Kept as the readable baseline that the faster backends are checked against.
+//------------------------------------------------------------------------------------
+
+enum CellState
+{
+    ALIVE,
+    DEAD
+};
+
+//struct for cells
+struct Cell
+{
+    int Row;
+    int Column;
+    enum CellState State;
+};
+
+struct Cell* CreateCellsGrid(int Rows, int Columns);
+
+int GetCellAliveNeighborsNum(const struct Cell* Cells, int CellIndex, int CellRowsNum, int CellsColumnNum);
+
+// Writes the next generation of Cells into UpdatedCells. Both buffers must already hold
+// the Row/Column of every cell, only the State is written
+void UpdateCells(const struct Cell* Cells, struct Cell* UpdatedCells, int CellsRowNum, int CellsColumnNum);
+
+// Same as UpdateCells but only for rows [RowBegin, RowEnd), so bands can be updated on separate threads
+void UpdateCellsRows(const struct Cell* Cells, struct Cell* UpdatedCells, int CellsRowNum, int CellsColumnNum, int RowBegin, int RowEnd);
+
+#endif
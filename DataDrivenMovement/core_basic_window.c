@@ -2,217 +2,152 @@
 
 #include "raylib.h"
 #include <time.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "grid.h"
+#include "entities.h"
+#include "spatial_grid.h"
+#include "render.h"
+#include "simulation.h"
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
 
 const int ENTITIES_MAX = 5;
+const float ENTITY_RADIUS = 10.0f;
 const int SCREEN_WIDTH = 1600;
 const int SCREEN_HEIGHT = 900;
 
 const int CELLS_ROWS_MAX = 160;
 const int CELLS_COLUMNS_MAX = 90;
 
-// Struct for entity data (position and velocity)
-struct EntityData
-{
-    float positionX;
-    float positionY;
-    float positionZ;
-    float velocityX;
-    float velocityY;
-    float velocityZ;
-};
+// Switches the simulation between the struct Cell grid and the bit-packed grid
+const enum GridBackend CELLS_BACKEND = GRID_BACKEND_BITS;
 
+// Threads used for the grid step, including the main one (0 uses every core, 1 keeps it single-threaded)
+const int WORKER_THREADS_NUM = 0;
 
-void UpdatePositions(struct EntityData* Entities, int EntitiesNum, float DeltaTime)
-{
-    for (int i = 0; i < EntitiesNum; ++i){
-        Entities[i].positionX += Entities[i].velocityX * DeltaTime;
-        if (Entities[i].positionX < 0 || SCREEN_WIDTH < Entities[i].positionX){
-            Entities[i].velocityX *= -1;
-        }
-        Entities[i].positionY += Entities[i].velocityY * DeltaTime;
-        if (Entities[i].positionY < 0 || SCREEN_HEIGHT < Entities[i].positionY){
-            Entities[i].velocityY *= -1;
-        }
-        Entities[i].positionZ += Entities[i].velocityZ * DeltaTime;
-    }
-}
+// One draw call per cell and entity, or the whole grid as one texture and the entities as one sprite batch
+const enum RenderMode RENDER_MODE = RENDER_MODE_BATCHED;
+
+// Fixed simulation rate (one grid generation per tick), independent of the frame rate below
+const int SIMULATION_STEPS_PER_SECOND = 60;
+const int MAX_SIMULATION_STEPS_PER_FRAME = 8;
+const int TARGET_FPS = 30;
 
-struct EntityData* CreateEntities(int EntitiesNum)
+// Draws the grid and the entities without BeginDrawing/EndDrawing, so the caller picks the target
+void DrawScene(enum RenderMode Mode, const struct Grid* Cells, struct GridTexture* CellsTexture,
+               const struct EntityStore* Entities, Texture2D EntitySprite, int CellSizeX, int CellSizeY)
 {
-    struct EntityData* Entities;
-    Entities = (struct EntityData*)malloc(EntitiesNum * sizeof(struct EntityData));
-    for (int i = 0; i < EntitiesNum; ++i){
-        struct EntityData Entity;
-        Entity.positionX = rand() % SCREEN_WIDTH;
-        Entity.positionY = rand() % SCREEN_HEIGHT;
-        Entity.positionZ = 0;
-        Entity.velocityX = rand() % 10 - 20;
-        Entity.velocityY = rand() % 10 - 20;
-        Entity.velocityZ = 0.1;
-        
-        Entities[i] = Entity;
-        
+    ClearBackground(LIGHTGRAY);
+    if (Mode == RENDER_MODE_BATCHED)
+    {
+        DrawGridTexture(CellsTexture, Cells, CellSizeX, CellSizeY);
+        DrawEntitiesBatched(Entities, EntitySprite, ENTITY_RADIUS, RED);
     }
-    
-    return Entities;
-};
-
-void DrawEntities(struct EntityData* Entities, int EntitiesNum){
-    for (int i = 0; i < EntitiesNum; ++i)
+    else
     {
-        DrawCircle(Entities[i].positionX, Entities[i].positionY, 10, RED );
+        DrawCellsGrid(Cells, CellSizeX, CellSizeY);
+        DrawEntities(Entities, ENTITY_RADIUS);
     }
 }
 
-
-enum CellState 
-{
-    ALIVE,
-    DEAD
-};
-
-
-
-//struct for cells 
-struct Cell
+void DrawSimulationStats(const struct Simulation* Simulation)
 {
-    int Row;
-    int Column;
-    enum CellState State;
-};
-
-struct Cell* CreateCellsGrid(int Rows, int Columns)
-{
-    struct Cell* Cells;
-    Cells = (struct Cell*)malloc(Rows * Columns * sizeof(struct Cell));
-    for (int i = 0; i < Rows; ++i){
-        for (int j = 0; j < Columns; ++j){
-            struct Cell NewCell;
-            NewCell.Row = i;
-            NewCell.Column = j;
-            
-            int RandomNumber = rand() % 10;
-            NewCell.State = RandomNumber < 2 ? ALIVE : DEAD;
-            Cells[i * Columns + j] = NewCell;
-        }
-    }
-    
-    return Cells;
+    struct SimulationStats Stats;
+    GetSimulationStats(Simulation, &Stats);
+    DrawText(TextFormat("frame %.2f ms (max %.2f)  %.1f ticks/frame  %.0f generations/s  dropped %.2f s",
+                        Stats.AverageFrameSeconds * 1e3, Stats.MaxFrameSeconds * 1e3, Stats.StepsPerFrame,
+                        Stats.GenerationsPerSecond, Stats.DroppedSeconds),
+             10, 10, 20, DARKBLUE);
 }
 
-int GetCellAliveNeighborsNum(struct Cell* Cells, int CellIndex, int CellRowsNum, int CellsColumnNum)
+// Renders FramesNum frames of every mode into an offscreen target and never presents them,
+// so the draw cost can be measured with a hidden window (e.g. on a CI machine under Xvfb).
+// The time is what the CPU spends building and submitting the frame
+void RunOffscreenBenchmark(int FramesNum, struct Grid* Cells, struct GridTexture* CellsTexture,
+                           struct EntityStore* Entities, Texture2D EntitySprite, int CellSizeX, int CellSizeY)
 {
-    struct Cell TargetCell = Cells[CellIndex];
-    int AliveNeighborsNum = 0;
-    for (int i = TargetCell.Row - 1; i <= TargetCell.Row + 1; ++i)
-    {
-        if (i < 0 || CellRowsNum <= i)
-        {
-            continue;
-        }
-        for (int j = TargetCell.Column - 1; j <= TargetCell.Column + 1; ++j)
-        {
-            if (j < 0 || CellsColumnNum <= j)
-            {
-                continue;
-            }
-            if (i == TargetCell.Row && j == TargetCell.Column)
-            {
-                continue;
-            }
-            if (Cells[i * CellsColumnNum + j].State == ALIVE)
-            {
-                ++AliveNeighborsNum;
-            }
-            
-        }
-    }
-    
-    return AliveNeighborsNum;
-}
+    const char* MODE_NAMES[] = {"immediate", "batched"};
 
-void UpdateCells(struct Cell* Cells, int CellsRowNum, int CellsColumnNum)
-{
-    struct Cell* UpdatedCells = (struct Cell*)malloc(CellsColumnNum * CellsRowNum * sizeof(struct Cell));
-    
-    for (int i = 0; i < CellsRowNum; ++i)
-    {
-        for (int j = 0; j < CellsColumnNum; ++j)
-        {
-            UpdatedCells[i * CellsColumnNum + j] = Cells[i * CellsColumnNum + j];
-            int AliveNeighborsNum = GetCellAliveNeighborsNum(Cells, i * CellsColumnNum + j, CellsRowNum, CellsColumnNum);
-            if (UpdatedCells[i * CellsColumnNum + j].State == ALIVE){
-                if (AliveNeighborsNum < 2 || 3 < AliveNeighborsNum )
-                {
-                    UpdatedCells[i * CellsColumnNum + j].State = DEAD;
-                }
-            }
-            
-            else if (AliveNeighborsNum == 3){
-                UpdatedCells[i * CellsColumnNum + j].State = ALIVE;
-            }
-        }
-    }
-    for (int i = 0; i < CellsRowNum; ++i)
+    RenderTexture2D Target = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (int Mode = RENDER_MODE_IMMEDIATE; Mode <= RENDER_MODE_BATCHED; ++Mode)
     {
-        for (int j = 0; j < CellsColumnNum; ++j)
+        double DrawTime = 0.0;
+        for (int Frame = 0; Frame < FramesNum; ++Frame)
         {
-            Cells[i * CellsColumnNum + j].State = UpdatedCells[i * CellsColumnNum + j].State;
-        }
-    }
-    
-    free(UpdatedCells);
-    
-}
+            GridStep(Cells);
 
-
-void DrawCells(struct Cell* Cells, int CellsNum, int CellSizeX, int CellSizeY)
-{
-    for (int i = 0; i < CellsNum; ++i)
-    {
-        Color CellColor = (Cells[i].State == ALIVE) ? RAYWHITE : BLACK;
-        int X_Coordinate = Cells[i].Row * CellSizeX + CellSizeX / 2;
-        int Y_Coordinate = Cells[i].Column * CellSizeY + CellSizeY / 2;
-        DrawRectangle(X_Coordinate, Y_Coordinate, CellSizeX, CellSizeY, CellColor);
+            double StartTime = GetTime();
+            BeginTextureMode(Target);
+            DrawScene((enum RenderMode)Mode, Cells, CellsTexture, Entities, EntitySprite, CellSizeX, CellSizeY);
+            EndTextureMode();
+            DrawTime += GetTime() - StartTime;
+        }
+        printf("%-9s %d frames  %.3f ms per frame  (%d cells, %d entities)\n", MODE_NAMES[Mode], FramesNum,
+               DrawTime * 1e3 / FramesNum, Cells->Rows * Cells->Columns, Entities->EntitiesNum);
     }
+    UnloadRenderTexture(Target);
 }
 
-int main(void)
+int main(int ArgumentsNum, char** Arguments)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
    
     srand(time(NULL));
 
+    // --offscreen N renders N frames per render mode into a hidden window, prints the timings and exits
+    int OffscreenFramesNum = 0;
+    if (ArgumentsNum == 3 && strcmp(Arguments[1], "--offscreen") == 0)
+    {
+        OffscreenFramesNum = atoi(Arguments[2]);
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    }
+
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "raylib [core] example - basic window");
 
-    SetTargetFPS(30);               // Set our game to run at 60 frames-per-second
+    SetTargetFPS(TARGET_FPS);
     //--------------------------------------------------------------------------------------
-    struct EntityData* Entities = CreateEntities(ENTITIES_MAX);
-    struct Cell* Cells = CreateCellsGrid(CELLS_ROWS_MAX, CELLS_COLUMNS_MAX);
+    struct EntityData* StartingEntities = CreateEntities(ENTITIES_MAX, SCREEN_WIDTH, SCREEN_HEIGHT);
+    struct EntityStore* Entities = CreateEntityStore(ENTITIES_MAX);
+    LoadEntityStore(Entities, StartingEntities, ENTITIES_MAX);
+    free(StartingEntities);
+    struct SpatialGrid* EntitiesGrid = CreateSpatialGrid(SCREEN_WIDTH, SCREEN_HEIGHT, 2.0f * ENTITY_RADIUS);
+    struct WorkerPool* Pool = CreateWorkerPool(WORKER_THREADS_NUM);
+    struct Grid* Cells = GridCreate(CELLS_ROWS_MAX, CELLS_COLUMNS_MAX, CELLS_BACKEND);
+    GridSetWorkerPool(Cells, Pool);
     
     
     const int CellSizeX = SCREEN_WIDTH / CELLS_ROWS_MAX;
     const int CellSizeY = SCREEN_HEIGHT / CELLS_COLUMNS_MAX;
+    struct GridTexture* CellsTexture = CreateGridTexture(Cells);
+    Texture2D EntitySprite = LoadEntitySprite();
+    struct Simulation* Simulation = CreateSimulation(Cells, Entities, EntitiesGrid, SCREEN_WIDTH, SCREEN_HEIGHT, ENTITY_RADIUS,
+                                                     SIMULATION_STEPS_PER_SECOND, MAX_SIMULATION_STEPS_PER_FRAME);
+
+    if (0 < OffscreenFramesNum)
+    {
+        RunOffscreenBenchmark(OffscreenFramesNum, Cells, CellsTexture, Entities, EntitySprite, CellSizeX, CellSizeY);
+    }
+
     // Main game loop
-    while (!WindowShouldClose())    // Detect window close button or ESC key
+    double PreviousFrameTime = GetTime();
+    while (OffscreenFramesNum == 0 && !WindowShouldClose())    // Detect window close button or ESC key
     {
-        
-        UpdatePositions(Entities, ENTITIES_MAX, 0.016);
-        UpdateCells(Cells, CELLS_ROWS_MAX, CELLS_COLUMNS_MAX);
+        double FrameTime = GetTime();
+        AdvanceSimulation(Simulation, FrameTime - PreviousFrameTime);
+        PreviousFrameTime = FrameTime;
+        struct EntityStore InterpolatedEntities = GetInterpolatedEntities(Simulation);
         
         
         // Draw
         //----------------------------------------------------------------------------------
         BeginDrawing();
-        ClearBackground(LIGHTGRAY);
-        //DrawEntities(Entities, ENTITIES_MAX);
-        DrawCells(Cells, CELLS_ROWS_MAX * CELLS_COLUMNS_MAX, CellSizeX, CellSizeY);
+        DrawScene(RENDER_MODE, Cells, CellsTexture, &InterpolatedEntities, EntitySprite, CellSizeX, CellSizeY);
+        DrawSimulationStats(Simulation);
         
 
             //DrawText("Congrats! You created your first window!", 190, 200, 20, LIGHTGRAY);
@@ -226,8 +161,14 @@ int main(void)
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    UnloadTexture(EntitySprite);
+    DestroyGridTexture(CellsTexture);
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
-    free(Entities);
+    DestroySimulation(Simulation);
+    DestroySpatialGrid(EntitiesGrid);
+    DestroyEntityStore(Entities);
+    GridDestroy(Cells);
+    DestroyWorkerPool(Pool);
     return 0;
 }
\ No newline at end of file
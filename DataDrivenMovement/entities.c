@@ -0,0 +1,248 @@
+#include "entities.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// SSE2 is part of every x86-64 CPU, so this path needs no runtime check
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP)
+#define ENTITIES_HAS_SSE2 1
+#include <emmintrin.h>
+#else
+#define ENTITIES_HAS_SSE2 0
+#endif
+
+#define ENTITY_STORE_COLUMNS_NUM 6
+
+// Below this many entities waking the workers costs more than the update itself
+#define ENTITIES_PARALLEL_MIN_NUM 65536
+
+// More ranges than threads, so a slow range does not hold everyone else up
+#define ENTITIES_RANGES_PER_THREAD 4
+
+struct EntityRangesJob
+{
+    struct EntityStore* Store;
+    int RangesNum;
+    float DeltaTime;
+    float BoundsX;
+    float BoundsY;
+};
+
+//------------------------------------------------------------------------------------
+// Array of structs
+//------------------------------------------------------------------------------------
+
+struct EntityData* CreateEntities(int EntitiesNum, int BoundsX, int BoundsY)
+{
+    struct EntityData* Entities;
+    Entities = (struct EntityData*)malloc(EntitiesNum * sizeof(struct EntityData));
+    for (int i = 0; i < EntitiesNum; ++i){
+        struct EntityData Entity;
+        Entity.positionX = rand() % BoundsX;
+        Entity.positionY = rand() % BoundsY;
+        Entity.positionZ = 0;
+        Entity.velocityX = rand() % 10 - 20;
+        Entity.velocityY = rand() % 10 - 20;
+        Entity.velocityZ = 0.1;
+
+        Entities[i] = Entity;
+    }
+
+    return Entities;
+}
+
+void UpdatePositions(struct EntityData* Entities, int EntitiesNum, float DeltaTime, float BoundsX, float BoundsY)
+{
+    for (int i = 0; i < EntitiesNum; ++i){
+        Entities[i].positionX += Entities[i].velocityX * DeltaTime;
+        if (Entities[i].positionX < 0 || BoundsX < Entities[i].positionX){
+            Entities[i].velocityX *= -1;
+        }
+        Entities[i].positionY += Entities[i].velocityY * DeltaTime;
+        if (Entities[i].positionY < 0 || BoundsY < Entities[i].positionY){
+            Entities[i].velocityY *= -1;
+        }
+        Entities[i].positionZ += Entities[i].velocityZ * DeltaTime;
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Structure of arrays
+//------------------------------------------------------------------------------------
+
+struct EntityStore* CreateEntityStore(int Capacity)
+{
+    const int FLOATS_PER_BLOCK = ENTITY_STORE_ALIGNMENT / sizeof(float);
+
+    struct EntityStore* Store = (struct EntityStore*)malloc(sizeof(struct EntityStore));
+    Store->EntitiesNum = 0;
+    Store->Capacity = (Capacity + FLOATS_PER_BLOCK - 1) / FLOATS_PER_BLOCK * FLOATS_PER_BLOCK;
+
+    // One block with room to slide the first column onto an aligned address
+    size_t ColumnBytes = (size_t)Store->Capacity * sizeof(float);
+    Store->Memory = calloc(ENTITY_STORE_COLUMNS_NUM * ColumnBytes + ENTITY_STORE_ALIGNMENT, 1);
+    uintptr_t Address = ((uintptr_t)Store->Memory + ENTITY_STORE_ALIGNMENT - 1) & ~(uintptr_t)(ENTITY_STORE_ALIGNMENT - 1);
+
+    float* Columns = (float*)Address;
+    Store->PositionX = Columns;
+    Store->PositionY = Columns + Store->Capacity;
+    Store->PositionZ = Columns + 2 * (size_t)Store->Capacity;
+    Store->VelocityX = Columns + 3 * (size_t)Store->Capacity;
+    Store->VelocityY = Columns + 4 * (size_t)Store->Capacity;
+    Store->VelocityZ = Columns + 5 * (size_t)Store->Capacity;
+
+    return Store;
+}
+
+void DestroyEntityStore(struct EntityStore* Store)
+{
+    if (Store == NULL)
+    {
+        return;
+    }
+    free(Store->Memory);
+    free(Store);
+}
+
+int AddEntity(struct EntityStore* Store, const struct EntityData* Entity)
+{
+    if (Store->Capacity <= Store->EntitiesNum)
+    {
+        return -1;
+    }
+
+    int Index = Store->EntitiesNum++;
+    Store->PositionX[Index] = Entity->positionX;
+    Store->PositionY[Index] = Entity->positionY;
+    Store->PositionZ[Index] = Entity->positionZ;
+    Store->VelocityX[Index] = Entity->velocityX;
+    Store->VelocityY[Index] = Entity->velocityY;
+    Store->VelocityZ[Index] = Entity->velocityZ;
+    return Index;
+}
+
+void LoadEntityStore(struct EntityStore* Store, const struct EntityData* Entities, int EntitiesNum)
+{
+    Store->EntitiesNum = 0;
+    for (int i = 0; i < EntitiesNum && i < Store->Capacity; ++i)
+    {
+        AddEntity(Store, &Entities[i]);
+    }
+}
+
+struct EntityData GetEntity(const struct EntityStore* Store, int Index)
+{
+    struct EntityData Entity;
+    Entity.positionX = Store->PositionX[Index];
+    Entity.positionY = Store->PositionY[Index];
+    Entity.positionZ = Store->PositionZ[Index];
+    Entity.velocityX = Store->VelocityX[Index];
+    Entity.velocityY = Store->VelocityY[Index];
+    Entity.velocityZ = Store->VelocityZ[Index];
+    return Entity;
+}
+
+// Moves one axis and flips the velocity of everything outside [0, Bounds].
+// The flip is a multiplication by +1 or -1, the same result as the branchy `*= -1`
+static void IntegrateAxisScalar(float* Position, float* Velocity, int Begin, int End, float DeltaTime, float Bounds)
+{
+    for (int i = Begin; i < End; ++i)
+    {
+        float NewPosition = Position[i] + Velocity[i] * DeltaTime;
+        int bOutside = (NewPosition < 0.0f) | (Bounds < NewPosition);
+        Position[i] = NewPosition;
+        Velocity[i] *= 1.0f - 2.0f * (float)bOutside;
+    }
+}
+
+#if ENTITIES_HAS_SSE2
+
+// Four entities at a time; the comparison masks select the sign bit that gets flipped
+static int IntegrateAxisSse2(float* Position, float* Velocity, int Begin, int End, float DeltaTime, float Bounds)
+{
+    const __m128 Zero = _mm_setzero_ps();
+    const __m128 SignBit = _mm_set1_ps(-0.0f);
+    const __m128 Delta = _mm_set1_ps(DeltaTime);
+    const __m128 Limit = _mm_set1_ps(Bounds);
+
+    int i = Begin;
+    for (; i + 4 <= End; i += 4)
+    {
+        __m128 Velocities = _mm_loadu_ps(Velocity + i);
+        __m128 Positions = _mm_add_ps(_mm_loadu_ps(Position + i), _mm_mul_ps(Velocities, Delta));
+        __m128 Outside = _mm_or_ps(_mm_cmplt_ps(Positions, Zero), _mm_cmplt_ps(Limit, Positions));
+        _mm_storeu_ps(Position + i, Positions);
+        _mm_storeu_ps(Velocity + i, _mm_xor_ps(Velocities, _mm_and_ps(Outside, SignBit)));
+    }
+    return i;
+}
+
+static int IntegrateSse2(float* Position, const float* Velocity, int Begin, int End, float DeltaTime)
+{
+    const __m128 Delta = _mm_set1_ps(DeltaTime);
+
+    int i = Begin;
+    for (; i + 4 <= End; i += 4)
+    {
+        __m128 Positions = _mm_add_ps(_mm_loadu_ps(Position + i), _mm_mul_ps(_mm_loadu_ps(Velocity + i), Delta));
+        _mm_storeu_ps(Position + i, Positions);
+    }
+    return i;
+}
+
+#endif
+
+void UpdateEntityStoreRange(struct EntityStore* Store, int Begin, int End, float DeltaTime, float BoundsX, float BoundsY)
+{
+    // Vector loops stop at the last whole group of four, the scalar loops finish the rest
+    int TailX = Begin;
+    int TailY = Begin;
+    int TailZ = Begin;
+#if ENTITIES_HAS_SSE2
+    TailX = IntegrateAxisSse2(Store->PositionX, Store->VelocityX, Begin, End, DeltaTime, BoundsX);
+    TailY = IntegrateAxisSse2(Store->PositionY, Store->VelocityY, Begin, End, DeltaTime, BoundsY);
+    TailZ = IntegrateSse2(Store->PositionZ, Store->VelocityZ, Begin, End, DeltaTime);
+#endif
+    IntegrateAxisScalar(Store->PositionX, Store->VelocityX, TailX, End, DeltaTime, BoundsX);
+    IntegrateAxisScalar(Store->PositionY, Store->VelocityY, TailY, End, DeltaTime, BoundsY);
+    for (int i = TailZ; i < End; ++i)
+    {
+        Store->PositionZ[i] += Store->VelocityZ[i] * DeltaTime;
+    }
+}
+
+void UpdateEntityStore(struct EntityStore* Store, float DeltaTime, float BoundsX, float BoundsY)
+{
+    UpdateEntityStoreRange(Store, 0, Store->EntitiesNum, DeltaTime, BoundsX, BoundsY);
+}
+
+static void UpdateEntityRange(void* Context, int RangeIndex)
+{
+    struct EntityRangesJob* Job = (struct EntityRangesJob*)Context;
+
+    // Ranges start on whole aligned blocks, so no two threads write the same cache line
+    const int FLOATS_PER_BLOCK = ENTITY_STORE_ALIGNMENT / sizeof(float);
+    int BlocksNum = (Job->Store->EntitiesNum + FLOATS_PER_BLOCK - 1) / FLOATS_PER_BLOCK;
+    int Begin = (int)((long long)BlocksNum * RangeIndex / Job->RangesNum) * FLOATS_PER_BLOCK;
+    int End = (int)((long long)BlocksNum * (RangeIndex + 1) / Job->RangesNum) * FLOATS_PER_BLOCK;
+    End = Job->Store->EntitiesNum < End ? Job->Store->EntitiesNum : End;
+
+    UpdateEntityStoreRange(Job->Store, Begin, End, Job->DeltaTime, Job->BoundsX, Job->BoundsY);
+}
+
+void UpdateEntityStoreOnPool(struct EntityStore* Store, struct WorkerPool* Pool, float DeltaTime, float BoundsX, float BoundsY)
+{
+    int ThreadsNum = GetWorkerPoolThreadsNum(Pool);
+    if (ThreadsNum <= 1 || Store->EntitiesNum < ENTITIES_PARALLEL_MIN_NUM)
+    {
+        UpdateEntityStore(Store, DeltaTime, BoundsX, BoundsY);
+        return;
+    }
+
+    struct EntityRangesJob Job;
+    Job.Store = Store;
+    Job.RangesNum = ThreadsNum * ENTITIES_RANGES_PER_THREAD;
+    Job.DeltaTime = DeltaTime;
+    Job.BoundsX = BoundsX;
+    Job.BoundsY = BoundsY;
+    RunWorkerPoolTasks(Pool, UpdateEntityRange, &Job, Job.RangesNum);
+}
@@ -0,0 +1,72 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include "worker_pool.h"
+
+//------------------------------------------------------------------------------------
+// Moving entities that bounce off the edges of a BoundsX x BoundsY rectangle.
+// struct EntityData is the original array-of-structs layout, kept as the baseline.
+// struct EntityStore keeps every attribute in its own aligned column (structure of arrays),
+// so the update reads and writes whole vectors without gathering fields out of structs.
+//------------------------------------------------------------------------------------
+
+// Struct for entity data (position and velocity)
+struct EntityData
+{
+    float positionX;
+    float positionY;
+    float positionZ;
+    float velocityX;
+    float velocityY;
+    float velocityZ;
+};
+
+// Random positions inside the bounds, filled from the current rand() state
+struct EntityData* CreateEntities(int EntitiesNum, int BoundsX, int BoundsY);
+
+void UpdatePositions(struct EntityData* Entities, int EntitiesNum, float DeltaTime, float BoundsX, float BoundsY);
+
+// Column alignment in bytes, wide enough for a cache line and any vector register
+#define ENTITY_STORE_ALIGNMENT 64
+
+struct EntityStore
+{
+    int EntitiesNum;
+
+    // Columns are allocated for this many entities, rounded up to whole aligned blocks
+    int Capacity;
+
+    float* PositionX;
+    float* PositionY;
+    float* PositionZ;
+    float* VelocityX;
+    float* VelocityY;
+    float* VelocityZ;
+
+    // Single allocation all columns live in
+    void* Memory;
+};
+
+struct EntityStore* CreateEntityStore(int Capacity);
+
+void DestroyEntityStore(struct EntityStore* Store);
+
+// Appends an entity, returns its index or -1 if the store is full
+int AddEntity(struct EntityStore* Store, const struct EntityData* Entity);
+
+// Replaces the content of the store with a copy of the entities (at most Capacity of them)
+void LoadEntityStore(struct EntityStore* Store, const struct EntityData* Entities, int EntitiesNum);
+
+struct EntityData GetEntity(const struct EntityStore* Store, int Index);
+
+// Same movement and bounce rule as UpdatePositions, without branches
+void UpdateEntityStore(struct EntityStore* Store, float DeltaTime, float BoundsX, float BoundsY);
+
+// Same as UpdateEntityStore but only for entities [Begin, End), so ranges can be updated on separate threads
+void UpdateEntityStoreRange(struct EntityStore* Store, int Begin, int End, float DeltaTime, float BoundsX, float BoundsY);
+
+// UpdateEntityStore split into ranges run on the pool. Entities do not affect each other here,
+// so the result is identical to the single-threaded update
+void UpdateEntityStoreOnPool(struct EntityStore* Store, struct WorkerPool* Pool, float DeltaTime, float BoundsX, float BoundsY);
+
+#endif
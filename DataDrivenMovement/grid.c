@@ -0,0 +1,142 @@
+#include "grid.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Below this many cells waking the workers costs more than the step itself
+#define GRID_PARALLEL_MIN_CELLS (256 * 256)
+
+// More bands than threads, so a slow band does not hold everyone else up
+#define GRID_BANDS_PER_THREAD 4
+
+struct GridBandsJob
+{
+    struct Grid* Grid;
+    int BandsNum;
+    int RowsAlignment;
+};
+
+static void UpdateGridBand(void* Context, int BandIndex)
+{
+    struct GridBandsJob* Job = (struct GridBandsJob*)Context;
+    struct Grid* Grid = Job->Grid;
+
+    // Bands start on a whole number of alignment units (tile rows for the bit grid)
+    int UnitsNum = (Grid->Rows + Job->RowsAlignment - 1) / Job->RowsAlignment;
+    int RowBegin = (int)((long long)UnitsNum * BandIndex / Job->BandsNum) * Job->RowsAlignment;
+    int RowEnd = (int)((long long)UnitsNum * (BandIndex + 1) / Job->BandsNum) * Job->RowsAlignment;
+    RowEnd = Grid->Rows < RowEnd ? Grid->Rows : RowEnd;
+
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        UpdateBitGridRows(Grid->Bits, RowBegin, RowEnd);
+    }
+    else
+    {
+        UpdateCellsRows(Grid->Cells, Grid->UpdatedCells, Grid->Rows, Grid->Columns, RowBegin, RowEnd);
+    }
+}
+
+struct Grid* GridCreate(int Rows, int Columns, enum GridBackend Backend)
+{
+    struct Grid* Grid = (struct Grid*)malloc(sizeof(struct Grid));
+    Grid->Backend = Backend;
+    Grid->Rows = Rows;
+    Grid->Columns = Columns;
+    Grid->Generation = 0;
+    Grid->Cells = NULL;
+    Grid->UpdatedCells = NULL;
+    Grid->Bits = NULL;
+    Grid->Pool = NULL;
+
+    struct Cell* Cells = CreateCellsGrid(Rows, Columns);
+
+    if (Backend == GRID_BACKEND_BITS)
+    {
+        Grid->Bits = CreateBitGrid(Rows, Columns);
+        LoadBitGridFromCells(Grid->Bits, Cells);
+        free(Cells);
+    }
+    else
+    {
+        // The back buffer needs the Row/Column of every cell as well, so it starts as a copy
+        Grid->Cells = Cells;
+        Grid->UpdatedCells = (struct Cell*)malloc(Rows * Columns * sizeof(struct Cell));
+        memcpy(Grid->UpdatedCells, Cells, Rows * Columns * sizeof(struct Cell));
+    }
+
+    return Grid;
+}
+
+void GridStep(struct Grid* Grid)
+{
+    struct GridBandsJob Job;
+    Job.Grid = Grid;
+    Job.BandsNum = 1;
+    Job.RowsAlignment = Grid->Backend == GRID_BACKEND_BITS ? BIT_GRID_TILE_ROWS : 1;
+
+    int ThreadsNum = GetWorkerPoolThreadsNum(Grid->Pool);
+    if (1 < ThreadsNum && GRID_PARALLEL_MIN_CELLS <= (long long)Grid->Rows * Grid->Columns)
+    {
+        int UnitsNum = (Grid->Rows + Job.RowsAlignment - 1) / Job.RowsAlignment;
+        Job.BandsNum = ThreadsNum * GRID_BANDS_PER_THREAD;
+        Job.BandsNum = UnitsNum < Job.BandsNum ? UnitsNum : Job.BandsNum;
+    }
+    RunWorkerPoolTasks(Grid->Pool, UpdateGridBand, &Job, Job.BandsNum);
+
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        SwapBitGridBuffers(Grid->Bits);
+    }
+    else
+    {
+        struct Cell* PreviousCells = Grid->Cells;
+        Grid->Cells = Grid->UpdatedCells;
+        Grid->UpdatedCells = PreviousCells;
+    }
+
+    ++Grid->Generation;
+}
+
+void GridSetWorkerPool(struct Grid* Grid, struct WorkerPool* Pool)
+{
+    Grid->Pool = Pool;
+}
+
+void GridSetChangeTracking(struct Grid* Grid, int bEnabled)
+{
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        SetBitGridChangeTracking(Grid->Bits, bEnabled);
+    }
+}
+
+void GridDestroy(struct Grid* Grid)
+{
+    if (Grid == NULL)
+    {
+        return;
+    }
+    free(Grid->Cells);
+    free(Grid->UpdatedCells);
+    DestroyBitGrid(Grid->Bits);
+    free(Grid);
+}
+
+enum CellState GridGetCell(const struct Grid* Grid, int Row, int Column)
+{
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        return GetBitGridCell(Grid->Bits, Row, Column);
+    }
+    return Grid->Cells[Row * Grid->Columns + Column].State;
+}
+
+void GridSetCell(struct Grid* Grid, int Row, int Column, enum CellState State)
+{
+    if (Grid->Backend == GRID_BACKEND_BITS)
+    {
+        SetBitGridCell(Grid->Bits, Row, Column, State);
+        return;
+    }
+    Grid->Cells[Row * Grid->Columns + Column].State = State;
+}
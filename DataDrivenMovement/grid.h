@@ -0,0 +1,59 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "cell_grid.h"
+#include "bit_grid.h"
+#include "worker_pool.h"
+
+//------------------------------------------------------------------------------------
+// Game of Life grid context shared by the raylib main loop and headless benchmarks.
+// Owns a front and a back buffer; every step writes the back buffer from the front one
+// and swaps the pointers, so nothing is allocated or copied per generation.
+//------------------------------------------------------------------------------------
+
+enum GridBackend
+{
+    GRID_BACKEND_CELLS,
+    GRID_BACKEND_BITS
+};
+
+struct Grid
+{
+    enum GridBackend Backend;
+    int Rows;
+    int Columns;
+
+    // Number of generations simulated since creation
+    long long Generation;
+
+    // GRID_BACKEND_CELLS: current and next generation
+    struct Cell* Cells;
+    struct Cell* UpdatedCells;
+
+    // GRID_BACKEND_BITS: the bit grid keeps its own buffer pair
+    struct BitGrid* Bits;
+
+    // Optional pool the step is split across, not owned by the grid
+    struct WorkerPool* Pool;
+};
+
+// Creates a grid filled from the current rand() state (the same pattern for both backends given the same seed)
+struct Grid* GridCreate(int Rows, int Columns, enum GridBackend Backend);
+
+void GridStep(struct Grid* Grid);
+
+// Splits every following step into row bands run on the pool; NULL goes back to a single thread.
+// The result is identical to the single-threaded step since bands only read the previous generation
+void GridSetWorkerPool(struct Grid* Grid, struct WorkerPool* Pool);
+
+// Skips settled regions of the board. Only the bit-packed backend tracks changes,
+// the struct Cell backend ignores this and always recomputes every cell
+void GridSetChangeTracking(struct Grid* Grid, int bEnabled);
+
+void GridDestroy(struct Grid* Grid);
+
+enum CellState GridGetCell(const struct Grid* Grid, int Row, int Column);
+
+void GridSetCell(struct Grid* Grid, int Row, int Column, enum CellState State);
+
+#endif
@@ -0,0 +1,529 @@
+#include "hashlife.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HASHLIFE_INITIAL_BUCKETS_NUM 4096
+
+// Smallest root that still has grandchildren, needed by the centring checks
+#define HASHLIFE_MIN_ROOT_LEVEL 3
+
+//------------------------------------------------------------------------------------
+// Node cache
+//------------------------------------------------------------------------------------
+
+static size_t HashChildren(const struct HashlifeNode* NorthWest, const struct HashlifeNode* NorthEast,
+                           const struct HashlifeNode* SouthWest, const struct HashlifeNode* SouthEast)
+{
+    // Pointers share their low and high bits, so everything is mixed down into the bucket bits
+    uint64_t Hash = (uint64_t)(uintptr_t)NorthWest;
+    Hash = Hash * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)NorthEast;
+    Hash = Hash * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)SouthWest;
+    Hash = Hash * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t)SouthEast;
+    Hash = (Hash ^ (Hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    Hash = (Hash ^ (Hash >> 27)) * 0x94D049BB133111EBull;
+    return (size_t)(Hash ^ (Hash >> 31));
+}
+
+static void GrowHashlifeBuckets(struct Hashlife* Universe)
+{
+    size_t NewBucketsNum = Universe->BucketsNum * 2;
+    struct HashlifeNode** NewBuckets = (struct HashlifeNode**)calloc(NewBucketsNum, sizeof(struct HashlifeNode*));
+
+    for (size_t i = 0; i < Universe->BucketsNum; ++i)
+    {
+        struct HashlifeNode* Node = Universe->Buckets[i];
+        while (Node != NULL)
+        {
+            struct HashlifeNode* Next = Node->HashNext;
+            size_t Bucket = HashChildren(Node->NorthWest, Node->NorthEast, Node->SouthWest, Node->SouthEast) & (NewBucketsNum - 1);
+            Node->HashNext = NewBuckets[Bucket];
+            NewBuckets[Bucket] = Node;
+            Node = Next;
+        }
+    }
+
+    free(Universe->Buckets);
+    Universe->Buckets = NewBuckets;
+    Universe->BucketsNum = NewBucketsNum;
+}
+
+// Returns the one node with these quadrants, creating it if it does not exist yet
+static struct HashlifeNode* JoinNodes(struct Hashlife* Universe,
+                                      struct HashlifeNode* NorthWest, struct HashlifeNode* NorthEast,
+                                      struct HashlifeNode* SouthWest, struct HashlifeNode* SouthEast)
+{
+    size_t Bucket = HashChildren(NorthWest, NorthEast, SouthWest, SouthEast) & (Universe->BucketsNum - 1);
+    for (struct HashlifeNode* Node = Universe->Buckets[Bucket]; Node != NULL; Node = Node->HashNext)
+    {
+        if (Node->NorthWest == NorthWest && Node->NorthEast == NorthEast && Node->SouthWest == SouthWest && Node->SouthEast == SouthEast)
+        {
+            return Node;
+        }
+    }
+
+    struct HashlifeNode* Node = (struct HashlifeNode*)malloc(sizeof(struct HashlifeNode));
+    Node->NorthWest = NorthWest;
+    Node->NorthEast = NorthEast;
+    Node->SouthWest = SouthWest;
+    Node->SouthEast = SouthEast;
+    Node->Result = NULL;
+    Node->Population = NorthWest->Population + NorthEast->Population + SouthWest->Population + SouthEast->Population;
+    Node->Level = NorthWest->Level + 1;
+    Node->bMarked = 0;
+
+    Node->HashNext = Universe->Buckets[Bucket];
+    Universe->Buckets[Bucket] = Node;
+    ++Universe->NodesNum;
+
+    if (Universe->BucketsNum < Universe->NodesNum)
+    {
+        GrowHashlifeBuckets(Universe);
+    }
+
+    return Node;
+}
+
+static struct HashlifeNode* GetLeaf(struct Hashlife* Universe, int bAlive)
+{
+    return &Universe->Leaves[bAlive ? 1 : 0];
+}
+
+static struct HashlifeNode* GetEmptyNode(struct Hashlife* Universe, int Level)
+{
+    if (Level == 0)
+    {
+        return GetLeaf(Universe, 0);
+    }
+    if (Universe->EmptyNodes[Level] == NULL)
+    {
+        struct HashlifeNode* Child = GetEmptyNode(Universe, Level - 1);
+        Universe->EmptyNodes[Level] = JoinNodes(Universe, Child, Child, Child, Child);
+    }
+    return Universe->EmptyNodes[Level];
+}
+
+static void ClearHashlifeResults(struct Hashlife* Universe)
+{
+    for (size_t i = 0; i < Universe->BucketsNum; ++i)
+    {
+        for (struct HashlifeNode* Node = Universe->Buckets[i]; Node != NULL; Node = Node->HashNext)
+        {
+            Node->Result = NULL;
+        }
+    }
+}
+
+static void MarkNode(struct HashlifeNode* Node)
+{
+    if (Node == NULL || Node->bMarked)
+    {
+        return;
+    }
+    Node->bMarked = 1;
+    MarkNode(Node->NorthWest);
+    MarkNode(Node->NorthEast);
+    MarkNode(Node->SouthWest);
+    MarkNode(Node->SouthEast);
+}
+
+void CollectHashlifeGarbage(struct Hashlife* Universe)
+{
+    MarkNode(Universe->Root);
+    for (int i = 0; i < 64; ++i)
+    {
+        MarkNode(Universe->EmptyNodes[i]);
+    }
+
+    // Results are not roots, so a surviving node forgets a result that is about to be freed
+    for (size_t i = 0; i < Universe->BucketsNum; ++i)
+    {
+        for (struct HashlifeNode* Node = Universe->Buckets[i]; Node != NULL; Node = Node->HashNext)
+        {
+            if (Node->bMarked && Node->Result != NULL && !Node->Result->bMarked)
+            {
+                Node->Result = NULL;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < Universe->BucketsNum; ++i)
+    {
+        struct HashlifeNode** Link = &Universe->Buckets[i];
+        while (*Link != NULL)
+        {
+            struct HashlifeNode* Node = *Link;
+            if (Node->bMarked)
+            {
+                Node->bMarked = 0;
+                Link = &Node->HashNext;
+            }
+            else
+            {
+                *Link = Node->HashNext;
+                free(Node);
+                --Universe->NodesNum;
+            }
+        }
+    }
+
+    ++Universe->GarbageCollectionsNum;
+}
+
+//------------------------------------------------------------------------------------
+// Quadtree helpers
+//------------------------------------------------------------------------------------
+
+// Level k node -> level k-1 node around its centre
+static struct HashlifeNode* GetCentre(struct Hashlife* Universe, const struct HashlifeNode* Node)
+{
+    return JoinNodes(Universe, Node->NorthWest->SouthEast, Node->NorthEast->SouthWest, Node->SouthWest->NorthEast, Node->SouthEast->NorthWest);
+}
+
+// Surrounds the root with empty space, doubling its size and keeping the origin in the middle
+static void ExpandRoot(struct Hashlife* Universe)
+{
+    struct HashlifeNode* Root = Universe->Root;
+    struct HashlifeNode* Empty = GetEmptyNode(Universe, Root->Level - 1);
+
+    Universe->Root = JoinNodes(Universe,
+        JoinNodes(Universe, Empty, Empty, Empty, Root->NorthWest),
+        JoinNodes(Universe, Empty, Empty, Root->NorthEast, Empty),
+        JoinNodes(Universe, Empty, Root->SouthWest, Empty, Empty),
+        JoinNodes(Universe, Root->SouthEast, Empty, Empty, Empty));
+}
+
+// 1 if all live cells of the root are in its central quarter (half the width on each axis)
+static int IsRootCentred(const struct HashlifeNode* Root)
+{
+    return Root->NorthWest->Population == Root->NorthWest->SouthEast->SouthEast->Population
+        && Root->NorthEast->Population == Root->NorthEast->SouthWest->SouthWest->Population
+        && Root->SouthWest->Population == Root->SouthWest->NorthEast->NorthEast->Population
+        && Root->SouthEast->Population == Root->SouthEast->NorthWest->NorthWest->Population;
+}
+
+static int GetNodeCell(const struct HashlifeNode* Node, int64_t X, int64_t Y)
+{
+    while (0 < Node->Level)
+    {
+        int64_t Half = (int64_t)1 << (Node->Level - 1);
+        if (Y < Half)
+        {
+            Node = X < Half ? Node->NorthWest : Node->NorthEast;
+        }
+        else
+        {
+            Node = X < Half ? Node->SouthWest : Node->SouthEast;
+            Y -= Half;
+        }
+        X = X < Half ? X : X - Half;
+    }
+    return Node->Population != 0;
+}
+
+static struct HashlifeNode* SetNodeCell(struct Hashlife* Universe, struct HashlifeNode* Node, int64_t X, int64_t Y, int bAlive)
+{
+    if (Node->Level == 0)
+    {
+        return GetLeaf(Universe, bAlive);
+    }
+
+    int64_t Half = (int64_t)1 << (Node->Level - 1);
+    struct HashlifeNode* NorthWest = Node->NorthWest;
+    struct HashlifeNode* NorthEast = Node->NorthEast;
+    struct HashlifeNode* SouthWest = Node->SouthWest;
+    struct HashlifeNode* SouthEast = Node->SouthEast;
+
+    if (Y < Half)
+    {
+        if (X < Half) NorthWest = SetNodeCell(Universe, NorthWest, X, Y, bAlive);
+        else NorthEast = SetNodeCell(Universe, NorthEast, X - Half, Y, bAlive);
+    }
+    else
+    {
+        if (X < Half) SouthWest = SetNodeCell(Universe, SouthWest, X, Y - Half, bAlive);
+        else SouthEast = SetNodeCell(Universe, SouthEast, X - Half, Y - Half, bAlive);
+    }
+
+    return JoinNodes(Universe, NorthWest, NorthEast, SouthWest, SouthEast);
+}
+
+//------------------------------------------------------------------------------------
+// Evolution
+//------------------------------------------------------------------------------------
+
+// Level 2 (4x4 cells): the central 2x2 one generation later, computed directly
+static struct HashlifeNode* ComputeLevel2Result(struct Hashlife* Universe, const struct HashlifeNode* Node)
+{
+    int NextCells[2][2];
+    for (int y = 1; y <= 2; ++y)
+    {
+        for (int x = 1; x <= 2; ++x)
+        {
+            int AliveNeighborsNum = 0;
+            for (int i = y - 1; i <= y + 1; ++i)
+            {
+                for (int j = x - 1; j <= x + 1; ++j)
+                {
+                    if (i != y || j != x)
+                    {
+                        AliveNeighborsNum += GetNodeCell(Node, j, i);
+                    }
+                }
+            }
+            int bAlive = GetNodeCell(Node, x, y);
+            NextCells[y - 1][x - 1] = AliveNeighborsNum == 3 || (bAlive && AliveNeighborsNum == 2);
+        }
+    }
+
+    return JoinNodes(Universe, GetLeaf(Universe, NextCells[0][0]), GetLeaf(Universe, NextCells[0][1]),
+                               GetLeaf(Universe, NextCells[1][0]), GetLeaf(Universe, NextCells[1][1]));
+}
+
+// Level k node -> its level k-1 centre advanced by min(2^StepLog2, 2^(k-2)) generations
+static struct HashlifeNode* ComputeResult(struct Hashlife* Universe, struct HashlifeNode* Node)
+{
+    if (Node->Result != NULL)
+    {
+        return Node->Result;
+    }
+
+    struct HashlifeNode* Result;
+    if (Node->Population == 0)
+    {
+        Result = GetEmptyNode(Universe, Node->Level - 1);
+    }
+    else if (Node->Level == 2)
+    {
+        Result = ComputeLevel2Result(Universe, Node);
+    }
+    else
+    {
+        struct HashlifeNode* NW = Node->NorthWest;
+        struct HashlifeNode* NE = Node->NorthEast;
+        struct HashlifeNode* SW = Node->SouthWest;
+        struct HashlifeNode* SE = Node->SouthEast;
+
+        // Nine overlapping level k-1 squares covering the node
+        struct HashlifeNode* Squares[3][3];
+        Squares[0][0] = NW;
+        Squares[0][1] = JoinNodes(Universe, NW->NorthEast, NE->NorthWest, NW->SouthEast, NE->SouthWest);
+        Squares[0][2] = NE;
+        Squares[1][0] = JoinNodes(Universe, NW->SouthWest, NW->SouthEast, SW->NorthWest, SW->NorthEast);
+        Squares[1][1] = JoinNodes(Universe, NW->SouthEast, NE->SouthWest, SW->NorthEast, SE->NorthWest);
+        Squares[1][2] = JoinNodes(Universe, NE->SouthWest, NE->SouthEast, SE->NorthWest, SE->NorthEast);
+        Squares[2][0] = SW;
+        Squares[2][1] = JoinNodes(Universe, SW->NorthEast, SE->NorthWest, SW->SouthEast, SE->SouthWest);
+        Squares[2][2] = SE;
+
+        // At full speed the first half of the time is spent here, at a smaller step size
+        // the squares are only cut down to their centres and all the time is spent below
+        int bFullSpeed = Node->Level - 2 <= Universe->StepLog2;
+        struct HashlifeNode* Parts[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                Parts[i][j] = bFullSpeed ? ComputeResult(Universe, Squares[i][j]) : GetCentre(Universe, Squares[i][j]);
+            }
+        }
+
+        Result = JoinNodes(Universe,
+            ComputeResult(Universe, JoinNodes(Universe, Parts[0][0], Parts[0][1], Parts[1][0], Parts[1][1])),
+            ComputeResult(Universe, JoinNodes(Universe, Parts[0][1], Parts[0][2], Parts[1][1], Parts[1][2])),
+            ComputeResult(Universe, JoinNodes(Universe, Parts[1][0], Parts[1][1], Parts[2][0], Parts[2][1])),
+            ComputeResult(Universe, JoinNodes(Universe, Parts[1][1], Parts[1][2], Parts[2][1], Parts[2][2])));
+    }
+
+    Node->Result = Result;
+    return Result;
+}
+
+void StepHashlife(struct Hashlife* Universe, int StepLog2)
+{
+    // Cached results are only valid for one step size
+    if (StepLog2 != Universe->StepLog2)
+    {
+        ClearHashlifeResults(Universe);
+        Universe->StepLog2 = StepLog2;
+    }
+
+    // Patterns grow at most at c/2, so a pattern in the central quarter cannot reach the
+    // edge of the result (the central half) within 2^(Level-2) generations
+    while (Universe->Root->Level < StepLog2 + 2 || Universe->Root->Level < HASHLIFE_MIN_ROOT_LEVEL + 1 || !IsRootCentred(Universe->Root))
+    {
+        ExpandRoot(Universe);
+    }
+    Universe->Root = ComputeResult(Universe, Universe->Root);
+
+    // Dropping empty borders again keeps the root from growing every step
+    while (HASHLIFE_MIN_ROOT_LEVEL < Universe->Root->Level && IsRootCentred(Universe->Root))
+    {
+        Universe->Root = GetCentre(Universe, Universe->Root);
+    }
+
+    Universe->Generation += (uint64_t)1 << StepLog2;
+
+    if (Universe->MaxNodesNum < Universe->NodesNum)
+    {
+        CollectHashlifeGarbage(Universe);
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Universe
+//------------------------------------------------------------------------------------
+
+struct Hashlife* CreateHashlife(size_t MaxNodesNum)
+{
+    struct Hashlife* Universe = (struct Hashlife*)calloc(1, sizeof(struct Hashlife));
+    Universe->BucketsNum = HASHLIFE_INITIAL_BUCKETS_NUM;
+    Universe->Buckets = (struct HashlifeNode**)calloc(Universe->BucketsNum, sizeof(struct HashlifeNode*));
+    Universe->MaxNodesNum = MaxNodesNum;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        memset(&Universe->Leaves[i], 0, sizeof(struct HashlifeNode));
+        Universe->Leaves[i].Population = i;
+    }
+
+    Universe->Root = GetEmptyNode(Universe, HASHLIFE_MIN_ROOT_LEVEL);
+    return Universe;
+}
+
+void DestroyHashlife(struct Hashlife* Universe)
+{
+    if (Universe == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < Universe->BucketsNum; ++i)
+    {
+        struct HashlifeNode* Node = Universe->Buckets[i];
+        while (Node != NULL)
+        {
+            struct HashlifeNode* Next = Node->HashNext;
+            free(Node);
+            Node = Next;
+        }
+    }
+    free(Universe->Buckets);
+    free(Universe);
+}
+
+static int IsInsideRoot(const struct Hashlife* Universe, int64_t X, int64_t Y)
+{
+    int64_t Half = (int64_t)1 << (Universe->Root->Level - 1);
+    return -Half <= X && X < Half && -Half <= Y && Y < Half;
+}
+
+enum CellState GetHashlifeCell(const struct Hashlife* Universe, int64_t X, int64_t Y)
+{
+    if (!IsInsideRoot(Universe, X, Y))
+    {
+        return DEAD;
+    }
+    int64_t Half = (int64_t)1 << (Universe->Root->Level - 1);
+    return GetNodeCell(Universe->Root, X + Half, Y + Half) ? ALIVE : DEAD;
+}
+
+void SetHashlifeCell(struct Hashlife* Universe, int64_t X, int64_t Y, enum CellState State)
+{
+    while (!IsInsideRoot(Universe, X, Y))
+    {
+        ExpandRoot(Universe);
+    }
+    int64_t Half = (int64_t)1 << (Universe->Root->Level - 1);
+    Universe->Root = SetNodeCell(Universe, Universe->Root, X + Half, Y + Half, State == ALIVE);
+}
+
+uint64_t GetHashlifePopulation(const struct Hashlife* Universe)
+{
+    return Universe->Root->Population;
+}
+
+//------------------------------------------------------------------------------------
+// Conversion from and to the flat grid
+//------------------------------------------------------------------------------------
+
+// Builds the node whose top-left corner is at (X, Y) in universe coordinates
+static struct HashlifeNode* BuildNodeFromGrid(struct Hashlife* Universe, const struct Grid* Grid, int Level, int64_t X, int64_t Y)
+{
+    int64_t Size = (int64_t)1 << Level;
+    if (Grid->Columns <= X || X + Size <= 0 || Grid->Rows <= Y || Y + Size <= 0)
+    {
+        return GetEmptyNode(Universe, Level);
+    }
+    if (Level == 0)
+    {
+        return GetLeaf(Universe, GridGetCell(Grid, (int)Y, (int)X) == ALIVE);
+    }
+
+    int64_t Half = Size / 2;
+    return JoinNodes(Universe,
+        BuildNodeFromGrid(Universe, Grid, Level - 1, X, Y),
+        BuildNodeFromGrid(Universe, Grid, Level - 1, X + Half, Y),
+        BuildNodeFromGrid(Universe, Grid, Level - 1, X, Y + Half),
+        BuildNodeFromGrid(Universe, Grid, Level - 1, X + Half, Y + Half));
+}
+
+void LoadHashlifeFromGrid(struct Hashlife* Universe, const struct Grid* Grid)
+{
+    int Level = HASHLIFE_MIN_ROOT_LEVEL;
+    int Extent = Grid->Rows < Grid->Columns ? Grid->Columns : Grid->Rows;
+    while (((int64_t)1 << (Level - 1)) < Extent)
+    {
+        ++Level;
+    }
+
+    int64_t Half = (int64_t)1 << (Level - 1);
+    Universe->Root = BuildNodeFromGrid(Universe, Grid, Level, -Half, -Half);
+    Universe->Generation = 0;
+}
+
+static void StoreNodeToGrid(const struct HashlifeNode* Node, int64_t X, int64_t Y, struct Grid* Grid)
+{
+    int64_t Size = (int64_t)1 << Node->Level;
+    if (Grid->Columns <= X || X + Size <= 0 || Grid->Rows <= Y || Y + Size <= 0)
+    {
+        return;
+    }
+
+    if (Node->Population == 0 || Node->Level == 0)
+    {
+        enum CellState State = Node->Population == 0 ? DEAD : ALIVE;
+        int64_t RowEnd = Y + Size < Grid->Rows ? Y + Size : Grid->Rows;
+        int64_t ColumnEnd = X + Size < Grid->Columns ? X + Size : Grid->Columns;
+        for (int64_t i = Y < 0 ? 0 : Y; i < RowEnd; ++i)
+        {
+            for (int64_t j = X < 0 ? 0 : X; j < ColumnEnd; ++j)
+            {
+                GridSetCell(Grid, (int)i, (int)j, State);
+            }
+        }
+        return;
+    }
+
+    int64_t Half = Size / 2;
+    StoreNodeToGrid(Node->NorthWest, X, Y, Grid);
+    StoreNodeToGrid(Node->NorthEast, X + Half, Y, Grid);
+    StoreNodeToGrid(Node->SouthWest, X, Y + Half, Grid);
+    StoreNodeToGrid(Node->SouthEast, X + Half, Y + Half, Grid);
+}
+
+void StoreHashlifeToGrid(const struct Hashlife* Universe, struct Grid* Grid)
+{
+    int64_t Half = (int64_t)1 << (Universe->Root->Level - 1);
+
+    // Everything outside the root is dead
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            if (!IsInsideRoot(Universe, j, i))
+            {
+                GridSetCell(Grid, i, j, DEAD);
+            }
+        }
+    }
+    StoreNodeToGrid(Universe->Root, -Half, -Half, Grid);
+}
@@ -0,0 +1,87 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "grid.h"
+
+//------------------------------------------------------------------------------------
+// Hashlife: Game of Life on a canonical quadtree.
+// Identical subtrees are stored once (hash-consing) and every node remembers its own
+// future, so repeating or empty space costs almost nothing and 2^k generations can be
+// skipped in one call.
+//
+// The Hashlife plane is unbounded, while the flat grids treat everything outside as dead.
+// Results only match the flat grids while the pattern stays away from their edges.
+//------------------------------------------------------------------------------------
+
+struct HashlifeNode
+{
+    // Quadrants, NULL for single cells (level 0)
+    struct HashlifeNode* NorthWest;
+    struct HashlifeNode* NorthEast;
+    struct HashlifeNode* SouthWest;
+    struct HashlifeNode* SouthEast;
+
+    // Centre of this node advanced by the universe step size, NULL until computed
+    struct HashlifeNode* Result;
+
+    // Next node in the same hash bucket
+    struct HashlifeNode* HashNext;
+
+    uint64_t Population;
+
+    // The node covers 2^Level x 2^Level cells
+    int Level;
+
+    int bMarked;
+};
+
+struct Hashlife
+{
+    struct HashlifeNode** Buckets;
+    size_t BucketsNum;
+    size_t NodesNum;
+
+    // Garbage is collected between steps once the cache holds more nodes than this
+    size_t MaxNodesNum;
+
+    // Dead and alive cell, shared by the whole tree
+    struct HashlifeNode Leaves[2];
+
+    // Cache of the empty node of every level
+    struct HashlifeNode* EmptyNodes[64];
+
+    // Covers [-2^(Level-1), 2^(Level-1)) on both axes, X grows east and Y grows south
+    struct HashlifeNode* Root;
+
+    // log2 of the generations the cached results are valid for
+    int StepLog2;
+
+    uint64_t Generation;
+    size_t GarbageCollectionsNum;
+};
+
+struct Hashlife* CreateHashlife(size_t MaxNodesNum);
+
+void DestroyHashlife(struct Hashlife* Universe);
+
+enum CellState GetHashlifeCell(const struct Hashlife* Universe, int64_t X, int64_t Y);
+
+void SetHashlifeCell(struct Hashlife* Universe, int64_t X, int64_t Y, enum CellState State);
+
+uint64_t GetHashlifePopulation(const struct Hashlife* Universe);
+
+// Advances the universe by 2^StepLog2 generations
+void StepHashlife(struct Hashlife* Universe, int StepLog2);
+
+// Frees every node that is no longer part of the current pattern
+void CollectHashlifeGarbage(struct Hashlife* Universe);
+
+// Replaces the universe with the cells of the grid, cell (Row, Column) goes to X = Column, Y = Row
+void LoadHashlifeFromGrid(struct Hashlife* Universe, const struct Grid* Grid);
+
+// Writes the [0, Columns) x [0, Rows) window of the universe into the grid
+void StoreHashlifeToGrid(const struct Hashlife* Universe, struct Grid* Grid);
+
+#endif
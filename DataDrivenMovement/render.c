@@ -0,0 +1,179 @@
+#include "render.h"
+#include "rlgl.h"
+#include <stdlib.h>
+
+// Grayscale value of RAYWHITE, so both render modes show the same colours
+#define RENDER_ALIVE_VALUE 245
+#define RENDER_DEAD_VALUE 0
+
+// Entities sent between batch limit checks; stays well under the default rlgl batch of 8192 quads
+#define RENDER_ENTITIES_PER_CHUNK 1024
+
+#define RENDER_ENTITY_SPRITE_SIZE 64
+
+//------------------------------------------------------------------------------------
+// Immediate mode
+//------------------------------------------------------------------------------------
+
+void DrawCells(struct Cell* Cells, int CellsNum, int CellSizeX, int CellSizeY)
+{
+    for (int i = 0; i < CellsNum; ++i)
+    {
+        Color CellColor = (Cells[i].State == ALIVE) ? RAYWHITE : BLACK;
+        int X_Coordinate = Cells[i].Row * CellSizeX + CellSizeX / 2;
+        int Y_Coordinate = Cells[i].Column * CellSizeY + CellSizeY / 2;
+        DrawRectangle(X_Coordinate, Y_Coordinate, CellSizeX, CellSizeY, CellColor);
+    }
+}
+
+void DrawCellsGrid(const struct Grid* Grid, int CellSizeX, int CellSizeY)
+{
+    if (Grid->Backend == GRID_BACKEND_CELLS)
+    {
+        DrawCells(Grid->Cells, Grid->Rows * Grid->Columns, CellSizeX, CellSizeY);
+        return;
+    }
+
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            Color CellColor = (GridGetCell(Grid, i, j) == ALIVE) ? RAYWHITE : BLACK;
+            int X_Coordinate = i * CellSizeX + CellSizeX / 2;
+            int Y_Coordinate = j * CellSizeY + CellSizeY / 2;
+            DrawRectangle(X_Coordinate, Y_Coordinate, CellSizeX, CellSizeY, CellColor);
+        }
+    }
+}
+
+void DrawEntities(const struct EntityStore* Entities, float Radius){
+    for (int i = 0; i < Entities->EntitiesNum; ++i)
+    {
+        DrawCircle(Entities->PositionX[i], Entities->PositionY[i], Radius, RED );
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Batched mode
+//------------------------------------------------------------------------------------
+
+struct GridTexture* CreateGridTexture(const struct Grid* Grid)
+{
+    struct GridTexture* GridTexture = (struct GridTexture*)malloc(sizeof(struct GridTexture));
+    GridTexture->Width = Grid->Rows;
+    GridTexture->Height = Grid->Columns;
+    GridTexture->Pixels = (unsigned char*)calloc((size_t)GridTexture->Width * GridTexture->Height, 1);
+
+    Image GridImage = {0};
+    GridImage.data = GridTexture->Pixels;
+    GridImage.width = GridTexture->Width;
+    GridImage.height = GridTexture->Height;
+    GridImage.mipmaps = 1;
+    GridImage.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+
+    // Point filtering keeps the cells sharp when the texture is stretched over the screen
+    GridTexture->Texture = LoadTextureFromImage(GridImage);
+    SetTextureFilter(GridTexture->Texture, TEXTURE_FILTER_POINT);
+
+    return GridTexture;
+}
+
+void DestroyGridTexture(struct GridTexture* GridTexture)
+{
+    if (GridTexture == NULL)
+    {
+        return;
+    }
+    UnloadTexture(GridTexture->Texture);
+    free(GridTexture->Pixels);
+    free(GridTexture);
+}
+
+// Texel (Row, Column) is Pixels[Column * Width + Row]
+static void FillGridTexturePixels(struct GridTexture* GridTexture, const struct Grid* Grid)
+{
+    unsigned char* Pixels = GridTexture->Pixels;
+    int Width = GridTexture->Width;
+
+    if (Grid->Backend == GRID_BACKEND_CELLS)
+    {
+        for (int i = 0; i < Grid->Rows; ++i)
+        {
+            for (int j = 0; j < Grid->Columns; ++j)
+            {
+                Pixels[j * Width + i] = Grid->Cells[i * Grid->Columns + j].State == ALIVE ? RENDER_ALIVE_VALUE : RENDER_DEAD_VALUE;
+            }
+        }
+        return;
+    }
+
+    // Reading the words directly avoids a function call per cell
+    for (int i = 0; i < Grid->Rows; ++i)
+    {
+        const uint64_t* RowWords = GetBitGridRow(Grid->Bits, i);
+        for (int j = 0; j < Grid->Columns; ++j)
+        {
+            Pixels[j * Width + i] = ((RowWords[j / 64] >> (j % 64)) & 1) ? RENDER_ALIVE_VALUE : RENDER_DEAD_VALUE;
+        }
+    }
+}
+
+void DrawGridTexture(struct GridTexture* GridTexture, const struct Grid* Grid, int CellSizeX, int CellSizeY)
+{
+    FillGridTexturePixels(GridTexture, Grid);
+    UpdateTexture(GridTexture->Texture, GridTexture->Pixels);
+
+    Rectangle Source = {0.0f, 0.0f, (float)GridTexture->Width, (float)GridTexture->Height};
+    Rectangle Destination = {(float)(CellSizeX / 2), (float)(CellSizeY / 2),
+                             (float)(GridTexture->Width * CellSizeX), (float)(GridTexture->Height * CellSizeY)};
+    DrawTexturePro(GridTexture->Texture, Source, Destination, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+Texture2D LoadEntitySprite(void)
+{
+    const int HALF_SIZE = RENDER_ENTITY_SPRITE_SIZE / 2;
+
+    Image Sprite = GenImageColor(RENDER_ENTITY_SPRITE_SIZE, RENDER_ENTITY_SPRITE_SIZE, BLANK);
+    ImageDrawCircle(&Sprite, HALF_SIZE, HALF_SIZE, HALF_SIZE - 1, WHITE);
+    Texture2D Texture = LoadTextureFromImage(Sprite);
+    UnloadImage(Sprite);
+
+    SetTextureFilter(Texture, TEXTURE_FILTER_BILINEAR);
+    return Texture;
+}
+
+void DrawEntitiesBatched(const struct EntityStore* Entities, Texture2D Sprite, float Radius, Color Tint)
+{
+    for (int ChunkBegin = 0; ChunkBegin < Entities->EntitiesNum; ChunkBegin += RENDER_ENTITIES_PER_CHUNK)
+    {
+        int ChunkEnd = ChunkBegin + RENDER_ENTITIES_PER_CHUNK;
+        ChunkEnd = Entities->EntitiesNum < ChunkEnd ? Entities->EntitiesNum : ChunkEnd;
+
+        // Flushes the current batch first if the whole chunk would not fit into it
+        rlCheckRenderBatchLimit(4 * (ChunkEnd - ChunkBegin));
+
+        rlSetTexture(Sprite.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(Tint.r, Tint.g, Tint.b, Tint.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (int i = ChunkBegin; i < ChunkEnd; ++i)
+        {
+            float Left = Entities->PositionX[i] - Radius;
+            float Right = Entities->PositionX[i] + Radius;
+            float Top = Entities->PositionY[i] - Radius;
+            float Bottom = Entities->PositionY[i] + Radius;
+
+            // Counter-clockwise, the same winding as DrawTexturePro
+            rlTexCoord2f(0.0f, 0.0f);
+            rlVertex2f(Left, Top);
+            rlTexCoord2f(0.0f, 1.0f);
+            rlVertex2f(Left, Bottom);
+            rlTexCoord2f(1.0f, 1.0f);
+            rlVertex2f(Right, Bottom);
+            rlTexCoord2f(1.0f, 0.0f);
+            rlVertex2f(Right, Top);
+        }
+        rlEnd();
+        rlSetTexture(0);
+    }
+}
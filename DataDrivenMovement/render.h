@@ -0,0 +1,51 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "raylib.h"
+#include "grid.h"
+#include "entities.h"
+
+//------------------------------------------------------------------------------------
+// Drawing of the grid and the entities.
+// RENDER_MODE_IMMEDIATE is the original path: one DrawRectangle per cell, one DrawCircle per entity.
+// RENDER_MODE_BATCHED uploads the whole grid as one texture per frame and draws it with a
+// single textured quad, and sends every entity as a quad of one shared circle sprite in as
+// few batches as rlgl allows, so the cost no longer grows with the number of draw calls.
+//------------------------------------------------------------------------------------
+
+enum RenderMode
+{
+    RENDER_MODE_IMMEDIATE,
+    RENDER_MODE_BATCHED
+};
+
+// Grid cell (Row, Column) is drawn at x = Row * CellSizeX + CellSizeX / 2, y = Column * CellSizeY + CellSizeY / 2
+void DrawCells(struct Cell* Cells, int CellsNum, int CellSizeX, int CellSizeY);
+
+void DrawCellsGrid(const struct Grid* Grid, int CellSizeX, int CellSizeY);
+
+void DrawEntities(const struct EntityStore* Entities, float Radius);
+
+// One grayscale texel per cell, Rows wide and Columns high to match the layout of DrawCellsGrid
+struct GridTexture
+{
+    int Width;
+    int Height;
+    unsigned char* Pixels;
+    Texture2D Texture;
+};
+
+// Needs the window (and its OpenGL context) to exist already
+struct GridTexture* CreateGridTexture(const struct Grid* Grid);
+
+void DestroyGridTexture(struct GridTexture* GridTexture);
+
+// Copies the current generation into the texture and draws it in one call
+void DrawGridTexture(struct GridTexture* GridTexture, const struct Grid* Grid, int CellSizeX, int CellSizeY);
+
+// White circle on a transparent background, tinted per draw
+Texture2D LoadEntitySprite(void);
+
+void DrawEntitiesBatched(const struct EntityStore* Entities, Texture2D Sprite, float Radius, Color Tint);
+
+#endif
@@ -0,0 +1,165 @@
+#include "simulation.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void ReservePositions(struct Simulation* Simulation, int EntitiesNum)
+{
+    if (EntitiesNum <= Simulation->PositionsCapacity)
+    {
+        return;
+    }
+    free(Simulation->PreviousPositionX);
+    free(Simulation->PreviousPositionY);
+    free(Simulation->InterpolatedPositionX);
+    free(Simulation->InterpolatedPositionY);
+    Simulation->PositionsCapacity = EntitiesNum;
+    Simulation->PreviousPositionX = (float*)malloc(EntitiesNum * sizeof(float));
+    Simulation->PreviousPositionY = (float*)malloc(EntitiesNum * sizeof(float));
+    Simulation->InterpolatedPositionX = (float*)malloc(EntitiesNum * sizeof(float));
+    Simulation->InterpolatedPositionY = (float*)malloc(EntitiesNum * sizeof(float));
+}
+
+static void SavePreviousPositions(struct Simulation* Simulation)
+{
+    if (Simulation->Entities == NULL)
+    {
+        return;
+    }
+    ReservePositions(Simulation, Simulation->Entities->EntitiesNum);
+    memcpy(Simulation->PreviousPositionX, Simulation->Entities->PositionX, Simulation->Entities->EntitiesNum * sizeof(float));
+    memcpy(Simulation->PreviousPositionY, Simulation->Entities->PositionY, Simulation->Entities->EntitiesNum * sizeof(float));
+}
+
+struct Simulation* CreateSimulation(struct Grid* Cells, struct EntityStore* Entities, struct SpatialGrid* EntitiesGrid,
+                                    float BoundsX, float BoundsY, float EntityRadius,
+                                    int StepsPerSecond, int MaxStepsPerFrame)
+{
+    struct Simulation* Simulation = (struct Simulation*)calloc(1, sizeof(struct Simulation));
+    Simulation->Cells = Cells;
+    Simulation->Entities = Entities;
+    Simulation->EntitiesGrid = EntitiesGrid;
+    Simulation->BoundsX = BoundsX;
+    Simulation->BoundsY = BoundsY;
+    Simulation->EntityRadius = EntityRadius;
+    Simulation->StepSeconds = 1.0 / StepsPerSecond;
+    Simulation->MaxStepsPerFrame = MaxStepsPerFrame < 1 ? 1 : MaxStepsPerFrame;
+
+    // Until the first tick the previous positions are the current ones
+    SavePreviousPositions(Simulation);
+
+    return Simulation;
+}
+
+void DestroySimulation(struct Simulation* Simulation)
+{
+    if (Simulation == NULL)
+    {
+        return;
+    }
+    free(Simulation->PreviousPositionX);
+    free(Simulation->PreviousPositionY);
+    free(Simulation->InterpolatedPositionX);
+    free(Simulation->InterpolatedPositionY);
+    free(Simulation);
+}
+
+void StepSimulation(struct Simulation* Simulation)
+{
+    if (Simulation->Cells != NULL)
+    {
+        GridStep(Simulation->Cells);
+    }
+    if (Simulation->Entities != NULL)
+    {
+        UpdateEntityStore(Simulation->Entities, (float)Simulation->StepSeconds, Simulation->BoundsX, Simulation->BoundsY);
+        if (Simulation->EntitiesGrid != NULL)
+        {
+            RebuildSpatialGrid(Simulation->EntitiesGrid, Simulation->Entities);
+            ResolveEntityCollisions(Simulation->EntitiesGrid, Simulation->Entities, Simulation->EntityRadius);
+        }
+    }
+    ++Simulation->StepsNum;
+}
+
+int AdvanceSimulation(struct Simulation* Simulation, double FrameSeconds)
+{
+    Simulation->Accumulator += FrameSeconds;
+
+    int StepsNum = (int)(Simulation->Accumulator / Simulation->StepSeconds);
+    if (Simulation->MaxStepsPerFrame < StepsNum)
+    {
+        // Falling behind: run what the frame allows and forget the rest instead of catching up later
+        double Dropped = (StepsNum - Simulation->MaxStepsPerFrame) * Simulation->StepSeconds;
+        Simulation->Accumulator -= Dropped;
+        Simulation->DroppedSeconds += Dropped;
+        StepsNum = Simulation->MaxStepsPerFrame;
+    }
+
+    for (int i = 0; i < StepsNum; ++i)
+    {
+        // Only the state before the last tick is needed for interpolation
+        if (i == StepsNum - 1)
+        {
+            SavePreviousPositions(Simulation);
+        }
+        StepSimulation(Simulation);
+        Simulation->Accumulator -= Simulation->StepSeconds;
+    }
+
+    Simulation->FrameSeconds[Simulation->StatsFrameIndex] = FrameSeconds;
+    Simulation->FrameSteps[Simulation->StatsFrameIndex] = StepsNum;
+    Simulation->StatsFrameIndex = (Simulation->StatsFrameIndex + 1) % SIMULATION_STATS_FRAMES;
+    Simulation->StatsFramesNum += Simulation->StatsFramesNum < SIMULATION_STATS_FRAMES;
+
+    return StepsNum;
+}
+
+float GetSimulationAlpha(const struct Simulation* Simulation)
+{
+    float Alpha = (float)(Simulation->Accumulator / Simulation->StepSeconds);
+    return Alpha < 0.0f ? 0.0f : (Alpha < 1.0f ? Alpha : 1.0f);
+}
+
+struct EntityStore GetInterpolatedEntities(struct Simulation* Simulation)
+{
+    if (Simulation->Entities == NULL)
+    {
+        struct EntityStore Empty = {0};
+        return Empty;
+    }
+
+    struct EntityStore View = *Simulation->Entities;
+    float Alpha = GetSimulationAlpha(Simulation);
+
+    ReservePositions(Simulation, View.EntitiesNum);
+    for (int i = 0; i < View.EntitiesNum; ++i)
+    {
+        float PreviousX = Simulation->PreviousPositionX[i];
+        float PreviousY = Simulation->PreviousPositionY[i];
+        Simulation->InterpolatedPositionX[i] = PreviousX + (View.PositionX[i] - PreviousX) * Alpha;
+        Simulation->InterpolatedPositionY[i] = PreviousY + (View.PositionY[i] - PreviousY) * Alpha;
+    }
+
+    View.PositionX = Simulation->InterpolatedPositionX;
+    View.PositionY = Simulation->InterpolatedPositionY;
+    return View;
+}
+
+void GetSimulationStats(const struct Simulation* Simulation, struct SimulationStats* Stats)
+{
+    double TotalSeconds = 0.0;
+    long long TotalSteps = 0;
+    Stats->MaxFrameSeconds = 0.0;
+    for (int i = 0; i < Simulation->StatsFramesNum; ++i)
+    {
+        TotalSeconds += Simulation->FrameSeconds[i];
+        TotalSteps += Simulation->FrameSteps[i];
+        Stats->MaxFrameSeconds = Stats->MaxFrameSeconds < Simulation->FrameSeconds[i] ? Simulation->FrameSeconds[i] : Stats->MaxFrameSeconds;
+    }
+
+    int FramesNum = Simulation->StatsFramesNum < 1 ? 1 : Simulation->StatsFramesNum;
+    Stats->AverageFrameSeconds = TotalSeconds / FramesNum;
+    Stats->StepsPerFrame = (double)TotalSteps / FramesNum;
+    Stats->GenerationsPerSecond = 0.0 < TotalSeconds ? TotalSteps / TotalSeconds : 0.0;
+    Stats->DroppedSeconds = Simulation->DroppedSeconds;
+}
@@ -0,0 +1,87 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "grid.h"
+#include "entities.h"
+#include "spatial_grid.h"
+
+//------------------------------------------------------------------------------------
+// Fixed timestep driver for the grid and the entities, independent of the render rate.
+// Every frame adds its real duration to an accumulator and runs as many fixed ticks as
+// fit, so the simulation advances the same way at 30 or 144 FPS. Each tick steps the
+// grid by one generation and the entities by StepSeconds.
+// The leftover fraction of a tick is used to draw the entities between their previous
+// and current positions.
+//------------------------------------------------------------------------------------
+
+// Frames kept for the statistics
+#define SIMULATION_STATS_FRAMES 120
+
+struct SimulationStats
+{
+    // Over the last SIMULATION_STATS_FRAMES frames
+    double AverageFrameSeconds;
+    double MaxFrameSeconds;
+    double StepsPerFrame;
+    double GenerationsPerSecond;
+
+    // Time thrown away because a frame needed more than MaxStepsPerFrame ticks
+    double DroppedSeconds;
+};
+
+struct Simulation
+{
+    // Not owned, any of them may be NULL
+    struct Grid* Cells;
+    struct EntityStore* Entities;
+    struct SpatialGrid* EntitiesGrid;
+
+    float BoundsX;
+    float BoundsY;
+    float EntityRadius;
+
+    double StepSeconds;
+    double Accumulator;
+
+    // A frame never runs more ticks than this, so one slow frame cannot snowball into the next
+    int MaxStepsPerFrame;
+
+    long long StepsNum;
+
+    // Entity positions before the last tick and the interpolated positions for drawing
+    float* PreviousPositionX;
+    float* PreviousPositionY;
+    float* InterpolatedPositionX;
+    float* InterpolatedPositionY;
+    int PositionsCapacity;
+
+    double FrameSeconds[SIMULATION_STATS_FRAMES];
+    int FrameSteps[SIMULATION_STATS_FRAMES];
+    int StatsFrameIndex;
+    int StatsFramesNum;
+    double DroppedSeconds;
+};
+
+struct Simulation* CreateSimulation(struct Grid* Cells, struct EntityStore* Entities, struct SpatialGrid* EntitiesGrid,
+                                    float BoundsX, float BoundsY, float EntityRadius,
+                                    int StepsPerSecond, int MaxStepsPerFrame);
+
+void DestroySimulation(struct Simulation* Simulation);
+
+// Runs every tick that fits into the accumulated time and returns how many ran
+int AdvanceSimulation(struct Simulation* Simulation, double FrameSeconds);
+
+// Runs exactly one tick, ignoring the accumulator
+void StepSimulation(struct Simulation* Simulation);
+
+// Fraction of a tick left in the accumulator, in [0, 1)
+float GetSimulationAlpha(const struct Simulation* Simulation);
+
+// The entities with positions interpolated between the last two ticks, or an empty store when
+// Entities is NULL. The returned store shares every other column with the real one and is valid
+// until the next AdvanceSimulation
+struct EntityStore GetInterpolatedEntities(struct Simulation* Simulation);
+
+void GetSimulationStats(const struct Simulation* Simulation, struct SimulationStats* Stats);
+
+#endif
@@ -0,0 +1,266 @@
+#include "spatial_grid.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int ClampCellCoordinate(int Coordinate, int CellsNum)
+{
+    return Coordinate < 0 ? 0 : (CellsNum <= Coordinate ? CellsNum - 1 : Coordinate);
+}
+
+static int GetCellCoordinate(const struct SpatialGrid* Grid, float Position, int CellsNum)
+{
+    // Clamping the float first keeps far away entities from overflowing the int conversion
+    float Scaled = Position * Grid->InverseCellSize;
+    Scaled = Scaled < 0.0f ? 0.0f : (Scaled < (float)CellsNum ? Scaled : (float)(CellsNum - 1));
+    return ClampCellCoordinate((int)Scaled, CellsNum);
+}
+
+struct SpatialGrid* CreateSpatialGrid(float BoundsX, float BoundsY, float CellSize)
+{
+    struct SpatialGrid* Grid = (struct SpatialGrid*)malloc(sizeof(struct SpatialGrid));
+    Grid->CellSize = CellSize;
+    Grid->InverseCellSize = 1.0f / CellSize;
+    Grid->CellsX = (int)ceilf(BoundsX / CellSize);
+    Grid->CellsY = (int)ceilf(BoundsY / CellSize);
+    Grid->CellsX = Grid->CellsX < 1 ? 1 : Grid->CellsX;
+    Grid->CellsY = Grid->CellsY < 1 ? 1 : Grid->CellsY;
+
+    Grid->CellStarts = (int*)calloc((size_t)Grid->CellsX * Grid->CellsY + 1, sizeof(int));
+    Grid->EntityIndices = NULL;
+    Grid->EntityCells = NULL;
+    Grid->ReorderBuffer = NULL;
+    Grid->EntitiesNum = 0;
+    Grid->EntitiesCapacity = 0;
+
+    return Grid;
+}
+
+void DestroySpatialGrid(struct SpatialGrid* Grid)
+{
+    if (Grid == NULL)
+    {
+        return;
+    }
+    free(Grid->CellStarts);
+    free(Grid->EntityIndices);
+    free(Grid->EntityCells);
+    free(Grid->ReorderBuffer);
+    free(Grid);
+}
+
+void RebuildSpatialGrid(struct SpatialGrid* Grid, const struct EntityStore* Store)
+{
+    int CellsNum = Grid->CellsX * Grid->CellsY;
+
+    // Only grows, so a steady entity count allocates nothing after the first frame
+    if (Grid->EntitiesCapacity < Store->EntitiesNum)
+    {
+        free(Grid->EntityIndices);
+        free(Grid->EntityCells);
+        free(Grid->ReorderBuffer);
+        Grid->EntitiesCapacity = Store->EntitiesNum;
+        Grid->EntityIndices = (int*)malloc(Grid->EntitiesCapacity * sizeof(int));
+        Grid->EntityCells = (int*)malloc(Grid->EntitiesCapacity * sizeof(int));
+        Grid->ReorderBuffer = NULL;
+    }
+    Grid->EntitiesNum = Store->EntitiesNum;
+
+    // Counting: CellStarts[c + 1] holds the number of entities in cell c
+    for (int i = 0; i <= CellsNum; ++i)
+    {
+        Grid->CellStarts[i] = 0;
+    }
+    for (int i = 0; i < Store->EntitiesNum; ++i)
+    {
+        int CellX = GetCellCoordinate(Grid, Store->PositionX[i], Grid->CellsX);
+        int CellY = GetCellCoordinate(Grid, Store->PositionY[i], Grid->CellsY);
+        int Cell = CellY * Grid->CellsX + CellX;
+        Grid->EntityCells[i] = Cell;
+        ++Grid->CellStarts[Cell + 1];
+    }
+
+    // Prefix sum turns the counts into the first slot of every cell
+    for (int i = 0; i < CellsNum; ++i)
+    {
+        Grid->CellStarts[i + 1] += Grid->CellStarts[i];
+    }
+
+    // Scattering advances CellStarts[c] to the end of cell c, which is where cell c + 1 starts.
+    // Shifting the array back by one afterwards restores the starts
+    for (int i = 0; i < Store->EntitiesNum; ++i)
+    {
+        Grid->EntityIndices[Grid->CellStarts[Grid->EntityCells[i]]++] = i;
+    }
+    for (int i = CellsNum; 0 < i; --i)
+    {
+        Grid->CellStarts[i] = Grid->CellStarts[i - 1];
+    }
+    Grid->CellStarts[0] = 0;
+}
+
+static void ReorderColumn(const struct SpatialGrid* Grid, float* Column)
+{
+    for (int i = 0; i < Grid->EntitiesNum; ++i)
+    {
+        Grid->ReorderBuffer[i] = Column[Grid->EntityIndices[i]];
+    }
+    memcpy(Column, Grid->ReorderBuffer, Grid->EntitiesNum * sizeof(float));
+}
+
+void ReorderEntityStoreByCell(struct SpatialGrid* Grid, struct EntityStore* Store)
+{
+    if (Grid->ReorderBuffer == NULL)
+    {
+        Grid->ReorderBuffer = (float*)malloc(Grid->EntitiesCapacity * sizeof(float));
+    }
+
+    ReorderColumn(Grid, Store->PositionX);
+    ReorderColumn(Grid, Store->PositionY);
+    ReorderColumn(Grid, Store->PositionZ);
+    ReorderColumn(Grid, Store->VelocityX);
+    ReorderColumn(Grid, Store->VelocityY);
+    ReorderColumn(Grid, Store->VelocityZ);
+
+    // Slot i of the grid now holds entity i
+    int CellsNum = Grid->CellsX * Grid->CellsY;
+    for (int Cell = 0; Cell < CellsNum; ++Cell)
+    {
+        for (int i = Grid->CellStarts[Cell]; i < Grid->CellStarts[Cell + 1]; ++i)
+        {
+            Grid->EntityIndices[i] = i;
+            Grid->EntityCells[i] = Cell;
+        }
+    }
+}
+
+static int QueryRadius(const struct SpatialGrid* Grid, const struct EntityStore* Store,
+                       float X, float Y, float Radius, int SkippedIndex, int* Indices, int MaxIndicesNum)
+{
+    int MinCellX = GetCellCoordinate(Grid, X - Radius, Grid->CellsX);
+    int MaxCellX = GetCellCoordinate(Grid, X + Radius, Grid->CellsX);
+    int MinCellY = GetCellCoordinate(Grid, Y - Radius, Grid->CellsY);
+    int MaxCellY = GetCellCoordinate(Grid, Y + Radius, Grid->CellsY);
+    float RadiusSquared = Radius * Radius;
+
+    int FoundNum = 0;
+    for (int CellY = MinCellY; CellY <= MaxCellY; ++CellY)
+    {
+        for (int CellX = MinCellX; CellX <= MaxCellX; ++CellX)
+        {
+            int Cell = CellY * Grid->CellsX + CellX;
+            for (int i = Grid->CellStarts[Cell]; i < Grid->CellStarts[Cell + 1]; ++i)
+            {
+                int Index = Grid->EntityIndices[i];
+                float DeltaX = Store->PositionX[Index] - X;
+                float DeltaY = Store->PositionY[Index] - Y;
+                if (Index != SkippedIndex && DeltaX * DeltaX + DeltaY * DeltaY <= RadiusSquared)
+                {
+                    if (FoundNum < MaxIndicesNum)
+                    {
+                        Indices[FoundNum] = Index;
+                    }
+                    ++FoundNum;
+                }
+            }
+        }
+    }
+    return FoundNum;
+}
+
+int QuerySpatialGridRadius(const struct SpatialGrid* Grid, const struct EntityStore* Store,
+                           float X, float Y, float Radius, int* Indices, int MaxIndicesNum)
+{
+    return QueryRadius(Grid, Store, X, Y, Radius, -1, Indices, MaxIndicesNum);
+}
+
+int QueryEntityNeighbours(const struct SpatialGrid* Grid, const struct EntityStore* Store,
+                          int EntityIndex, float Radius, int* Indices, int MaxIndicesNum)
+{
+    return QueryRadius(Grid, Store, Store->PositionX[EntityIndex], Store->PositionY[EntityIndex],
+                       Radius, EntityIndex, Indices, MaxIndicesNum);
+}
+
+static int CollideEntities(struct EntityStore* Store, int First, int Second, float Diameter)
+{
+    float DeltaX = Store->PositionX[Second] - Store->PositionX[First];
+    float DeltaY = Store->PositionY[Second] - Store->PositionY[First];
+    float DistanceSquared = DeltaX * DeltaX + DeltaY * DeltaY;
+
+    // Exactly overlapping entities have no contact normal, they get separated by their velocities instead
+    if (Diameter * Diameter <= DistanceSquared || DistanceSquared == 0.0f)
+    {
+        return 0;
+    }
+
+    float Distance = sqrtf(DistanceSquared);
+    float NormalX = DeltaX / Distance;
+    float NormalY = DeltaY / Distance;
+
+    // Each entity moves back by half of the overlap
+    float Push = 0.5f * (Diameter - Distance);
+    Store->PositionX[First] -= NormalX * Push;
+    Store->PositionY[First] -= NormalY * Push;
+    Store->PositionX[Second] += NormalX * Push;
+    Store->PositionY[Second] += NormalY * Push;
+
+    // Equal masses swap the velocity component along the normal, but only while they approach each other
+    float Approach = (Store->VelocityX[First] - Store->VelocityX[Second]) * NormalX +
+                     (Store->VelocityY[First] - Store->VelocityY[Second]) * NormalY;
+    if (0.0f < Approach)
+    {
+        Store->VelocityX[First] -= Approach * NormalX;
+        Store->VelocityY[First] -= Approach * NormalY;
+        Store->VelocityX[Second] += Approach * NormalX;
+        Store->VelocityY[Second] += Approach * NormalY;
+    }
+    return 1;
+}
+
+int ResolveEntityCollisions(const struct SpatialGrid* Grid, struct EntityStore* Store, float EntityRadius)
+{
+    float Diameter = 2.0f * EntityRadius;
+
+    // How many cells away a touching entity can be, 1 when the cell size is at least the diameter
+    int Reach = (int)ceilf(Diameter * Grid->InverseCellSize);
+
+    int PairsNum = 0;
+    for (int CellY = 0; CellY < Grid->CellsY; ++CellY)
+    {
+        for (int CellX = 0; CellX < Grid->CellsX; ++CellX)
+        {
+            int Cell = CellY * Grid->CellsX + CellX;
+            int CellEnd = Grid->CellStarts[Cell + 1];
+            for (int i = Grid->CellStarts[Cell]; i < CellEnd; ++i)
+            {
+                int First = Grid->EntityIndices[i];
+
+                // Pairs inside the cell
+                for (int j = i + 1; j < CellEnd; ++j)
+                {
+                    PairsNum += CollideEntities(Store, First, Grid->EntityIndices[j], Diameter);
+                }
+
+                // Only the forward half of the neighbourhood (the rest of this row and the rows below),
+                // so every pair of cells is visited once
+                for (int OffsetY = 0; OffsetY <= Reach && CellY + OffsetY < Grid->CellsY; ++OffsetY)
+                {
+                    for (int OffsetX = OffsetY == 0 ? 1 : -Reach; OffsetX <= Reach; ++OffsetX)
+                    {
+                        int OtherX = CellX + OffsetX;
+                        if (OtherX < 0 || Grid->CellsX <= OtherX)
+                        {
+                            continue;
+                        }
+                        int Other = (CellY + OffsetY) * Grid->CellsX + OtherX;
+                        for (int j = Grid->CellStarts[Other]; j < Grid->CellStarts[Other + 1]; ++j)
+                        {
+                            PairsNum += CollideEntities(Store, First, Grid->EntityIndices[j], Diameter);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return PairsNum;
+}
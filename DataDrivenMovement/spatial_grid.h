@@ -0,0 +1,61 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "entities.h"
+
+//------------------------------------------------------------------------------------
+// Uniform bucket grid over the entity bounds for neighbour queries and collisions.
+// It is rebuilt from scratch every frame with a counting sort: count the entities of
+// every cell, turn the counts into offsets and scatter the entity indices, so the
+// entities of one cell end up next to each other without any per-cell allocation.
+// Entities outside the bounds are put into the nearest edge cell.
+//------------------------------------------------------------------------------------
+
+struct SpatialGrid
+{
+    float CellSize;
+    float InverseCellSize;
+    int CellsX;
+    int CellsY;
+
+    // Entities of cell c are EntityIndices[CellStarts[c]] .. EntityIndices[CellStarts[c + 1] - 1]
+    int* CellStarts;
+    int* EntityIndices;
+
+    // Cell of every entity, by entity index
+    int* EntityCells;
+
+    int EntitiesNum;
+    int EntitiesCapacity;
+
+    // Scratch column for ReorderEntityStoreByCell
+    float* ReorderBuffer;
+};
+
+// A cell size of at least twice the entity radius keeps every collision inside the 3x3 neighbouring cells.
+// In sparse scenes cells about as wide as the average entity spacing avoid sweeping empty cells
+struct SpatialGrid* CreateSpatialGrid(float BoundsX, float BoundsY, float CellSize);
+
+void DestroySpatialGrid(struct SpatialGrid* Grid);
+
+void RebuildSpatialGrid(struct SpatialGrid* Grid, const struct EntityStore* Store);
+
+// Moves the entities of the store into cell order and updates the grid to match. Entities that are
+// close in space are then close in memory, which keeps rebuilds and queries in cache. Entity indices
+// change, so nothing may hold on to them across this call
+void ReorderEntityStoreByCell(struct SpatialGrid* Grid, struct EntityStore* Store);
+
+// Writes up to MaxIndicesNum indices of entities within Radius of (X, Y) and returns how many there are in total.
+// Uses the positions the grid was last rebuilt from
+int QuerySpatialGridRadius(const struct SpatialGrid* Grid, const struct EntityStore* Store,
+                           float X, float Y, float Radius, int* Indices, int MaxIndicesNum);
+
+// Same as QuerySpatialGridRadius around an entity, leaving the entity itself out
+int QueryEntityNeighbours(const struct SpatialGrid* Grid, const struct EntityStore* Store,
+                          int EntityIndex, float Radius, int* Indices, int MaxIndicesNum);
+
+// Pushes overlapping entities of the given radius apart and exchanges their velocities along the
+// contact normal (an elastic hit between equal masses). Returns the number of overlapping pairs
+int ResolveEntityCollisions(const struct SpatialGrid* Grid, struct EntityStore* Store, float EntityRadius);
+
+#endif
@@ -0,0 +1,208 @@
+#include "worker_pool.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef HANDLE PoolThread;
+typedef CRITICAL_SECTION PoolMutex;
+typedef CONDITION_VARIABLE PoolCondition;
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t PoolThread;
+typedef pthread_mutex_t PoolMutex;
+typedef pthread_cond_t PoolCondition;
+#endif
+
+struct WorkerPool
+{
+    int ThreadsNum;
+    PoolThread* Threads;
+
+    PoolMutex Mutex;
+    PoolCondition WorkReady;
+    PoolCondition WorkDone;
+
+    // Current job, all protected by Mutex
+    WorkerTask Task;
+    void* Context;
+    int TasksNum;
+    int NextTask;
+    int PendingTasks;
+    int bShouldExit;
+};
+
+//------------------------------------------------------------------------------------
+// Platform wrappers
+//------------------------------------------------------------------------------------
+
+#if defined(_WIN32)
+
+static void LockPool(struct WorkerPool* Pool) { EnterCriticalSection(&Pool->Mutex); }
+static void UnlockPool(struct WorkerPool* Pool) { LeaveCriticalSection(&Pool->Mutex); }
+static void WaitPool(struct WorkerPool* Pool, PoolCondition* Condition) { SleepConditionVariableCS(Condition, &Pool->Mutex, INFINITE); }
+static void WakeAll(PoolCondition* Condition) { WakeAllConditionVariable(Condition); }
+
+#else
+
+static void LockPool(struct WorkerPool* Pool) { pthread_mutex_lock(&Pool->Mutex); }
+static void UnlockPool(struct WorkerPool* Pool) { pthread_mutex_unlock(&Pool->Mutex); }
+static void WaitPool(struct WorkerPool* Pool, PoolCondition* Condition) { pthread_cond_wait(Condition, &Pool->Mutex); }
+static void WakeAll(PoolCondition* Condition) { pthread_cond_broadcast(Condition); }
+
+#endif
+
+int GetCoresNum(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    return (int)SystemInfo.dwNumberOfProcessors;
+#else
+    long CoresNum = sysconf(_SC_NPROCESSORS_ONLN);
+    return CoresNum < 1 ? 1 : (int)CoresNum;
+#endif
+}
+
+//------------------------------------------------------------------------------------
+// Pool
+//------------------------------------------------------------------------------------
+
+// Takes tasks until the current job runs out. Called and returns with the mutex locked
+static void RunAvailableTasks(struct WorkerPool* Pool)
+{
+    while (Pool->NextTask < Pool->TasksNum)
+    {
+        int TaskIndex = Pool->NextTask++;
+        WorkerTask Task = Pool->Task;
+        void* Context = Pool->Context;
+
+        UnlockPool(Pool);
+        Task(Context, TaskIndex);
+        LockPool(Pool);
+
+        if (--Pool->PendingTasks == 0)
+        {
+            WakeAll(&Pool->WorkDone);
+        }
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI WorkerThreadMain(LPVOID Parameter)
+#else
+static void* WorkerThreadMain(void* Parameter)
+#endif
+{
+    struct WorkerPool* Pool = (struct WorkerPool*)Parameter;
+
+    LockPool(Pool);
+    while (!Pool->bShouldExit)
+    {
+        RunAvailableTasks(Pool);
+        if (!Pool->bShouldExit)
+        {
+            WaitPool(Pool, &Pool->WorkReady);
+        }
+    }
+    UnlockPool(Pool);
+
+    return 0;
+}
+
+struct WorkerPool* CreateWorkerPool(int ThreadsNum)
+{
+    struct WorkerPool* Pool = (struct WorkerPool*)calloc(1, sizeof(struct WorkerPool));
+    Pool->ThreadsNum = ThreadsNum < 1 ? GetCoresNum() : ThreadsNum;
+    Pool->Threads = (PoolThread*)malloc(Pool->ThreadsNum * sizeof(PoolThread));
+
+#if defined(_WIN32)
+    InitializeCriticalSection(&Pool->Mutex);
+    InitializeConditionVariable(&Pool->WorkReady);
+    InitializeConditionVariable(&Pool->WorkDone);
+#else
+    pthread_mutex_init(&Pool->Mutex, NULL);
+    pthread_cond_init(&Pool->WorkReady, NULL);
+    pthread_cond_init(&Pool->WorkDone, NULL);
+#endif
+
+    // The calling thread is the first worker, so one thread less is started
+    for (int i = 0; i < Pool->ThreadsNum - 1; ++i)
+    {
+#if defined(_WIN32)
+        Pool->Threads[i] = CreateThread(NULL, 0, WorkerThreadMain, Pool, 0, NULL);
+#else
+        pthread_create(&Pool->Threads[i], NULL, WorkerThreadMain, Pool);
+#endif
+    }
+
+    return Pool;
+}
+
+void DestroyWorkerPool(struct WorkerPool* Pool)
+{
+    if (Pool == NULL)
+    {
+        return;
+    }
+
+    LockPool(Pool);
+    Pool->bShouldExit = 1;
+    WakeAll(&Pool->WorkReady);
+    UnlockPool(Pool);
+
+    for (int i = 0; i < Pool->ThreadsNum - 1; ++i)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(Pool->Threads[i], INFINITE);
+        CloseHandle(Pool->Threads[i]);
+#else
+        pthread_join(Pool->Threads[i], NULL);
+#endif
+    }
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&Pool->Mutex);
+#else
+    pthread_mutex_destroy(&Pool->Mutex);
+    pthread_cond_destroy(&Pool->WorkReady);
+    pthread_cond_destroy(&Pool->WorkDone);
+#endif
+
+    free(Pool->Threads);
+    free(Pool);
+}
+
+int GetWorkerPoolThreadsNum(const struct WorkerPool* Pool)
+{
+    return Pool == NULL ? 1 : Pool->ThreadsNum;
+}
+
+void RunWorkerPoolTasks(struct WorkerPool* Pool, WorkerTask Task, void* Context, int TasksNum)
+{
+    // Nothing to share, so the threads are not woken up at all
+    if (Pool == NULL || Pool->ThreadsNum == 1 || TasksNum <= 1)
+    {
+        for (int i = 0; i < TasksNum; ++i)
+        {
+            Task(Context, i);
+        }
+        return;
+    }
+
+    LockPool(Pool);
+    Pool->Task = Task;
+    Pool->Context = Context;
+    Pool->TasksNum = TasksNum;
+    Pool->NextTask = 0;
+    Pool->PendingTasks = TasksNum;
+    WakeAll(&Pool->WorkReady);
+
+    RunAvailableTasks(Pool);
+    while (0 < Pool->PendingTasks)
+    {
+        WaitPool(Pool, &Pool->WorkDone);
+    }
+    UnlockPool(Pool);
+}
@@ -0,0 +1,28 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+//------------------------------------------------------------------------------------
+// Fixed pool of worker threads for splitting simulation steps into independent tasks.
+// The threads are created once at startup and sleep between jobs.
+//------------------------------------------------------------------------------------
+
+struct WorkerPool;
+
+// Task callback, called once for every TaskIndex in [0, TasksNum)
+typedef void (*WorkerTask)(void* Context, int TaskIndex);
+
+// Returns the number of logical cores of the machine
+int GetCoresNum(void);
+
+// ThreadsNum counts the calling thread as well, so 1 means no extra threads; 0 uses every core
+struct WorkerPool* CreateWorkerPool(int ThreadsNum);
+
+void DestroyWorkerPool(struct WorkerPool* Pool);
+
+int GetWorkerPoolThreadsNum(const struct WorkerPool* Pool);
+
+// Runs all tasks and returns once every one of them has finished. The calling thread
+// takes tasks too. A NULL pool runs the tasks in order on the calling thread
+void RunWorkerPoolTasks(struct WorkerPool* Pool, WorkerTask Task, void* Context, int TasksNum);
+
+#endif
@@ -3,7 +3,9 @@
 #include "PlayerCharacter.h"
 
 #include "Blueprint/UserWidget.h"
+#include "HPPotionOptimisation/HPPotionOptimisation.h"
 #include "HPPotionOptimisation/DataAssets/CharacterInfoDataAsset.h"
+#include "HPPotionOptimisation/PotionSystem/HealingEffectSubsystem.h"
 
 void UPlayerCharacter::Init(TSoftObjectPtr<UCharacterInfoDataAsset> CharacterInfoDataAssetSoftPtr)
 {
@@ -32,7 +34,7 @@ void UPlayerCharacter::Init(TSoftObjectPtr<UCharacterInfoDataAsset> CharacterInf
 	}
 
 	PlayerIconWidget->SetCharacterName( CharacterName );
-	PlayerIconWidget->SetCurrentHealthPercent( static_cast<float>( CurrentHealth ) / static_cast<float>( MaxHealth ) );
+	PlayerIconWidget->SetInitialHealthPercent( static_cast<float>( CurrentHealth ) / static_cast<float>( MaxHealth ) );
 	PlayerIconWidget->SetPlayerIconTexture( CharacterInfoDataAssetSoftPtr.LoadSynchronous()->CharacterIcon );
 
 }
@@ -64,67 +66,56 @@ void UPlayerCharacter::AddHealth(float HealthToAdd)
 		ensureAlwaysMsgf( false, TEXT("PlayerIconWidget is not valid") );
 		return;
 	}
-	UE_LOG( LogTemp, Warning, TEXT("Adding %f health to %s"), HealthToAdd, *CharacterName.ToString() );
+	UE_LOG( LogHPPotionOptimisation, Verbose, TEXT("Adding %f health to %s"), HealthToAdd, *CharacterName.ToString() );
 
-	CurrentHealth = FMath::Min( MaxHealth, CurrentHealth + HealthToAdd );
-	PlayerIconWidget->SetCurrentHealthPercent( static_cast<float>( CurrentHealth ) / static_cast<float>( MaxHealth ) );
+	SetCurrentHealth( CurrentHealth + HealthToAdd );
 }
 
-void UPlayerCharacter::SetNewOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion)
+void UPlayerCharacter::SetCurrentHealth(float NewCurrentHealth)
 {
-	if ( !IsValid( PlayerIconWidget ) )
-	{
-		ensureAlwaysMsgf( false, TEXT("PlayerIconWidget is not valid") );
-		return;
-	}
-
-	// If we have no active healing potion, we start the healing effect
-	if ( !ActiveHealingPotion.IsSet() )
+	CurrentHealth = FMath::Min( MaxHealth, NewCurrentHealth );
+	if ( IsValid( PlayerIconWidget ) )
 	{
-		GetWorld()->GetTimerManager().SetTimerForNextTick( this, &UPlayerCharacter::ApplyOverTimeHealingPotionPerTick );
+		PlayerIconWidget->RequestCurrentHealthPercent( static_cast<float>( CurrentHealth ) / static_cast<float>( MaxHealth ) );
 	}
+}
 
-	// Setting the new active healing potion
-	ActiveHealingPotion = NewOverTimeHealingPotion;
-
-	// Calculating potential health to show it on the UI
-	float PotentialHealth = FMath::Min( MaxHealth, CurrentHealth + ActiveHealingPotion.GetValue().GetTotalHealingValue( MaxHealth) );
-	PlayerIconWidget->SetPotentialHealthPercent( PotentialHealth / MaxHealth );
-
-	// Adding the instant healing value to the player
-	AddHealth( ActiveHealingPotion.GetValue().InstantHealingValue );
+void UPlayerCharacter::InitHealth(const FText& NewCharacterName, float NewCurrentHealth, float NewMaxHealth)
+{
+	CharacterName = NewCharacterName;
+	MaxHealth = NewMaxHealth;
+	CurrentHealth = FMath::Min( MaxHealth, NewCurrentHealth );
 }
 
-void UPlayerCharacter::ApplyOverTimeHealingPotionPerTick()
+void UPlayerCharacter::SetNewOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion)
 {
-	if ( !IsValid( GetWorld() ) )
+	if ( StartOverTimeHealingPotion( NewOverTimeHealingPotion ) )
 	{
-		ensureAlwaysMsgf( false, TEXT("World is not valid") );
-		return;
+		// Adding the instant healing value to the player
+		AddHealth( NewOverTimeHealingPotion.InstantHealingValue );
 	}
+}
 
-	// If we do not have any active healing potion, we stop the function
-	if ( !ActiveHealingPotion.IsSet() )
+bool UPlayerCharacter::StartOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion)
+{
+	if ( !IsValid( PlayerIconWidget ) )
 	{
-		return;
+		ensureAlwaysMsgf( false, TEXT("PlayerIconWidget is not valid") );
+		return false;
 	}
 
-	float DeltaSeconds = GetWorld()->GetDeltaSeconds();
-
-	// Calculating the added health
-	float HealingValuePerTick = ActiveHealingPotion.GetValue().GetHealingValuePerTick( MaxHealth, DeltaSeconds );
-
-	// Adding the health to the player
-	AddHealth( HealingValuePerTick );
-
-	ActiveHealingPotion.GetValue().ElapsedHealingDuration += GetWorld()->GetDeltaSeconds();
-
-	// If the healing effect has expired or the player is at full health, we stop the healing effect
-	if ( ActiveHealingPotion.GetValue().ElapsedHealingDuration >= ActiveHealingPotion.GetValue().TotalHealingDuration || CurrentHealth == MaxHealth )
+	UHealingEffectSubsystem* HealingEffectSubsystem = GetWorld()->GetSubsystem<UHealingEffectSubsystem>();
+	if ( !IsValid( HealingEffectSubsystem ) )
 	{
-		ActiveHealingPotion.Reset();
-		return;
+		ensureAlwaysMsgf( false, TEXT("HealingEffectSubsystem is not valid") );
+		return false;
 	}
 
-	GetWorld()->GetTimerManager().SetTimerForNextTick( this, &UPlayerCharacter::ApplyOverTimeHealingPotionPerTick );
+	// Starting the healing effect, which stacks with the ones already running
+	HealingEffectSubsystem->AddEffect( this, NewOverTimeHealingPotion );
+
+	// Calculating potential health, with all the active potions, to show it on the UI
+	float PotentialHealth = FMath::Min( MaxHealth, CurrentHealth + NewOverTimeHealingPotion.InstantHealingValue + HealingEffectSubsystem->GetPendingHealing( this ) );
+	PlayerIconWidget->RequestPotentialHealthPercent( PotentialHealth / MaxHealth );
+	return true;
 }
@@ -37,11 +37,6 @@ private:
 	UPROPERTY()
 	UPlayerIconWidget* PlayerIconWidget;
 
-	/** Over time healing potion */
-
-	UPROPERTY()
-	TOptional<FOverTimeHealingPotion> ActiveHealingPotion;
-
 
 
 public:
@@ -65,11 +60,16 @@ public:
 	/* Function that adds health to the player, and clamps it according to the Max Health parameter value*/
 	void AddHealth(float HealthToAdd);
 
-	void SetNewOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion);
+	/* Sets the health, clamped to Max Health, and asks the health bar, if there is one, to show it on its next tick */
+	void SetCurrentHealth(float NewCurrentHealth);
 
+	/* Initialization without the Data Asset and the widget, for benchmarks */
+	void InitHealth(const FText& NewCharacterName, float NewCurrentHealth, float NewMaxHealth);
 
-private:
-	void ApplyOverTimeHealingPotionPerTick();
-
+	/* Heals instantly, and over time through the UHealingEffectSubsystem, next to any potions already active */
+	void SetNewOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion);
 
+	/* The over time part of SetNewOverTimeHealingPotion, and the potential health with the instant healing counted in.
+	The instant healing itself is left to the caller, e.g. through FPlayerHealthBatch. False if nothing was started */
+	bool StartOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion);
 };
@@ -3,4 +3,6 @@
 #include "HPPotionOptimisation.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY( LogHPPotionOptimisation );
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, HPPotionOptimisation, "HPPotionOptimisation" );
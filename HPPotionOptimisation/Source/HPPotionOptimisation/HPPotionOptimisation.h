@@ -4,3 +4,5 @@
 
 #include "CoreMinimal.h"
 
+/** Per player and per heal lines are logged as Verbose, so they are not even formatted unless turned on with "Log LogHPPotionOptimisation Verbose" */
+DECLARE_LOG_CATEGORY_EXTERN( LogHPPotionOptimisation, Log, All );
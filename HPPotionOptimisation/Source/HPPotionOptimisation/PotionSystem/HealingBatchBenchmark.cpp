@@ -0,0 +1,132 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HPPotionOptimisation/Character/PlayerCharacter.h"
+#include "HPPotionOptimisation/PotionSystem/PlayerHealthBatch.h"
+#include "HPPotionOptimisation/PotionSystem/PotionAssignmentSolver.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+// Development benchmark for reading and writing the health of many players, run from the console:
+//   Potions.BenchmarkHealing [PlayersNum]...
+// Without arguments it runs 1000 and 10000 players. The potions are shared out once, then applied the way
+// HealPlayers did before FPlayerHealthBatch (copied below) and through the batch, on players without widgets,
+// so the health bar itself is left out of both
+
+namespace HealingBatchBenchmark
+{
+	// The player array by value, the getters and a Warning line for every player, then a Warning line and a
+	// health write for every potion
+	void LegacyApply(TArray<UPlayerCharacter*> Players, const FPotionStackAssignment& Assignment, const TArray<int32>& StackValues)
+	{
+		TArray<float> MissingHealth;
+		for ( auto Player : Players )
+		{
+			UE_LOG( LogTemp, Warning, TEXT("%s currently has %f/%f health"), *Player->GetCharacterName().ToString(), Player->GetCurrentHealth(), Player->GetMaxHealth() );
+			MissingHealth.Add( Player->GetMaxHealth() - Player->GetCurrentHealth() );
+		}
+
+		for ( const FPotionStackUse& Use : Assignment.Uses )
+		{
+			UPlayerCharacter* Player = Players[ Use.Player ];
+			for ( int32 Copy = 0; Copy < Use.Count; ++Copy )
+			{
+				UE_LOG( LogTemp, Warning, TEXT("Adding %f health to %s"), static_cast<float>( StackValues[ Use.Stack ] ), *Player->GetCharacterName().ToString() );
+				Player->SetCurrentHealth( Player->GetCurrentHealth() + StackValues[ Use.Stack ] );
+			}
+		}
+	}
+
+	int32 BatchApply(const TArray<UPlayerCharacter*>& Players, const FPotionStackAssignment& Assignment, const TArray<int32>& StackValues)
+	{
+		FPlayerHealthBatch Batch( Players );
+		for ( const FPotionStackUse& Use : Assignment.Uses )
+		{
+			Batch.Healing[ Use.Player ] += static_cast<float>( Use.Count * StackValues[ Use.Stack ] );
+		}
+		return Batch.WriteBack();
+	}
+
+	void RunSize(const int32 PlayersNum)
+	{
+		static const int32 PotionKinds[] = { 25, 50, 100, 150, 250, 500 };
+
+		FRandomStream Random( PlayersNum );
+		TArray<UPlayerCharacter*> Players;
+		TArray<float> StartHealth;
+		for ( int32 Player = 0; Player < PlayersNum; ++Player )
+		{
+			UPlayerCharacter* NewPlayer = NewObject<UPlayerCharacter>();
+			NewPlayer->InitHealth( FText::FromString( FString::Printf( TEXT("Player %d"), Player ) ), static_cast<float>( Random.RandRange( 0, 1000 ) ), 1000.f );
+			Players.Add( NewPlayer );
+			StartHealth.Add( NewPlayer->GetCurrentHealth() );
+		}
+
+		TArray<int32> StackValues;
+		TArray<int32> StackCounts;
+		for ( const int32 Value : PotionKinds )
+		{
+			StackValues.Add( Value );
+			StackCounts.Add( PlayersNum * 10 / static_cast<int32>( UE_ARRAY_COUNT( PotionKinds ) ) );
+		}
+
+		const FPlayerHealthBatch StartBatch( Players );
+		const FPotionStackAssignment Assignment = FPotionAssignmentSolver::SolveStacks( StartBatch.GetMissingHealth(), StackValues, StackCounts );
+		int32 LegacyWritesNum = 0;
+		for ( const FPotionStackUse& Use : Assignment.Uses )
+		{
+			LegacyWritesNum += Use.Count;
+		}
+
+		double StartSeconds = FPlatformTime::Seconds();
+		LegacyApply( Players, Assignment, StackValues );
+		const double LegacySeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		TArray<float> LegacyHealth;
+		for ( int32 Player = 0; Player < PlayersNum; ++Player )
+		{
+			LegacyHealth.Add( Players[ Player ]->GetCurrentHealth() );
+			Players[ Player ]->SetCurrentHealth( StartHealth[ Player ] );
+		}
+
+		StartSeconds = FPlatformTime::Seconds();
+		const int32 BatchWritesNum = BatchApply( Players, Assignment, StackValues );
+		const double BatchSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		bool bMatches = true;
+		for ( int32 Player = 0; Player < PlayersNum; ++Player )
+		{
+			bMatches &= FMath::IsNearlyEqual( LegacyHealth[ Player ], Players[ Player ]->GetCurrentHealth(), 0.01f );
+		}
+
+		UE_LOG( LogTemp, Display, TEXT("%d players: legacy %.3f ms (%d health writes), batch %.3f ms (%d health writes)%s"),
+		        PlayersNum, LegacySeconds * 1000.0, LegacyWritesNum, BatchSeconds * 1000.0, BatchWritesNum, bMatches ? TEXT("") : TEXT(" MISMATCH") );
+	}
+
+	void Run(const TArray<FString>& Arguments)
+	{
+		TArray<int32> Sizes;
+		for ( const FString& Argument : Arguments )
+		{
+			const int32 PlayersNum = FCString::Atoi( *Argument );
+			if ( 0 < PlayersNum )
+			{
+				Sizes.Add( PlayersNum );
+			}
+		}
+		if ( Sizes.Num() == 0 )
+		{
+			Sizes = { 1000, 10000 };
+		}
+
+		for ( const int32 PlayersNum : Sizes )
+		{
+			RunSize( PlayersNum );
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkHealingCommand(
+		TEXT("Potions.BenchmarkHealing"),
+		TEXT("Compares applying potions through FPlayerHealthBatch with the original per potion path. Usage: Potions.BenchmarkHealing [PlayersNum]..."),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &Run ) );
+}
@@ -0,0 +1,141 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HealingEffectSubsystem.h"
+
+#include "HPPotionOptimisation/Character/PlayerCharacter.h"
+#include "HPPotionOptimisation/PotionSystem/HealthPotionSystem.h"
+#include "HPPotionOptimisation/PotionSystem/PlayerHealthBatch.h"
+
+void UHealingEffectSubsystem::AddEffect(UPlayerCharacter* Player, const FOverTimeHealingPotion& Potion)
+{
+	if ( !IsValid( Player ) || Potion.TotalHealingDuration <= 0.f )
+	{
+		return;
+	}
+
+	EffectPlayers.Add( Player );
+	HealingPerSecond.Add( Player->GetMaxHealth() * Potion.MaxHealthPercentageToHealOverTime / Potion.TotalHealingDuration );
+	ElapsedDuration.Add( Potion.ElapsedHealingDuration );
+	TotalDuration.Add( Potion.TotalHealingDuration );
+
+	FPlayerEffects& Effects = PlayerEffects.FindOrAdd( Player );
+	Effects.PendingHealing += GetRemainingHealing( EffectPlayers.Num() - 1 );
+	++Effects.EffectsNum;
+}
+
+void UHealingEffectSubsystem::RemoveEffects(const UPlayerCharacter* Player)
+{
+	for ( int32 Effect = EffectPlayers.Num() - 1; 0 <= Effect; --Effect )
+	{
+		if ( EffectPlayers[ Effect ] == Player )
+		{
+			RemoveEffectAt( Effect );
+		}
+	}
+}
+
+float UHealingEffectSubsystem::GetPendingHealing(const UPlayerCharacter* Player) const
+{
+	const FPlayerEffects* Effects = PlayerEffects.Find( Player );
+	return Effects ? FMath::Max( Effects->PendingHealing, 0.f ) : 0.f;
+}
+
+int32 UHealingEffectSubsystem::GetEffectsNum() const
+{
+	return EffectPlayers.Num();
+}
+
+int32 UHealingEffectSubsystem::GetEffectsNum(const UPlayerCharacter* Player) const
+{
+	const FPlayerEffects* Effects = PlayerEffects.Find( Player );
+	return Effects ? Effects->EffectsNum : 0;
+}
+
+void UHealingEffectSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick( DeltaTime );
+
+	const int32 EffectsNum = EffectPlayers.Num();
+	if ( EffectsNum == 0 )
+	{
+		return;
+	}
+
+	// The healing of every effect this frame, on the packed arrays only. The last frame of an effect only
+	// heals for the time it had left, so every potion gives exactly its total
+	TickHealing.SetNumUninitialized( EffectsNum );
+	for ( int32 Effect = 0; Effect < EffectsNum; ++Effect )
+	{
+		const float HealingDuration = FMath::Clamp( TotalDuration[ Effect ] - ElapsedDuration[ Effect ], 0.f, DeltaTime );
+		TickHealing[ Effect ] = HealingPerSecond[ Effect ] * HealingDuration;
+		ElapsedDuration[ Effect ] += DeltaTime;
+	}
+
+	// Effects stacked on the same player add up to a single health write
+	TickPlayers.Reset();
+	PlayerSlots.Reset();
+	EffectSlots.SetNumUninitialized( EffectsNum );
+	for ( int32 Effect = 0; Effect < EffectsNum; ++Effect )
+	{
+		UPlayerCharacter* Player = EffectPlayers[ Effect ];
+		const int32* Slot = PlayerSlots.Find( Player );
+		EffectSlots[ Effect ] = Slot ? *Slot : PlayerSlots.Add( Player, TickPlayers.Add( Player ) );
+	}
+
+	FPlayerHealthBatch Batch( TickPlayers );
+	for ( int32 Effect = 0; Effect < EffectsNum; ++Effect )
+	{
+		Batch.Healing[ EffectSlots[ Effect ] ] += TickHealing[ Effect ];
+	}
+	for ( int32 Slot = 0; Slot < TickPlayers.Num(); ++Slot )
+	{
+		if ( FPlayerEffects* Effects = PlayerEffects.Find( TickPlayers[ Slot ] ) )
+		{
+			Effects->PendingHealing -= Batch.Healing[ Slot ];
+		}
+	}
+	Batch.WriteBack();
+
+	// Going backwards, whatever is swapped into a removed effect has been looked at already
+	for ( int32 Effect = EffectsNum - 1; 0 <= Effect; --Effect )
+	{
+		const int32 Slot = EffectSlots[ Effect ];
+		if ( TotalDuration[ Effect ] <= ElapsedDuration[ Effect ] || !IsValid( TickPlayers[ Slot ] ) || Batch.MaxHealth[ Slot ] <= Batch.CurrentHealth[ Slot ] )
+		{
+			RemoveEffectAt( Effect );
+		}
+	}
+
+	// Drops the entries of players the garbage collector took out of EffectPlayers
+	if ( EffectPlayers.Num() == 0 )
+	{
+		PlayerEffects.Reset();
+	}
+}
+
+TStatId UHealingEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UHealingEffectSubsystem, STATGROUP_Tickables );
+}
+
+float UHealingEffectSubsystem::GetRemainingHealing(const int32 Effect) const
+{
+	return HealingPerSecond[ Effect ] * FMath::Max( TotalDuration[ Effect ] - ElapsedDuration[ Effect ], 0.f );
+}
+
+void UHealingEffectSubsystem::RemoveEffectAt(const int32 Effect)
+{
+	if ( FPlayerEffects* Effects = PlayerEffects.Find( EffectPlayers[ Effect ] ) )
+	{
+		Effects->PendingHealing -= GetRemainingHealing( Effect );
+		if ( --Effects->EffectsNum == 0 )
+		{
+			PlayerEffects.Remove( EffectPlayers[ Effect ] );
+		}
+	}
+
+	EffectPlayers.RemoveAtSwap( Effect );
+	HealingPerSecond.RemoveAtSwap( Effect );
+	ElapsedDuration.RemoveAtSwap( Effect );
+	TotalDuration.RemoveAtSwap( Effect );
+}
@@ -0,0 +1,69 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HealingEffectSubsystem.generated.h"
+
+struct FOverTimeHealingPotion;
+class UPlayerCharacter;
+
+/**
+ * Runs the over time part of every healing potion in the world from a single tick. The effects are packed in
+ * arrays side by side, so a frame first works out the healing of all of them in one loop, then writes it to
+ * the players once each, however many effects are stacked on them, see FPlayerHealthBatch. Effects end when
+ * their duration is over or their player is at full health, and are swap removed. The pending healing and
+ * effect count of every player are kept up to date as effects come and go, so asking for them costs a lookup
+ */
+UCLASS()
+class HPPOTIONOPTIMISATION_API UHealingEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts healing the player over time, next to any effects already running on them */
+	void AddEffect(UPlayerCharacter* Player, const FOverTimeHealingPotion& Potion);
+
+	void RemoveEffects(const UPlayerCharacter* Player);
+
+	/** Health the effects running on this player have yet to give */
+	float GetPendingHealing(const UPlayerCharacter* Player) const;
+
+	int32 GetEffectsNum() const;
+
+	int32 GetEffectsNum(const UPlayerCharacter* Player) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+private:
+	UPROPERTY()
+	TArray<UPlayerCharacter*> EffectPlayers;
+
+	TArray<float> HealingPerSecond;
+
+	TArray<float> ElapsedDuration;
+
+	TArray<float> TotalDuration;
+
+	struct FPlayerEffects
+	{
+		float PendingHealing = 0.f;
+		int32 EffectsNum = 0;
+	};
+
+	/** Every player with running effects. Only compared, never dereferenced, so an entry outliving its player is harmless */
+	TMap<const UPlayerCharacter*, FPlayerEffects> PlayerEffects;
+
+	/** Scratch space of Tick, kept to save the allocations */
+	TArray<float> TickHealing;
+	TArray<int32> EffectSlots;
+	TArray<UPlayerCharacter*> TickPlayers;
+	TMap<UPlayerCharacter*, int32> PlayerSlots;
+
+	float GetRemainingHealing(int32 Effect) const;
+
+	void RemoveEffectAt(int32 Effect);
+};
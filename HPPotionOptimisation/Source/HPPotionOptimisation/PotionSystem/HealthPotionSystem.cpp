@@ -2,7 +2,9 @@
 
 #include "HealthPotionSystem.h"
 
+#include "HPPotionOptimisation/HPPotionOptimisation.h"
 #include "HPPotionOptimisation/Character/PlayerCharacter.h"
+#include "HPPotionOptimisation/PotionSystem/PlayerHealthBatch.h"
 
 void UHealthPotionSystem::AddPotion(const FPotion& NewPotion)
 {
@@ -14,94 +16,83 @@ void UHealthPotionSystem::AddOverTimeHealingPotion(const FOverTimeHealingPotion&
 	OverTimeHealingPotions.Add( NewOverTimeHealingPotion );
 }
 
-void UHealthPotionSystem::HealPlayers(TArray<UPlayerCharacter*> Players)
+void UHealthPotionSystem::HealPlayers(const TArray<UPlayerCharacter*>& Players)
 {
-	// Let's sort all the available potions in descending order of healing value
-	Potions.Sort( [](const FPotion& A, const FPotion& B)
-	{
-		return A.HealingValue > B.HealingValue;
-	} );
+	FPlayerHealthBatch Batch( Players );
+	const TArray<float> MissingHealth = Batch.GetMissingHealth();
 
-	// Outer loop to iterate over all players
-	for ( auto Player : Players )
+	TArray<int32> StackValues;
+	TArray<int32> StackCounts;
+	StackValues.Reserve( Potions.GetStacksNum() );
+	StackCounts.Reserve( Potions.GetStacksNum() );
+	for ( int32 Stack = 0; Stack < Potions.GetStacksNum(); ++Stack )
 	{
-		UE_LOG( LogTemp, Warning, TEXT("%s currently has %f/%f health"), *Player->GetCharacterName().ToString(), Player->GetCurrentHealth(), Player->GetMaxHealth() );
-		// Initial check to see if the player is already at full health
-		if ( Player->GetMaxHealth() == Player->GetCurrentHealth() )
-		{
-			continue;
-		}
+		StackValues.Add( Potions.GetPotion( Stack ).HealingValue );
+		StackCounts.Add( Potions.GetCount( Stack ) );
+	}
 
-		// Inner loop to iterate over all potions
-		for ( int32 PotionIndex = 0; PotionIndex < Potions.Num(); ++PotionIndex )
-		{
-			// If we can heal this player without exceeding the max health, we can use this potion
-			float MissingHealth = Player->GetMaxHealth() - Player->GetCurrentHealth();
-			if ( Potions[ PotionIndex ].HealingValue <= MissingHealth )
-			{
-				// Applying the healing value of the potion to the player, and removing the potion
-				Player->AddHealth( Potions[ PotionIndex ].HealingValue );
-				Potions.RemoveAt( PotionIndex );
-			}
-		}
+	const FPotionStackAssignment Assignment = FPotionAssignmentSolver::SolveStacks( MissingHealth, StackValues, StackCounts );
+	LastAssignmentReport = Assignment.Report;
 
-		// If the player is not at full health, and we still have potions left, we can use the last potion
-		// We will waste the potion, but the player will be fully healed
-		if ( Player->GetCurrentHealth() < Player->GetMaxHealth() && Potions.Num() > 0 )
-		{
-			Player->AddHealth( Potions.Last().HealingValue );
-			Potions.RemoveAt( Potions.Num() - 1 );
-		}
+	// Every player is healed once by the sum of their potions
+	for ( const FPotionStackUse& Use : Assignment.Uses )
+	{
+		Batch.Healing[ Use.Player ] += static_cast<float>( Use.Count * StackValues[ Use.Stack ] );
+		Potions.Remove( Use.Stack, Use.Count );
+
+		UE_LOG( LogHPPotionOptimisation, Verbose, TEXT("%s gets %d potions of %d health, missing %f of %f health"), *Batch.Players[ Use.Player ]->GetCharacterName().ToString(),
+		        Use.Count, StackValues[ Use.Stack ], MissingHealth[ Use.Player ], Batch.MaxHealth[ Use.Player ] );
 	}
+	Potions.RemoveEmptyStacks();
+	Batch.WriteBack();
+
+	UE_LOG( LogHPPotionOptimisation, Display, TEXT("Healed %d players with %d of %d potions (%s): %.1f overheal, %.1f health still missing, solved in %.3f ms"),
+	        LastAssignmentReport.PlayersNum, LastAssignmentReport.UsedPotionsNum, LastAssignmentReport.PotionsNum, *UEnum::GetValueAsString( LastAssignmentReport.Method ),
+	        LastAssignmentReport.Overheal, LastAssignmentReport.MissingHealthLeft, LastAssignmentReport.SolveMilliseconds );
 }
 
-void UHealthPotionSystem::HealPlayersWithOverTimePotions(TArray<UPlayerCharacter*> Players)
+FPotionAssignmentReport UHealthPotionSystem::GetLastAssignmentReport() const
 {
-	// Let's sort all the available potions in descending order of healing value
-	OverTimeHealingPotions.Sort( [](const FOverTimeHealingPotion& A, const FOverTimeHealingPotion& B)
-	{
-		return A.InstantHealingValue > B.InstantHealingValue;
-	} );
+	return LastAssignmentReport;
+}
 
-	// Outer loop to iterate over all players
-	for ( auto Player : Players )
+void UHealthPotionSystem::HealPlayersWithOverTimePotions(const TArray<UPlayerCharacter*>& Players)
+{
+	// The over time part starts per player, the instant healing of every player is written back once
+	FPlayerHealthBatch Batch( Players );
+	for ( int32 Player = 0; Player < Batch.Num(); ++Player )
 	{
-		UE_LOG( LogTemp, Warning, TEXT("%s currently has %f/%f health"), *Player->GetCharacterName().ToString(), Player->GetCurrentHealth(), Player->GetMaxHealth() );
-		// Initial check to see if the player is already at full health
-		if ( Player->GetMaxHealth() == Player->GetCurrentHealth() )
+		if ( !IsValid( Batch.Players[ Player ] ) )
 		{
 			continue;
 		}
 
-		bool bPotionWasApplied = false;
-
-		// Inner loop to iterate over all potions
-		for ( int32 PotionIndex = 0; PotionIndex < OverTimeHealingPotions.Num(); ++PotionIndex )
+		const float MaxHealth = Batch.MaxHealth[ Player ];
+		const float CurrentHealth = Batch.CurrentHealth[ Player ];
+		UE_LOG( LogHPPotionOptimisation, Verbose, TEXT("%s currently has %f/%f health"), *Batch.Players[ Player ]->GetCharacterName().ToString(), CurrentHealth, MaxHealth );
+		// Initial check to see if the player is already at full health
+		if ( MaxHealth == CurrentHealth || OverTimeHealingPotions.Num() == 0 )
 		{
-			// If we can heal this player without exceeding the max health, we can use this potion
-			float MissingHealth = Player->GetMaxHealth() - Player->GetCurrentHealth();
-			float RestoredHealth = OverTimeHealingPotions[ PotionIndex ].GetTotalHealingValue( Player->GetMaxHealth() );
-			if ( RestoredHealth <= MissingHealth )
-			{
-				// Applying the healing value of the potion to the player, and removing the potion
-				Player->SetNewOverTimeHealingPotion( OverTimeHealingPotions[ PotionIndex ] );
-				OverTimeHealingPotions.RemoveAt( PotionIndex );
-				bPotionWasApplied = true;
-				break;
-			}
+			continue;
 		}
 
-		if ( bPotionWasApplied )
+		// The stacks are only reordered when the max health differs from the player before
+		OverTimeHealingPotions.SetMaxHealth( MaxHealth );
+
+		// The largest potion that does not exceed the max health, or else the smallest one, which wastes
+		// the least of the potion but fully heals the player
+		int32 Stack = OverTimeHealingPotions.FindLargestAtMost( MaxHealth - CurrentHealth );
+		if ( Stack == INDEX_NONE )
 		{
-			continue;
+			Stack = OverTimeHealingPotions.FindSmallest();
 		}
 
-		// If the player is not at full health, and we still have potions left, we can use the last potion
-		// We will waste the potion, but the player will be fully healed
-		if ( Player->GetCurrentHealth() < Player->GetMaxHealth() && OverTimeHealingPotions.Num() > 0 )
+		const FOverTimeHealingPotion& Potion = OverTimeHealingPotions.GetPotion( Stack );
+		if ( Batch.Players[ Player ]->StartOverTimeHealingPotion( Potion ) )
 		{
-			Player->SetNewOverTimeHealingPotion( OverTimeHealingPotions.Last() );
-			OverTimeHealingPotions.RemoveAt( OverTimeHealingPotions.Num() - 1 );
+			Batch.Healing[ Player ] += Potion.InstantHealingValue;
 		}
+		OverTimeHealingPotions.Remove( Stack );
 	}
+	Batch.WriteBack();
 }
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "HPPotionOptimisation/PotionSystem/PotionAssignmentSolver.h"
+#include "HPPotionOptimisation/PotionSystem/PotionStacks.h"
 #include "HealthPotionSystem.generated.h"
 
 class UPlayerCharacter;
@@ -43,6 +45,12 @@ struct FOverTimeHealingPotion
 	{
 		return (MaxHealth * MaxHealthPercentageToHealOverTime / TotalHealingDuration) * DeltaTime;
 	}
+
+	bool IsSameKind(const FOverTimeHealingPotion& Other) const
+	{
+		return PotionName == Other.PotionName && InstantHealingValue == Other.InstantHealingValue
+			&& MaxHealthPercentageToHealOverTime == Other.MaxHealthPercentageToHealOverTime && TotalHealingDuration == Other.TotalHealingDuration;
+	}
 };
 
 
@@ -57,6 +65,16 @@ struct FPotion
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	int32 HealingValue;
+
+	float GetTotalHealingValue(const float MaxHealth) const
+	{
+		return HealingValue;
+	}
+
+	bool IsSameKind(const FPotion& Other) const
+	{
+		return HealingValue == Other.HealingValue && PotionName == Other.PotionName;
+	}
 };
 
 UCLASS(BlueprintType)
@@ -65,9 +83,13 @@ class HPPOTIONOPTIMISATION_API UHealthPotionSystem : public UObject
 	GENERATED_BODY()
 
 private:
-	TArray<FPotion> Potions;
+	/** Identical potions are counted rather than stored one by one */
+	TPotionStacks<FPotion> Potions;
+
+	/** Ordered by the total healing for the max health of the player last healed */
+	TPotionStacks<FOverTimeHealingPotion> OverTimeHealingPotions;
 
-	TArray<FOverTimeHealingPotion> OverTimeHealingPotions;
+	FPotionAssignmentReport LastAssignmentReport;
 
 public:
 	UFUNCTION( BlueprintCallable )
@@ -76,9 +98,21 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void AddOverTimeHealingPotion(const FOverTimeHealingPotion& NewOverTimeHealingPotion);
 
+	/**
+	 * Shares the potions out so that overheal plus health still missing is as small as possible, see
+	 * FPotionAssignmentSolver. The health of all players is read and written back once, see FPlayerHealthBatch
+	 */
 	UFUNCTION( BlueprintCallable, Category = "HealthPotionSystem" )
-	void HealPlayers(TArray<UPlayerCharacter*> Players);
+	void HealPlayers(const TArray<UPlayerCharacter*>& Players);
+
+	/** Method, waste and solve time of the last HealPlayers */
+	UFUNCTION( BlueprintPure, Category = "HealthPotionSystem" )
+	FPotionAssignmentReport GetLastAssignmentReport() const;
 
+	/**
+	 * Gives every player missing health the largest potion that does not overheal them, or else the smallest one left.
+	 * The instant healing of all players is written back once, see FPlayerHealthBatch
+	 */
 	UFUNCTION(BlueprintCallable, Category= "HealthPotionSystem")
-	void HealPlayersWithOverTimePotions(TArray<UPlayerCharacter*> Players);
+	void HealPlayersWithOverTimePotions(const TArray<UPlayerCharacter*>& Players);
 };
@@ -0,0 +1,67 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerHealthBatch.h"
+
+#include "HPPotionOptimisation/Character/PlayerCharacter.h"
+
+FPlayerHealthBatch::FPlayerHealthBatch(TArrayView<UPlayerCharacter* const> InPlayers)
+{
+	// With two slots for one player the second write back would overwrite the healing of the first
+	TSet<UPlayerCharacter*> AddedPlayers;
+	AddedPlayers.Reserve( InPlayers.Num() );
+	Players.Reserve( InPlayers.Num() );
+	for ( UPlayerCharacter* Player : InPlayers )
+	{
+		bool bIsAlreadyAdded = false;
+		AddedPlayers.Add( Player, &bIsAlreadyAdded );
+		if ( !bIsAlreadyAdded )
+		{
+			Players.Add( Player );
+		}
+	}
+
+	CurrentHealth.SetNumUninitialized( Players.Num() );
+	MaxHealth.SetNumUninitialized( Players.Num() );
+	Healing.SetNumZeroed( Players.Num() );
+	for ( int32 Player = 0; Player < Players.Num(); ++Player )
+	{
+		const bool bIsValid = IsValid( Players[ Player ] );
+		CurrentHealth[ Player ] = bIsValid ? Players[ Player ]->GetCurrentHealth() : 0.f;
+		MaxHealth[ Player ] = bIsValid ? Players[ Player ]->GetMaxHealth() : 0.f;
+	}
+}
+
+TArray<float> FPlayerHealthBatch::GetMissingHealth() const
+{
+	TArray<float> MissingHealth;
+	MissingHealth.SetNumUninitialized( Num() );
+	for ( int32 Player = 0; Player < Num(); ++Player )
+	{
+		MissingHealth[ Player ] = MaxHealth[ Player ] - CurrentHealth[ Player ];
+	}
+	return MissingHealth;
+}
+
+int32 FPlayerHealthBatch::WriteBack()
+{
+	// All the new health first, on the arrays only
+	TArray<float> NewHealth;
+	NewHealth.SetNumUninitialized( Num() );
+	for ( int32 Player = 0; Player < Num(); ++Player )
+	{
+		NewHealth[ Player ] = FMath::Min( MaxHealth[ Player ], CurrentHealth[ Player ] + Healing[ Player ] );
+	}
+
+	int32 WrittenNum = 0;
+	for ( int32 Player = 0; Player < Num(); ++Player )
+	{
+		if ( NewHealth[ Player ] != CurrentHealth[ Player ] )
+		{
+			Players[ Player ]->SetCurrentHealth( NewHealth[ Player ] );
+			CurrentHealth[ Player ] = NewHealth[ Player ];
+			++WrittenNum;
+		}
+		Healing[ Player ] = 0.f;
+	}
+	return WrittenNum;
+}
@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPlayerCharacter;
+
+/**
+ * Current and max health of a group of players side by side, read from the players once so that the healing
+ * can be worked out on plain arrays, then written back once per player whose health changed, which is also
+ * the only health bar update they get. Players that are not valid read as full health and are never written.
+ * A player listed more than once gets a single slot, so all of their healing adds up to one write
+ */
+struct HPPOTIONOPTIMISATION_API FPlayerHealthBatch
+{
+	explicit FPlayerHealthBatch(TArrayView<UPlayerCharacter* const> InPlayers);
+
+	/** Every player once, in the order they were first listed */
+	TArray<UPlayerCharacter*> Players;
+
+	TArray<float> CurrentHealth;
+	TArray<float> MaxHealth;
+
+	/** Health to add to every player on WriteBack, zero to begin with */
+	TArray<float> Healing;
+
+	int32 Num() const
+	{
+		return Players.Num();
+	}
+
+	TArray<float> GetMissingHealth() const;
+
+	/** Adds the healing, clamped to max health, and returns how many players were written to */
+	int32 WriteBack();
+};
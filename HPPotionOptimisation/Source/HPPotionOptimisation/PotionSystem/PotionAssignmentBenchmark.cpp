@@ -0,0 +1,222 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HPPotionOptimisation/PotionSystem/PotionAssignmentSolver.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+// Development benchmark for the potion assignment, run from the console:
+//   Potions.BenchmarkAssignment [PlayersNum PotionsNum]...
+// Without arguments it runs a party, a dungeon group and raids of 100 to 1000 players. The original
+// HealPlayers loop (copied below, on healing values only) is compared with FPotionAssignmentSolver on the
+// same players and potions, once with a few potion kinds and once with random healing values. First,
+// small random cases are solved by trying every assignment, and the Exact method has to match that waste.
+
+namespace PotionAssignmentBenchmark
+{
+	struct FLegacyResult
+	{
+		float Overheal = 0.f;
+		float MissingHealthLeft = 0.f;
+		int32 UsedPotionsNum = 0;
+	};
+
+	// HealPlayers before the solver: the largest potions that fit, skipping the potion after every removal,
+	// then the smallest potion left for anyone still missing health
+	FLegacyResult LegacyHealPlayers(const TArray<float>& MissingHealth, TArray<int32> Potions)
+	{
+		Potions.Sort( [](const int32 A, const int32 B)
+		{
+			return A > B;
+		} );
+
+		FLegacyResult Result;
+		for ( const float PlayerMissingHealth : MissingHealth )
+		{
+			if ( PlayerMissingHealth <= 0.f )
+			{
+				continue;
+			}
+
+			float Healing = 0.f;
+			for ( int32 PotionIndex = 0; PotionIndex < Potions.Num(); ++PotionIndex )
+			{
+				if ( Potions[ PotionIndex ] <= FMath::Max( PlayerMissingHealth - Healing, 0.f ) )
+				{
+					Healing += Potions[ PotionIndex ];
+					Potions.RemoveAt( PotionIndex );
+					++Result.UsedPotionsNum;
+				}
+			}
+
+			if ( Healing < PlayerMissingHealth && Potions.Num() > 0 )
+			{
+				Healing += Potions.Last();
+				Potions.RemoveAt( Potions.Num() - 1 );
+				++Result.UsedPotionsNum;
+			}
+
+			if ( PlayerMissingHealth < Healing )
+			{
+				Result.Overheal += Healing - PlayerMissingHealth;
+			}
+			else
+			{
+				Result.MissingHealthLeft += PlayerMissingHealth - Healing;
+			}
+		}
+		return Result;
+	}
+
+	// Waste of the assignment, counting all healing of players missing nothing as waste, like the solver
+	float GetAssignmentWaste(const TArray<float>& MissingHealth, const TArray<int32>& PotionValues, const TArray<int32>& PotionPlayers)
+	{
+		TArray<float> Healing;
+		Healing.SetNumZeroed( MissingHealth.Num() );
+		for ( int32 Potion = 0; Potion < PotionValues.Num(); ++Potion )
+		{
+			if ( PotionPlayers[ Potion ] != INDEX_NONE )
+			{
+				Healing[ PotionPlayers[ Potion ] ] += PotionValues[ Potion ];
+			}
+		}
+
+		float Waste = 0.f;
+		for ( int32 Player = 0; Player < MissingHealth.Num(); ++Player )
+		{
+			Waste += MissingHealth[ Player ] <= 0.f ? Healing[ Player ] : FMath::Abs( MissingHealth[ Player ] - Healing[ Player ] );
+		}
+		return Waste;
+	}
+
+	// The least waste of any assignment: every potion that heals goes to any player or is kept, (players + 1) ^ potions tries.
+	// Potions that heal nothing or less are always kept, as the solver never hands them out
+	float GetBruteForceWaste(const TArray<float>& MissingHealth, const TArray<int32>& PotionValues)
+	{
+		TArray<int32> PotionPlayers;
+		PotionPlayers.Init( INDEX_NONE, PotionValues.Num() );
+
+		float BestWaste = GetAssignmentWaste( MissingHealth, PotionValues, PotionPlayers );
+		while ( true )
+		{
+			// Counts through the assignments with INDEX_NONE as the lowest digit
+			int32 Potion = 0;
+			while ( Potion < PotionPlayers.Num() && ( PotionValues[ Potion ] <= 0 || PotionPlayers[ Potion ] == MissingHealth.Num() - 1 ) )
+			{
+				PotionPlayers[ Potion++ ] = INDEX_NONE;
+			}
+			if ( Potion == PotionPlayers.Num() )
+			{
+				return BestWaste;
+			}
+			++PotionPlayers[ Potion ];
+
+			BestWaste = FMath::Min( BestWaste, GetAssignmentWaste( MissingHealth, PotionValues, PotionPlayers ) );
+		}
+	}
+
+	// Small random cases, including players missing nothing and potions healing nothing, have to be solved by
+	// the Exact method with the least waste there is
+	void RunBruteForceCheck(const int32 CasesNum)
+	{
+		FRandomStream Random( CasesNum );
+		int32 MismatchesNum = 0;
+		for ( int32 Case = 0; Case < CasesNum; ++Case )
+		{
+			TArray<float> MissingHealth;
+			const int32 PlayersNum = Random.RandRange( 1, 3 );
+			for ( int32 Player = 0; Player < PlayersNum; ++Player )
+			{
+				MissingHealth.Add( static_cast<float>( Random.RandRange( -10, 110 ) ) + ( Random.RandRange( 0, 1 ) == 0 ? 0.f : 0.5f ) );
+			}
+			TArray<int32> PotionValues;
+			const int32 PotionsNum = Random.RandRange( 0, 6 );
+			for ( int32 Potion = 0; Potion < PotionsNum; ++Potion )
+			{
+				PotionValues.Add( Random.RandRange( -5, 55 ) );
+			}
+
+			const FPotionAssignment Assignment = FPotionAssignmentSolver::Solve( MissingHealth, PotionValues );
+			const float Waste = GetAssignmentWaste( MissingHealth, PotionValues, Assignment.PotionPlayers );
+			if ( Assignment.Report.Method != EPotionAssignmentMethod::Exact || !FMath::IsNearlyEqual( Waste, GetBruteForceWaste( MissingHealth, PotionValues ), 0.01f ) )
+			{
+				++MismatchesNum;
+			}
+		}
+
+		UE_LOG( LogTemp, Display, TEXT("%d small cases against every possible assignment: %d wrong%s"),
+		        CasesNum, MismatchesNum, MismatchesNum == 0 ? TEXT("") : TEXT(" MISMATCH") );
+	}
+
+	void RunSize(const int32 PlayersNum, const int32 PotionsNum, const bool bFewKinds)
+	{
+		static const int32 PotionKinds[] = { 25, 50, 100, 150, 250, 500 };
+
+		FRandomStream Random( PlayersNum * 31 + PotionsNum );
+		TArray<float> MissingHealth;
+		for ( int32 Player = 0; Player < PlayersNum; ++Player )
+		{
+			MissingHealth.Add( static_cast<float>( Random.RandRange( 0, 1000 ) ) );
+		}
+		TArray<int32> PotionValues;
+		for ( int32 Potion = 0; Potion < PotionsNum; ++Potion )
+		{
+			PotionValues.Add( bFewKinds ? PotionKinds[ Random.RandRange( 0, UE_ARRAY_COUNT( PotionKinds ) - 1 ) ] : Random.RandRange( 10, 500 ) );
+		}
+
+		double StartSeconds = FPlatformTime::Seconds();
+		const FLegacyResult Legacy = LegacyHealPlayers( MissingHealth, PotionValues );
+		const double LegacySeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		const FPotionAssignment Assignment = FPotionAssignmentSolver::Solve( MissingHealth, PotionValues );
+		const FPotionAssignmentReport& Report = Assignment.Report;
+
+		// The report is checked against the assignment itself, so a wrong solve does not go unnoticed
+		int32 UsedPotionsNum = 0;
+		for ( const int32 Player : Assignment.PotionPlayers )
+		{
+			if ( Player != INDEX_NONE )
+			{
+				++UsedPotionsNum;
+			}
+		}
+		const float Waste = GetAssignmentWaste( MissingHealth, PotionValues, Assignment.PotionPlayers );
+		const bool bMatches = UsedPotionsNum == Report.UsedPotionsNum && FMath::IsNearlyEqual( Waste, Report.GetWaste(), 1.f );
+
+		UE_LOG( LogTemp, Display, TEXT("%d players, %d potions of %s: legacy waste %.0f (%.0f overheal, %d potions) in %.3f ms, %s waste %.0f (%.0f overheal, %d potions) in %.3f ms%s"),
+		        PlayersNum, PotionsNum, bFewKinds ? TEXT("6 kinds") : TEXT("random values"),
+		        Legacy.Overheal + Legacy.MissingHealthLeft, Legacy.Overheal, Legacy.UsedPotionsNum, LegacySeconds * 1000.0,
+		        *UEnum::GetValueAsString( Report.Method ), Report.GetWaste(), Report.Overheal, Report.UsedPotionsNum, Report.SolveMilliseconds,
+		        bMatches ? TEXT("") : TEXT(" MISMATCH") );
+	}
+
+	void Run(const TArray<FString>& Arguments)
+	{
+		TArray<FIntPoint> Sizes;
+		for ( int32 Argument = 0; Argument + 1 < Arguments.Num(); Argument += 2 )
+		{
+			const int32 PlayersNum = FCString::Atoi( *Arguments[ Argument ] );
+			const int32 PotionsNum = FCString::Atoi( *Arguments[ Argument + 1 ] );
+			if ( 0 < PlayersNum && 0 <= PotionsNum )
+			{
+				Sizes.Add( FIntPoint( PlayersNum, PotionsNum ) );
+			}
+		}
+		if ( Sizes.Num() == 0 )
+		{
+			Sizes = { FIntPoint( 4, 8 ), FIntPoint( 8, 12 ), FIntPoint( 100, 1000 ), FIntPoint( 500, 5000 ), FIntPoint( 1000, 10000 ) };
+		}
+
+		RunBruteForceCheck( 500 );
+		for ( const FIntPoint& Size : Sizes )
+		{
+			RunSize( Size.X, Size.Y, true );
+			RunSize( Size.X, Size.Y, false );
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkAssignmentCommand(
+		TEXT("Potions.BenchmarkAssignment"),
+		TEXT("Compares the potion assignment solver with the original HealPlayers loop. Usage: Potions.BenchmarkAssignment [PlayersNum PotionsNum]..."),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &Run ) );
+}
@@ -0,0 +1,437 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PotionAssignmentSolver.h"
+
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	/** Potions grouped by healing value, in ascending order of value */
+	struct FPotionStacks
+	{
+		TArray<int32> Values;
+		TArray<int32> Counts;
+
+		/** Potion indices, stack by stack: the ones of stack S start at Starts[ S ] */
+		TArray<int32> PotionIndices;
+		TArray<int32> Starts;
+
+		/** For stacks given by the caller, the index the caller knows every stack by */
+		TArray<int32> Sources;
+	};
+
+	FPotionStacks MakeStacks(const TArray<int32>& PotionValues)
+	{
+		FPotionStacks Stacks;
+
+		// Potions that heal nothing are never worth using
+		for ( int32 PotionIndex = 0; PotionIndex < PotionValues.Num(); ++PotionIndex )
+		{
+			if ( 0 < PotionValues[ PotionIndex ] )
+			{
+				Stacks.PotionIndices.Add( PotionIndex );
+			}
+		}
+		Stacks.PotionIndices.StableSort( [&PotionValues](const int32 A, const int32 B)
+		{
+			return PotionValues[ A ] < PotionValues[ B ];
+		} );
+
+		for ( int32 Position = 0; Position < Stacks.PotionIndices.Num(); ++Position )
+		{
+			const int32 Value = PotionValues[ Stacks.PotionIndices[ Position ] ];
+			if ( Stacks.Values.Num() == 0 || Stacks.Values.Last() != Value )
+			{
+				Stacks.Values.Add( Value );
+				Stacks.Counts.Add( 0 );
+				Stacks.Starts.Add( Position );
+			}
+			++Stacks.Counts.Last();
+		}
+		return Stacks;
+	}
+
+	float GetWaste(const float MissingHealth, const int32 Healing)
+	{
+		return FMath::Abs( MissingHealth - static_cast<float>( Healing ) );
+	}
+
+	/**
+	 * The largest sum the knapsack looks at for a player, or INDEX_NONE when it is over KnapsackMaxSteps.
+	 * A sum of at least the missing health plus the largest potion wastes more than the same sum without
+	 * any one of its potions. Worked out in double, since huge missing health would overflow an int32
+	 */
+	int32 GetKnapsackMaxSum(const float MissingHealth, const FPotionStacks& Stacks)
+	{
+		const double MaxSum = FMath::CeilToDouble( static_cast<double>( MissingHealth ) ) + Stacks.Values.Last();
+		return MaxSum <= static_cast<double>( FPotionAssignmentSolver::KnapsackMaxSteps ) ? static_cast<int32>( MaxSum ) : INDEX_NONE;
+	}
+
+	/**
+	 * Dynamic programming over what is left after each player: a state is how many potions of every stack
+	 * are left, numbered in mixed radix. Every player goes over every combination of the potions left in
+	 * every state reached so far, so the cost is bounded by ExactMaxTransitions per player
+	 */
+	bool SolveExact(const TArray<float>& MissingHealth, const TArray<int32>& Players, const FPotionStacks& Stacks, TArray<FPotionStackUse>& OutUses)
+	{
+		if ( FPotionAssignmentSolver::ExactMaxPlayers < Players.Num() )
+		{
+			return false;
+		}
+
+		const int32 StacksNum = Stacks.Values.Num();
+		TArray<int32> Strides;
+		int32 StatesNum = 1;
+		int64 TransitionsNum = 1;
+		for ( const int32 Count : Stacks.Counts )
+		{
+			Strides.Add( StatesNum );
+			StatesNum *= Count + 1;
+			TransitionsNum *= static_cast<int64>( Count + 1 ) * ( Count + 2 ) / 2;
+			if ( FPotionAssignmentSolver::ExactMaxTransitions < TransitionsNum )
+			{
+				return false;
+			}
+		}
+
+		auto GetLeft = [&Strides, &Stacks](const int32 State, const int32 Stack)
+		{
+			return State / Strides[ Stack ] % ( Stacks.Counts[ Stack ] + 1 );
+		};
+
+		constexpr float Unreached = TNumericLimits<float>::Max();
+		TArray<float> Waste;
+		Waste.Init( Unreached, StatesNum );
+		Waste[ StatesNum - 1 ] = 0.f;
+		TArray<float> NextWaste;
+
+		// For every player and every state after it, the state before it
+		TArray<int32> PreviousStates;
+		PreviousStates.SetNumUninitialized( Players.Num() * StatesNum );
+
+		TArray<int32> Left;
+		TArray<int32> Taken;
+		Left.SetNumZeroed( StacksNum );
+		Taken.SetNumZeroed( StacksNum );
+		for ( int32 Player = 0; Player < Players.Num(); ++Player )
+		{
+			const float PlayerMissingHealth = MissingHealth[ Players[ Player ] ];
+			int32* Previous = PreviousStates.GetData() + Player * StatesNum;
+			NextWaste.Init( Unreached, StatesNum );
+
+			for ( int32 State = 0; State < StatesNum; ++State )
+			{
+				if ( Waste[ State ] == Unreached )
+				{
+					continue;
+				}
+
+				for ( int32 Stack = 0; Stack < StacksNum; ++Stack )
+				{
+					Left[ Stack ] = GetLeft( State, Stack );
+					Taken[ Stack ] = 0;
+				}
+
+				// Every combination of the potions left, counted like an odometer
+				int32 TakenState = 0;
+				int32 Healing = 0;
+				while ( true )
+				{
+					const float NewWaste = Waste[ State ] + GetWaste( PlayerMissingHealth, Healing );
+					if ( NewWaste < NextWaste[ State - TakenState ] )
+					{
+						NextWaste[ State - TakenState ] = NewWaste;
+						Previous[ State - TakenState ] = State;
+					}
+
+					int32 Stack = 0;
+					for ( ; Stack < StacksNum; ++Stack )
+					{
+						if ( Taken[ Stack ] < Left[ Stack ] )
+						{
+							++Taken[ Stack ];
+							TakenState += Strides[ Stack ];
+							Healing += Stacks.Values[ Stack ];
+							break;
+						}
+						TakenState -= Taken[ Stack ] * Strides[ Stack ];
+						Healing -= Taken[ Stack ] * Stacks.Values[ Stack ];
+						Taken[ Stack ] = 0;
+					}
+					if ( Stack == StacksNum )
+					{
+						break;
+					}
+				}
+			}
+			Swap( Waste, NextWaste );
+		}
+
+		// The least waste, and of equally good ones the one that keeps the most healing for later
+		int32 BestState = INDEX_NONE;
+		int64 BestHealingLeft = 0;
+		for ( int32 State = 0; State < StatesNum; ++State )
+		{
+			if ( Waste[ State ] == Unreached || ( BestState != INDEX_NONE && Waste[ BestState ] < Waste[ State ] ) )
+			{
+				continue;
+			}
+
+			int64 HealingLeft = 0;
+			for ( int32 Stack = 0; Stack < StacksNum; ++Stack )
+			{
+				HealingLeft += static_cast<int64>( GetLeft( State, Stack ) ) * Stacks.Values[ Stack ];
+			}
+			if ( BestState == INDEX_NONE || Waste[ State ] < Waste[ BestState ] || BestHealingLeft < HealingLeft )
+			{
+				BestState = State;
+				BestHealingLeft = HealingLeft;
+			}
+		}
+
+		int32 State = BestState;
+		for ( int32 Player = Players.Num() - 1; 0 <= Player; --Player )
+		{
+			const int32 PreviousState = PreviousStates[ Player * StatesNum + State ];
+			for ( int32 Stack = 0; Stack < StacksNum; ++Stack )
+			{
+				const int32 Used = GetLeft( PreviousState, Stack ) - GetLeft( State, Stack );
+				if ( 0 < Used )
+				{
+					OutUses.Add( { Players[ Player ], Stack, Used } );
+				}
+			}
+			State = PreviousState;
+		}
+		return true;
+	}
+
+	/**
+	 * Player by player, the potions left that come closest to the missing health: a bounded subset sum over
+	 * the stacks, remembering for every reachable sum the stack that reached it first and how many of its
+	 * potions that took, which is also what the combination is read back from
+	 */
+	void SolveKnapsack(const TArray<float>& MissingHealth, const TArray<int32>& Players, FPotionStacks& Stacks, TArray<FPotionStackUse>& OutUses)
+	{
+		const int32 StacksNum = Stacks.Values.Num();
+		TArray<int32> Layers;
+		TArray<int32> Copies;
+		for ( const int32 Player : Players )
+		{
+			const float PlayerMissingHealth = MissingHealth[ Player ];
+
+			// No player misses more than the one the knapsack was chosen for, so this always fits
+			const int32 MaxSum = GetKnapsackMaxSum( PlayerMissingHealth, Stacks );
+			check( MaxSum != INDEX_NONE );
+			Layers.Init( INDEX_NONE, MaxSum + 1 );
+			Copies.SetNumUninitialized( MaxSum + 1 );
+			Layers[ 0 ] = StacksNum;
+			Copies[ 0 ] = 0;
+
+			// Largest potions first, so sums are reached with large potions where they can be and the small
+			// ones stay for the fine adjustments of the players after this one
+			for ( int32 Stack = StacksNum - 1; 0 <= Stack; --Stack )
+			{
+				const int32 Value = Stacks.Values[ Stack ];
+				const int32 Count = Stacks.Counts[ Stack ];
+				for ( int32 Sum = Value; Count != 0 && Sum <= MaxSum; ++Sum )
+				{
+					const int32 From = Sum - Value;
+					if ( Layers[ Sum ] != INDEX_NONE || Layers[ From ] == INDEX_NONE )
+					{
+						continue;
+					}
+
+					const int32 SumCopies = ( Layers[ From ] == Stack ? Copies[ From ] : 0 ) + 1;
+					if ( SumCopies <= Count )
+					{
+						Layers[ Sum ] = Stack;
+						Copies[ Sum ] = SumCopies;
+					}
+				}
+			}
+
+			// Of equally good sums the smaller one, which keeps more for the players after this one
+			int32 BestSum = 0;
+			for ( int32 Sum = 1; Sum <= MaxSum; ++Sum )
+			{
+				if ( Layers[ Sum ] != INDEX_NONE && GetWaste( PlayerMissingHealth, Sum ) < GetWaste( PlayerMissingHealth, BestSum ) )
+				{
+					BestSum = Sum;
+				}
+			}
+
+			for ( int32 Sum = BestSum; 0 < Sum; )
+			{
+				const int32 Stack = Layers[ Sum ];
+				OutUses.Add( { Player, Stack, Copies[ Sum ] } );
+				Stacks.Counts[ Stack ] -= Copies[ Sum ];
+				Sum -= Copies[ Sum ] * Stacks.Values[ Stack ];
+			}
+		}
+	}
+
+	/** Player by player, the largest potions that fit, then the smallest one over what is left if that wastes less */
+	void SolveGreedy(const TArray<float>& MissingHealth, const TArray<int32>& Players, FPotionStacks& Stacks, TArray<FPotionStackUse>& OutUses)
+	{
+		const int32 StacksNum = Stacks.Values.Num();
+		for ( const int32 Player : Players )
+		{
+			float HealthLeft = MissingHealth[ Player ];
+			for ( int32 Stack = StacksNum - 1; 0 <= Stack && 0.f < HealthLeft; --Stack )
+			{
+				const int32 Value = Stacks.Values[ Stack ];
+				const int32 Used = FMath::Min( Stacks.Counts[ Stack ], FMath::FloorToInt( HealthLeft / static_cast<float>( Value ) ) );
+				if ( 0 < Used )
+				{
+					OutUses.Add( { Player, Stack, Used } );
+					Stacks.Counts[ Stack ] -= Used;
+					HealthLeft -= static_cast<float>( Used * Value );
+				}
+			}
+
+			for ( int32 Stack = 0; Stack < StacksNum && 0.f < HealthLeft; ++Stack )
+			{
+				const float Value = static_cast<float>( Stacks.Values[ Stack ] );
+				if ( Stacks.Counts[ Stack ] == 0 || Value <= HealthLeft )
+				{
+					continue;
+				}
+				if ( Value - HealthLeft < HealthLeft )
+				{
+					OutUses.Add( { Player, Stack, 1 } );
+					--Stacks.Counts[ Stack ];
+				}
+				break;
+			}
+		}
+	}
+
+	/** Shares the stacks out and fills in everything in the report but the potion count and the time */
+	TArray<FPotionStackUse> SolveOnStacks(const TArray<float>& MissingHealth, FPotionStacks& Stacks, FPotionAssignmentReport& Report)
+	{
+		Report.PlayersNum = MissingHealth.Num();
+
+		// Only players missing health take part, the ones missing the most first
+		TArray<int32> Players;
+		float MaxMissingHealth = 0.f;
+		for ( int32 Player = 0; Player < MissingHealth.Num(); ++Player )
+		{
+			if ( 0.f < MissingHealth[ Player ] )
+			{
+				Players.Add( Player );
+				MaxMissingHealth = FMath::Max( MaxMissingHealth, MissingHealth[ Player ] );
+			}
+		}
+		Players.StableSort( [&MissingHealth](const int32 A, const int32 B)
+		{
+			return MissingHealth[ A ] > MissingHealth[ B ];
+		} );
+
+		TArray<FPotionStackUse> Uses;
+		if ( 0 < Players.Num() && 0 < Stacks.Values.Num() )
+		{
+			// Players times stacks times the largest sum, divided out so that nothing overflows
+			const int32 MaxSum = GetKnapsackMaxSum( MaxMissingHealth, Stacks );
+			const bool bKnapsackFits = MaxSum != INDEX_NONE
+				&& static_cast<int64>( Players.Num() ) * Stacks.Values.Num() <= FPotionAssignmentSolver::KnapsackMaxSteps / MaxSum;
+			if ( SolveExact( MissingHealth, Players, Stacks, Uses ) )
+			{
+				Report.Method = EPotionAssignmentMethod::Exact;
+			}
+			else if ( bKnapsackFits )
+			{
+				Report.Method = EPotionAssignmentMethod::Knapsack;
+				SolveKnapsack( MissingHealth, Players, Stacks, Uses );
+			}
+			else
+			{
+				Report.Method = EPotionAssignmentMethod::Greedy;
+				SolveGreedy( MissingHealth, Players, Stacks, Uses );
+			}
+		}
+
+		TArray<float> Healing;
+		Healing.SetNumZeroed( MissingHealth.Num() );
+		for ( const FPotionStackUse& Use : Uses )
+		{
+			Healing[ Use.Player ] += static_cast<float>( Use.Count * Stacks.Values[ Use.Stack ] );
+			Report.UsedPotionsNum += Use.Count;
+		}
+
+		for ( const int32 Player : Players )
+		{
+			const float Difference = Healing[ Player ] - MissingHealth[ Player ];
+			if ( 0.f < Difference )
+			{
+				Report.Overheal += Difference;
+			}
+			else
+			{
+				Report.MissingHealthLeft -= Difference;
+			}
+		}
+		return Uses;
+	}
+}
+
+FPotionAssignment FPotionAssignmentSolver::Solve(const TArray<float>& MissingHealth, const TArray<int32>& PotionValues)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FPotionAssignment Assignment;
+	Assignment.PotionPlayers.Init( INDEX_NONE, PotionValues.Num() );
+	Assignment.Report.PotionsNum = PotionValues.Num();
+
+	FPotionStacks Stacks = MakeStacks( PotionValues );
+	const TArray<FPotionStackUse> Uses = SolveOnStacks( MissingHealth, Stacks, Assignment.Report );
+
+	// Potions of the same stack are handed out in the order they were added
+	TArray<int32> NextPositions = Stacks.Starts;
+	for ( const FPotionStackUse& Use : Uses )
+	{
+		for ( int32 Copy = 0; Copy < Use.Count; ++Copy )
+		{
+			Assignment.PotionPlayers[ Stacks.PotionIndices[ NextPositions[ Use.Stack ]++ ] ] = Use.Player;
+		}
+	}
+
+	Assignment.Report.SolveMilliseconds = static_cast<float>( ( FPlatformTime::Seconds() - StartSeconds ) * 1000.0 );
+	return Assignment;
+}
+
+FPotionStackAssignment FPotionAssignmentSolver::SolveStacks(const TArray<float>& MissingHealth, const TArray<int32>& StackValues, const TArray<int32>& StackCounts)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FPotionStackAssignment Assignment;
+
+	// Empty stacks and potions that heal nothing are left out, the rest go in ascending order of value
+	FPotionStacks Stacks;
+	for ( int32 Stack = 0; Stack < StackValues.Num(); ++Stack )
+	{
+		Assignment.Report.PotionsNum += StackCounts[ Stack ];
+		if ( 0 < StackValues[ Stack ] && 0 < StackCounts[ Stack ] )
+		{
+			Stacks.Sources.Add( Stack );
+		}
+	}
+	Stacks.Sources.StableSort( [&StackValues](const int32 A, const int32 B)
+	{
+		return StackValues[ A ] < StackValues[ B ];
+	} );
+	for ( const int32 Source : Stacks.Sources )
+	{
+		Stacks.Values.Add( StackValues[ Source ] );
+		Stacks.Counts.Add( StackCounts[ Source ] );
+	}
+
+	Assignment.Uses = SolveOnStacks( MissingHealth, Stacks, Assignment.Report );
+	for ( FPotionStackUse& Use : Assignment.Uses )
+	{
+		Use.Stack = Stacks.Sources[ Use.Stack ];
+	}
+
+	Assignment.Report.SolveMilliseconds = static_cast<float>( ( FPlatformTime::Seconds() - StartSeconds ) * 1000.0 );
+	return Assignment;
+}
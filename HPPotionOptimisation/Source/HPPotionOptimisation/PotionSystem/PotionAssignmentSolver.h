@@ -0,0 +1,102 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PotionAssignmentSolver.generated.h"
+
+UENUM( BlueprintType )
+enum class EPotionAssignmentMethod : uint8
+{
+	/** Every way of sharing out the potions was considered, the waste is the smallest possible */
+	Exact,
+
+	/** Players with the most missing health first, each given the best combination of the potions left */
+	Knapsack,
+
+	/** Players with the most missing health first, each given the largest potions that fit */
+	Greedy
+};
+
+/** How well the potions were shared out, and how long it took */
+USTRUCT( BlueprintType )
+struct FPotionAssignmentReport
+{
+	GENERATED_BODY()
+
+	UPROPERTY( BlueprintReadOnly )
+	EPotionAssignmentMethod Method = EPotionAssignmentMethod::Exact;
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 PlayersNum = 0;
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 PotionsNum = 0;
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 UsedPotionsNum = 0;
+
+	/** Healing beyond max health, summed over all players */
+	UPROPERTY( BlueprintReadOnly )
+	float Overheal = 0.f;
+
+	/** Health still missing after healing, summed over all players */
+	UPROPERTY( BlueprintReadOnly )
+	float MissingHealthLeft = 0.f;
+
+	UPROPERTY( BlueprintReadOnly )
+	float SolveMilliseconds = 0.f;
+
+	float GetWaste() const
+	{
+		return Overheal + MissingHealthLeft;
+	}
+};
+
+struct FPotionAssignment
+{
+	/** Index of the player every potion goes to, INDEX_NONE for the potions that are kept */
+	TArray<int32> PotionPlayers;
+
+	FPotionAssignmentReport Report;
+};
+
+/** Count potions of stack Stack go to player Player */
+struct FPotionStackUse
+{
+	int32 Player;
+	int32 Stack;
+	int32 Count;
+};
+
+struct FPotionStackAssignment
+{
+	/** At most one use per player and stack */
+	TArray<FPotionStackUse> Uses;
+
+	FPotionAssignmentReport Report;
+};
+
+/**
+ * Shares potions out between players so that the waste, overheal plus health still missing, summed over
+ * all players, is as small as it can be found. A potion is only used when it brings its player closer to
+ * max health, the others are kept for later.
+ *
+ * Potions are grouped by healing value first, so a thousand copies of the same potion cost as much as one.
+ * Small inputs are solved exactly, bigger ones player by player, and the biggest greedily
+ */
+class HPPOTIONOPTIMISATION_API FPotionAssignmentSolver
+{
+public:
+	static FPotionAssignment Solve(const TArray<float>& MissingHealth, const TArray<int32>& PotionValues);
+
+	/** The same for potions already grouped: StackCounts[ S ] potions healing StackValues[ S ] each */
+	static FPotionStackAssignment SolveStacks(const TArray<float>& MissingHealth, const TArray<int32>& StackValues, const TArray<int32>& StackCounts);
+
+	/** The exact solve goes over every potion combination left after each player, so both have to stay small */
+	static constexpr int32 ExactMaxPlayers = 16;
+	static constexpr int64 ExactMaxTransitions = 1 << 18;
+
+	/** Above this many subset sum steps over all players, the greedy solve is used instead of the knapsack */
+	static constexpr int64 KnapsackMaxSteps = 1 << 26;
+};
@@ -0,0 +1,212 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Potions counted per kind: identical potions share one stack, and the stacks are kept in ascending order of
+ * the healing they give to a player with the given max health. A Fenwick tree over the stack counts finds
+ * the largest potion that heals at most some amount, and takes potions out, in O(log n) without shifting
+ * anything. Only adding a kind never seen before inserts a stack and rebuilds the tree.
+ *
+ * PotionType needs GetTotalHealingValue( MaxHealth ) and IsSameKind( Other )
+ */
+template <typename PotionType>
+class TPotionStacks
+{
+public:
+	void Add(const PotionType& Potion, const int32 Count = 1)
+	{
+		if ( Count <= 0 )
+		{
+			return;
+		}
+
+		const float HealingValue = Potion.GetTotalHealingValue( MaxHealth );
+		int32 Stack = GetFirstStackAbove( HealingValue );
+		for ( int32 SameValueStack = Stack - 1; 0 <= SameValueStack && Stacks[ SameValueStack ].HealingValue == HealingValue; --SameValueStack )
+		{
+			if ( Stacks[ SameValueStack ].Potion.IsSameKind( Potion ) )
+			{
+				Stacks[ SameValueStack ].Count += Count;
+				AddToTree( SameValueStack, Count );
+				PotionsNum += Count;
+				return;
+			}
+		}
+
+		Stacks.Insert( { Potion, HealingValue, Count }, Stack );
+		PotionsNum += Count;
+		RebuildTree();
+	}
+
+	/** Takes Count potions out of the stack, which stays in place even once it is empty */
+	void Remove(const int32 Stack, const int32 Count = 1)
+	{
+		check( 0 <= Count && Count <= Stacks[ Stack ].Count );
+		Stacks[ Stack ].Count -= Count;
+		AddToTree( Stack, -Count );
+		PotionsNum -= Count;
+	}
+
+	/** The non empty stack with the largest healing value not above MaxHealingValue, or INDEX_NONE */
+	int32 FindLargestAtMost(const float MaxHealingValue) const
+	{
+		const int32 PotionsAtMost = GetPotionsNumBefore( GetFirstStackAbove( MaxHealingValue ) );
+		return PotionsAtMost == 0 ? INDEX_NONE : FindStackOfPotion( PotionsAtMost );
+	}
+
+	/** The non empty stack with the smallest healing value, or INDEX_NONE */
+	int32 FindSmallest() const
+	{
+		return PotionsNum == 0 ? INDEX_NONE : FindStackOfPotion( 1 );
+	}
+
+	/** Orders the stacks by the healing they give to a player with this max health, dropping the empty ones */
+	void SetMaxHealth(const float NewMaxHealth)
+	{
+		if ( MaxHealth == NewMaxHealth )
+		{
+			return;
+		}
+
+		MaxHealth = NewMaxHealth;
+		for ( FStack& Stack : Stacks )
+		{
+			Stack.HealingValue = Stack.Potion.GetTotalHealingValue( MaxHealth );
+		}
+		RemoveEmptyStacks();
+	}
+
+	void RemoveEmptyStacks()
+	{
+		Stacks.RemoveAll( [](const FStack& Stack)
+		{
+			return Stack.Count == 0;
+		} );
+		Stacks.StableSort( [](const FStack& A, const FStack& B)
+		{
+			return A.HealingValue < B.HealingValue;
+		} );
+		RebuildTree();
+	}
+
+	const PotionType& GetPotion(const int32 Stack) const
+	{
+		return Stacks[ Stack ].Potion;
+	}
+
+	float GetHealingValue(const int32 Stack) const
+	{
+		return Stacks[ Stack ].HealingValue;
+	}
+
+	int32 GetCount(const int32 Stack) const
+	{
+		return Stacks[ Stack ].Count;
+	}
+
+	int32 GetStacksNum() const
+	{
+		return Stacks.Num();
+	}
+
+	/** Potions in all stacks together */
+	int32 Num() const
+	{
+		return PotionsNum;
+	}
+
+private:
+	struct FStack
+	{
+		PotionType Potion;
+		float HealingValue;
+		int32 Count;
+	};
+
+	TArray<FStack> Stacks;
+
+	/** Fenwick tree over the stack counts: node N, kept at Tree[ N - 1 ], sums the N & -N stacks up to stack N - 1 */
+	TArray<int32> Tree;
+
+	int32 PotionsNum = 0;
+
+	float MaxHealth = 0.f;
+
+	int32 GetFirstStackAbove(const float HealingValue) const
+	{
+		int32 First = 0;
+		int32 Last = Stacks.Num();
+		while ( First < Last )
+		{
+			const int32 Middle = First + ( Last - First ) / 2;
+			if ( Stacks[ Middle ].HealingValue <= HealingValue )
+			{
+				First = Middle + 1;
+			}
+			else
+			{
+				Last = Middle;
+			}
+		}
+		return First;
+	}
+
+	void RebuildTree()
+	{
+		Tree.SetNumUninitialized( Stacks.Num() );
+		for ( int32 Stack = 0; Stack < Stacks.Num(); ++Stack )
+		{
+			Tree[ Stack ] = Stacks[ Stack ].Count;
+		}
+		for ( int32 Node = 1; Node <= Tree.Num(); ++Node )
+		{
+			const int32 Parent = Node + ( Node & -Node );
+			if ( Parent <= Tree.Num() )
+			{
+				Tree[ Parent - 1 ] += Tree[ Node - 1 ];
+			}
+		}
+	}
+
+	void AddToTree(const int32 Stack, const int32 Count)
+	{
+		for ( int32 Node = Stack + 1; Node <= Tree.Num(); Node += Node & -Node )
+		{
+			Tree[ Node - 1 ] += Count;
+		}
+	}
+
+	/** Potions in the stacks before this one */
+	int32 GetPotionsNumBefore(const int32 Stack) const
+	{
+		int32 Sum = 0;
+		for ( int32 Node = Stack; 0 < Node; Node -= Node & -Node )
+		{
+			Sum += Tree[ Node - 1 ];
+		}
+		return Sum;
+	}
+
+	/** The stack holding the Position-th potion, counting from 1, found by walking down the tree */
+	int32 FindStackOfPotion(int32 Position) const
+	{
+		int32 Node = 0;
+		int32 Step = 1;
+		while ( Step * 2 <= Tree.Num() )
+		{
+			Step *= 2;
+		}
+		for ( ; 0 < Step; Step /= 2 )
+		{
+			if ( Node + Step <= Tree.Num() && Tree[ Node + Step - 1 ] < Position )
+			{
+				Node += Step;
+				Position -= Tree[ Node - 1 ];
+			}
+		}
+		return Node;
+	}
+};
@@ -0,0 +1,220 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HPPotionOptimisation/PotionSystem/PotionAssignmentSolver.h"
+#include "HPPotionOptimisation/PotionSystem/PotionStacks.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+// Development self-check of the potion stacks, run from the console:
+//   Potions.CheckStacks [RoundsNum]
+// Every round runs random adds, max health changes, empty stack removals and best-fit takes on TPotionStacks
+// and on a plain array of potions, which has to give the same answers, then solves the same random party
+// with FPotionAssignmentSolver::Solve on single potions and SolveStacks on stacks. Without arguments it runs
+// 300 rounds. Every difference is logged as a MISMATCH.
+
+namespace PotionStacksCheck
+{
+	// A potion with all that TPotionStacks looks at: a flat and a max health based part, and a kind
+	struct FCheckPotion
+	{
+		int32 Kind = 0;
+		int32 HealingValue = 0;
+		float MaxHealthPercent = 0.f;
+
+		float GetTotalHealingValue(const float MaxHealth) const
+		{
+			return static_cast<float>( HealingValue ) + MaxHealth * MaxHealthPercent;
+		}
+
+		bool IsSameKind(const FCheckPotion& Other) const
+		{
+			return Kind == Other.Kind && HealingValue == Other.HealingValue && MaxHealthPercent == Other.MaxHealthPercent;
+		}
+	};
+
+	// Random operations on the stacks and on every potion kept one by one; returns the first difference, or nullptr
+	const TCHAR* CheckStacksAgainstArray(FRandomStream& Random)
+	{
+		TPotionStacks<FCheckPotion> Stacks;
+		TArray<FCheckPotion> Potions;
+		float MaxHealth = 0.f;
+
+		for ( int32 Operation = 0; Operation < 400; ++Operation )
+		{
+			const int32 OperationKind = Random.RandRange( 0, 5 );
+			if ( OperationKind < 2 )
+			{
+				FCheckPotion Potion;
+				Potion.Kind = Random.RandRange( 0, 2 );
+				Potion.HealingValue = Random.RandRange( 0, 19 );
+				Potion.MaxHealthPercent = Random.RandRange( 0, 2 ) * 0.05f;
+				const int32 Count = Random.RandRange( 1, 3 );
+				Stacks.Add( Potion, Count );
+				for ( int32 Copy = 0; Copy < Count; ++Copy )
+				{
+					Potions.Add( Potion );
+				}
+			}
+			else if ( OperationKind == 2 )
+			{
+				MaxHealth = Random.RandRange( 0, 2 ) * 100.f;
+				Stacks.SetMaxHealth( MaxHealth );
+			}
+			else if ( OperationKind == 3 )
+			{
+				Stacks.RemoveEmptyStacks();
+			}
+			else
+			{
+				const float MaxHealingValue = static_cast<float>( Random.RandRange( -5, 54 ) );
+				int32 BestPotion = INDEX_NONE;
+				for ( int32 Potion = 0; Potion < Potions.Num(); ++Potion )
+				{
+					const float HealingValue = Potions[ Potion ].GetTotalHealingValue( MaxHealth );
+					if ( HealingValue <= MaxHealingValue && ( BestPotion == INDEX_NONE || Potions[ BestPotion ].GetTotalHealingValue( MaxHealth ) < HealingValue ) )
+					{
+						BestPotion = Potion;
+					}
+				}
+
+				const int32 Stack = Stacks.FindLargestAtMost( MaxHealingValue );
+				if ( ( Stack == INDEX_NONE ) != ( BestPotion == INDEX_NONE ) )
+				{
+					return TEXT("FindLargestAtMost found a potion where there is none, or none where there is one");
+				}
+				if ( Stack != INDEX_NONE )
+				{
+					if ( Stacks.GetCount( Stack ) <= 0 || Stacks.GetHealingValue( Stack ) != Potions[ BestPotion ].GetTotalHealingValue( MaxHealth ) )
+					{
+						return TEXT("FindLargestAtMost found an empty stack or not the largest potion");
+					}
+
+					const FCheckPotion Taken = Stacks.GetPotion( Stack );
+					Stacks.Remove( Stack );
+					Potions.RemoveAt( Potions.IndexOfByPredicate( [&Taken](const FCheckPotion& Potion)
+					{
+						return Potion.IsSameKind( Taken );
+					} ) );
+				}
+
+				const int32 SmallestStack = Stacks.FindSmallest();
+				if ( ( SmallestStack == INDEX_NONE ) != ( Potions.Num() == 0 ) )
+				{
+					return TEXT("FindSmallest disagrees on whether any potion is left");
+				}
+				for ( const FCheckPotion& Potion : Potions )
+				{
+					if ( Potion.GetTotalHealingValue( MaxHealth ) < Stacks.GetHealingValue( SmallestStack ) )
+					{
+						return TEXT("FindSmallest did not find the smallest potion");
+					}
+				}
+			}
+
+			if ( Stacks.Num() != Potions.Num() )
+			{
+				return TEXT("the potion count differs");
+			}
+			for ( int32 Stack = 1; Stack < Stacks.GetStacksNum(); ++Stack )
+			{
+				if ( Stacks.GetHealingValue( Stack ) < Stacks.GetHealingValue( Stack - 1 ) )
+				{
+					return TEXT("the stacks are out of order");
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	// The same party and potions through Solve and, grouped into stacks in descending order, through SolveStacks
+	const TCHAR* CheckSolveStacksAgainstSolve(FRandomStream& Random, const bool bLarge)
+	{
+		TArray<float> MissingHealth;
+		const int32 PlayersNum = Random.RandRange( 1, bLarge ? 300 : 6 );
+		for ( int32 Player = 0; Player < PlayersNum; ++Player )
+		{
+			MissingHealth.Add( static_cast<float>( Random.RandRange( -100, 899 ) ) );
+		}
+		TArray<int32> PotionValues;
+		const int32 PotionsNum = Random.RandRange( 0, bLarge ? 1999 : 9 );
+		for ( int32 Potion = 0; Potion < PotionsNum; ++Potion )
+		{
+			PotionValues.Add( Random.RandRange( 0, 7 ) * 50 - 10 );
+		}
+
+		TArray<int32> SortedValues = PotionValues;
+		SortedValues.Sort( [](const int32 A, const int32 B)
+		{
+			return A > B;
+		} );
+		TArray<int32> StackValues;
+		TArray<int32> StackCounts;
+		for ( const int32 Value : SortedValues )
+		{
+			if ( StackValues.Num() == 0 || StackValues.Last() != Value )
+			{
+				StackValues.Add( Value );
+				StackCounts.Add( 0 );
+			}
+			++StackCounts.Last();
+		}
+
+		const FPotionAssignmentReport Report = FPotionAssignmentSolver::Solve( MissingHealth, PotionValues ).Report;
+		const FPotionStackAssignment StackAssignment = FPotionAssignmentSolver::SolveStacks( MissingHealth, StackValues, StackCounts );
+		const FPotionAssignmentReport& StackReport = StackAssignment.Report;
+		if ( Report.Method != StackReport.Method || Report.UsedPotionsNum != StackReport.UsedPotionsNum || Report.PotionsNum != StackReport.PotionsNum
+			|| !FMath::IsNearlyEqual( Report.GetWaste(), StackReport.GetWaste(), 0.01f ) )
+		{
+			return TEXT("SolveStacks and Solve disagree");
+		}
+
+		TArray<int32> UsedCounts;
+		UsedCounts.SetNumZeroed( StackValues.Num() );
+		for ( const FPotionStackUse& Use : StackAssignment.Uses )
+		{
+			if ( StackValues[ Use.Stack ] <= 0 )
+			{
+				return TEXT("SolveStacks used a potion that heals nothing");
+			}
+			UsedCounts[ Use.Stack ] += Use.Count;
+		}
+		for ( int32 Stack = 0; Stack < StackValues.Num(); ++Stack )
+		{
+			if ( StackCounts[ Stack ] < UsedCounts[ Stack ] )
+			{
+				return TEXT("SolveStacks used more potions than a stack holds");
+			}
+		}
+		return nullptr;
+	}
+
+	void Run(const TArray<FString>& Arguments)
+	{
+		const int32 RoundsNum = Arguments.Num() != 0 ? FMath::Max( FCString::Atoi( *Arguments[ 0 ] ), 1 ) : 300;
+
+		FRandomStream Random( RoundsNum );
+		int32 StacksMismatchesNum = 0;
+		int32 SolveMismatchesNum = 0;
+		for ( int32 Round = 0; Round < RoundsNum; ++Round )
+		{
+			if ( const TCHAR* Difference = CheckStacksAgainstArray( Random ) )
+			{
+				UE_LOG( LogTemp, Warning, TEXT("Round %d of the stacks: %s"), Round, Difference );
+				++StacksMismatchesNum;
+			}
+			if ( const TCHAR* Difference = CheckSolveStacksAgainstSolve( Random, RoundsNum / 2 <= Round ) )
+			{
+				UE_LOG( LogTemp, Warning, TEXT("Round %d of the solve: %s"), Round, Difference );
+				++SolveMismatchesNum;
+			}
+		}
+
+		UE_LOG( LogTemp, Display, TEXT("%d rounds: stacks against a plain array %d wrong, SolveStacks against Solve %d wrong%s"),
+		        RoundsNum, StacksMismatchesNum, SolveMismatchesNum, StacksMismatchesNum + SolveMismatchesNum == 0 ? TEXT("") : TEXT(" MISMATCH") );
+	}
+
+	FAutoConsoleCommand CheckStacksCommand(
+		TEXT("Potions.CheckStacks"),
+		TEXT("Checks TPotionStacks against a plain array of potions and SolveStacks against Solve on random inputs. Usage: Potions.CheckStacks [RoundsNum]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &Run ) );
+}
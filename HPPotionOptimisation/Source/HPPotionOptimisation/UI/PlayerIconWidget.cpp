@@ -1,3 +1,102 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "PlayerIconWidget.h"
+
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	FHealthBarUpdateStats TotalHealthBarUpdateStats;
+
+	FAutoConsoleCommand HealthBarStatsCommand(
+		TEXT("Potions.HealthBarStats"),
+		TEXT("Logs how many health bar updates all player icons were asked for, and how many reached the Blueprint"),
+		FConsoleCommandDelegate::CreateLambda( []()
+		{
+			UE_LOG( LogTemp, Display, TEXT("Health bar updates: %d requested, %d pushed, %d saved (%d below the display epsilon)"),
+			        TotalHealthBarUpdateStats.RequestsNum, TotalHealthBarUpdateStats.PushesNum, TotalHealthBarUpdateStats.GetSavedNum(),
+			        TotalHealthBarUpdateStats.SkippedBelowEpsilonNum );
+		} ) );
+}
+
+void UPlayerIconWidget::RequestCurrentHealthPercent(float NewCurrentHealthPercent)
+{
+	RequestPercent( CurrentHealthPercent, NewCurrentHealthPercent );
+}
+
+void UPlayerIconWidget::RequestPotentialHealthPercent(float NewPotentialHealthPercent)
+{
+	RequestPercent( PotentialHealthPercent, NewPotentialHealthPercent );
+}
+
+void UPlayerIconWidget::SetInitialHealthPercent(float NewCurrentHealthPercent)
+{
+	RequestPercent( CurrentHealthPercent, NewCurrentHealthPercent );
+	CurrentHealthPercent.bIsDirty = false;
+	CurrentHealthPercent.Pushed = NewCurrentHealthPercent;
+	++HealthBarUpdateStats.PushesNum;
+	++TotalHealthBarUpdateStats.PushesNum;
+	SetCurrentHealthPercent( NewCurrentHealthPercent );
+}
+
+FHealthBarUpdateStats UPlayerIconWidget::GetHealthBarUpdateStats() const
+{
+	return HealthBarUpdateStats;
+}
+
+FHealthBarUpdateStats UPlayerIconWidget::GetTotalHealthBarUpdateStats()
+{
+	return TotalHealthBarUpdateStats;
+}
+
+void UPlayerIconWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick( MyGeometry, InDeltaTime );
+
+	SecondsSinceLastPush += InDeltaTime;
+	if ( ( !CurrentHealthPercent.bIsDirty && !PotentialHealthPercent.bIsDirty ) || SecondsSinceLastPush < MinSecondsBetweenPushes )
+	{
+		return;
+	}
+	SecondsSinceLastPush = 0.f;
+
+	if ( ConsumePercent( CurrentHealthPercent ) )
+	{
+		SetCurrentHealthPercent( CurrentHealthPercent.Pushed );
+	}
+	if ( ConsumePercent( PotentialHealthPercent ) )
+	{
+		SetPotentialHealthPercent( PotentialHealthPercent.Pushed );
+	}
+}
+
+void UPlayerIconWidget::RequestPercent(FPendingPercent& Percent, float NewPercent)
+{
+	Percent.Pending = NewPercent;
+	Percent.bIsDirty = true;
+	++HealthBarUpdateStats.RequestsNum;
+	++TotalHealthBarUpdateStats.RequestsNum;
+}
+
+bool UPlayerIconWidget::ConsumePercent(FPendingPercent& Percent)
+{
+	if ( !Percent.bIsDirty )
+	{
+		return false;
+	}
+	Percent.bIsDirty = false;
+
+	// An empty or full bar is always shown exactly, however close the last push was
+	const bool bIsBarEnd = Percent.Pending <= 0.f || 1.f <= Percent.Pending;
+	if ( Percent.Pending == Percent.Pushed || ( !bIsBarEnd && FMath::Abs( Percent.Pending - Percent.Pushed ) < DisplayEpsilon ) )
+	{
+		++HealthBarUpdateStats.SkippedBelowEpsilonNum;
+		++TotalHealthBarUpdateStats.SkippedBelowEpsilonNum;
+		return false;
+	}
+
+	Percent.Pushed = Percent.Pending;
+	++HealthBarUpdateStats.PushesNum;
+	++TotalHealthBarUpdateStats.PushesNum;
+	return true;
+}
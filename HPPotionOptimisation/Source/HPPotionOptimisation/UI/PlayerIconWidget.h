@@ -6,6 +6,28 @@
 #include "Blueprint/UserWidget.h"
 #include "PlayerIconWidget.generated.h"
 
+/** How many health bar changes were asked for, and how many of them reached the Blueprint */
+USTRUCT( BlueprintType )
+struct FHealthBarUpdateStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 RequestsNum = 0;
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 PushesNum = 0;
+
+	/** Pushes left out because the percent moved less than DisplayEpsilon since the last one */
+	UPROPERTY( BlueprintReadOnly )
+	int32 SkippedBelowEpsilonNum = 0;
+
+	int32 GetSavedNum() const
+	{
+		return RequestsNum - PushesNum;
+	}
+};
+
 /**
  * 
 */
@@ -26,4 +48,52 @@ public:
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void SetPotentialHealthPercent(float NewPotentialHealthPercent);
+
+	/**
+	 * Health changes go through these instead of the events above: only the latest percent is kept, and it is
+	 * pushed to the Blueprint on the next tick, at most every MinSecondsBetweenPushes
+	 */
+	void RequestCurrentHealthPercent(float NewCurrentHealthPercent);
+
+	void RequestPotentialHealthPercent(float NewPotentialHealthPercent);
+
+	/** Pushes the health the bar starts with right away and counts it, so later requests are compared to it */
+	void SetInitialHealthPercent(float NewCurrentHealthPercent);
+
+	UFUNCTION( BlueprintPure, Category = "UI" )
+	FHealthBarUpdateStats GetHealthBarUpdateStats() const;
+
+	/** Summed over all player icons since the start */
+	static FHealthBarUpdateStats GetTotalHealthBarUpdateStats();
+
+protected:
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+
+	/** Zero pushes every frame the health changed in */
+	UPROPERTY( EditAnywhere, Category = "UI", meta = ( ClampMin = "0" ) )
+	float MinSecondsBetweenPushes = 0.f;
+
+	/** Smaller changes of a percent, from 0 to 1, do not show on the bar and are not pushed */
+	UPROPERTY( EditAnywhere, Category = "UI", meta = ( ClampMin = "0" ) )
+	float DisplayEpsilon = 0.001f;
+
+private:
+	struct FPendingPercent
+	{
+		float Pending = 0.f;
+		float Pushed = -1.f;
+		bool bIsDirty = false;
+	};
+
+	FPendingPercent CurrentHealthPercent;
+	FPendingPercent PotentialHealthPercent;
+
+	float SecondsSinceLastPush = 0.f;
+
+	FHealthBarUpdateStats HealthBarUpdateStats;
+
+	void RequestPercent(FPendingPercent& Percent, float NewPercent);
+
+	/** Whether the pending percent is worth pushing, which also takes it off the dirty list */
+	bool ConsumePercent(FPendingPercent& Percent);
 };
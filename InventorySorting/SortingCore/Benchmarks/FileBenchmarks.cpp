@@ -0,0 +1,230 @@
+// Save and load benchmarks of the compact inventory file, against one length-prefixed name and value per item.
+// Loads are measured from memory and from a memory mapped file, and checked against the saved items
+
+#include "InventorySortingCore/StdInventoryTraits.h"
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace InventorySortingCore;
+
+namespace
+{
+	std::vector<FStdInventoryItem> MakeRandomItems(int32_t ItemsNum)
+	{
+		std::mt19937 Random( 12345 );
+		std::uniform_int_distribution<int32_t> NameDistribution( 0, 999 );
+		std::uniform_int_distribution<int32_t> ValueDistribution( -1000000, 1000000 );
+
+		std::vector<FStdInventoryItem> Items( ItemsNum );
+		for ( FStdInventoryItem& Item : Items )
+		{
+			Item.Name = "Item" + std::to_string( NameDistribution( Random ) );
+			Item.Value = ValueDistribution( Random );
+		}
+		return Items;
+	}
+
+	std::string SaveCompact(const std::vector<FStdInventoryItem>& Items)
+	{
+		FStringSink Sink;
+		TInventoryFileWriter<FStdInventoryTraits, FStringSink> Writer( Sink );
+		Writer.AddItems( Items );
+		Writer.Finish();
+		return std::move( Sink.Bytes );
+	}
+
+	// The baseline: every item written as it is, like a generic serializer does
+	std::string SaveRows(const std::vector<FStdInventoryItem>& Items)
+	{
+		std::string Bytes;
+		InventoryFile::AppendUInt32( Bytes, static_cast<uint32_t>( Items.size() ) );
+		for ( const FStdInventoryItem& Item : Items )
+		{
+			InventoryFile::AppendUInt32( Bytes, static_cast<uint32_t>( Item.Name.size() ) );
+			Bytes += Item.Name;
+			InventoryFile::AppendUInt32( Bytes, static_cast<uint32_t>( Item.Value ) );
+		}
+		return Bytes;
+	}
+
+	bool LoadRows(const uint8_t* Data, size_t Size, std::vector<FStdInventoryItem>& OutItems)
+	{
+		if ( Size < 4 )
+		{
+			return false;
+		}
+		const uint32_t ItemsNum = InventoryFile::LoadUInt32( Data );
+		size_t Offset = 4;
+		OutItems.reserve( ItemsNum );
+		for ( uint32_t Item = 0; Item < ItemsNum; Item++ )
+		{
+			if ( Size < Offset + 8 || Size - Offset - 8 < InventoryFile::LoadUInt32( Data + Offset ) )
+			{
+				return false;
+			}
+			const uint32_t Length = InventoryFile::LoadUInt32( Data + Offset );
+			std::string Name( reinterpret_cast<const char*>( Data + Offset + 4 ), Length );
+			OutItems.push_back( { std::move( Name ), static_cast<int32_t>( InventoryFile::LoadUInt32( Data + Offset + 4 + Length ) ) } );
+			Offset += 8 + Length;
+		}
+		return true;
+	}
+
+	bool AreSameItems(const std::vector<FStdInventoryItem>& Left, const std::vector<FStdInventoryItem>& Right)
+	{
+		if ( Left.size() != Right.size() )
+		{
+			return false;
+		}
+		for ( size_t Index = 0; Index < Left.size(); Index++ )
+		{
+			if ( Left[ Index ].Name != Right[ Index ].Name || Left[ Index ].Value != Right[ Index ].Value )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const uint8_t* AsBytes(const std::string& Bytes)
+	{
+		return reinterpret_cast<const uint8_t*>( Bytes.data() );
+	}
+
+	void SetCounters(benchmark::State& State, size_t FileSize)
+	{
+		State.SetItemsProcessed( State.iterations() * State.range( 0 ) );
+		State.counters[ "bytes_per_item" ] = static_cast<double>( FileSize ) / static_cast<double>( State.range( 0 ) );
+	}
+}
+
+static void BM_SaveCompact(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem> Items = MakeRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	size_t FileSize = 0;
+	for ( auto _ : State )
+	{
+		const std::string Bytes = SaveCompact( Items );
+		FileSize = Bytes.size();
+		benchmark::DoNotOptimize( Bytes.data() );
+	}
+	SetCounters( State, FileSize );
+}
+
+static void BM_SaveRows(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem> Items = MakeRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	size_t FileSize = 0;
+	for ( auto _ : State )
+	{
+		const std::string Bytes = SaveRows( Items );
+		FileSize = Bytes.size();
+		benchmark::DoNotOptimize( Bytes.data() );
+	}
+	SetCounters( State, FileSize );
+}
+
+static void BM_LoadCompact(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem> Items = MakeRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	const std::string Bytes = SaveCompact( Items );
+	std::vector<FStdInventoryItem> Loaded;
+	for ( auto _ : State )
+	{
+		Loaded.clear();
+		if ( !ReadInventoryFile<FStdInventoryTraits>( AsBytes( Bytes ), Bytes.size(), Loaded ) )
+		{
+			State.SkipWithError( "File could not be read" );
+			break;
+		}
+	}
+
+	if ( !AreSameItems( Items, Loaded ) )
+	{
+		State.SkipWithError( "Loaded items differ from the saved ones" );
+	}
+	SetCounters( State, Bytes.size() );
+}
+
+static void BM_LoadRows(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem> Items = MakeRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	const std::string Bytes = SaveRows( Items );
+	std::vector<FStdInventoryItem> Loaded;
+	for ( auto _ : State )
+	{
+		Loaded.clear();
+		if ( !LoadRows( AsBytes( Bytes ), Bytes.size(), Loaded ) )
+		{
+			State.SkipWithError( "File could not be read" );
+			break;
+		}
+	}
+
+	if ( !AreSameItems( Items, Loaded ) )
+	{
+		State.SkipWithError( "Loaded items differ from the saved ones" );
+	}
+	SetCounters( State, Bytes.size() );
+}
+
+// Names are only viewed in the mapping and values summed, nothing is copied: the floor of any load
+static void BM_VisitCompactMapped(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem> Items = MakeRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	const std::string Bytes = SaveCompact( Items );
+
+	char FilePath[] = "/tmp/InventoryFileBenchmarkXXXXXX";
+	const int File = mkstemp( FilePath );
+	if ( File < 0 || write( File, Bytes.data(), Bytes.size() ) != static_cast<ssize_t>( Bytes.size() ) )
+	{
+		State.SkipWithError( "Temporary file could not be written" );
+		return;
+	}
+	void* Mapping = mmap( nullptr, Bytes.size(), PROT_READ, MAP_PRIVATE, File, 0 );
+	if ( Mapping == MAP_FAILED )
+	{
+		State.SkipWithError( "Temporary file could not be mapped" );
+		close( File );
+		unlink( FilePath );
+		return;
+	}
+
+	int64_t ValueSum = 0;
+	size_t NamesBytes = 0;
+	for ( auto _ : State )
+	{
+		ValueSum = 0;
+		NamesBytes = 0;
+		VisitInventoryFile( static_cast<const uint8_t*>( Mapping ), Bytes.size(),
+			[&NamesBytes](std::string_view Utf8Name) { NamesBytes += Utf8Name.size(); },
+			[&ValueSum](uint32_t, int32_t Value) { ValueSum += Value; } );
+		benchmark::DoNotOptimize( ValueSum );
+	}
+
+	int64_t ExpectedSum = 0;
+	for ( const FStdInventoryItem& Item : Items )
+	{
+		ExpectedSum += Item.Value;
+	}
+	if ( ValueSum != ExpectedSum )
+	{
+		State.SkipWithError( "Mapped values differ from the saved ones" );
+	}
+
+	munmap( Mapping, Bytes.size() );
+	close( File );
+	unlink( FilePath );
+	SetCounters( State, Bytes.size() );
+}
+
+#define INVENTORY_FILE_SIZES ->Arg( 10000 )->Arg( 100000 )->Arg( 1000000 )->Unit( benchmark::kMillisecond )
+
+BENCHMARK( BM_SaveCompact ) INVENTORY_FILE_SIZES;
+BENCHMARK( BM_SaveRows ) INVENTORY_FILE_SIZES;
+BENCHMARK( BM_LoadCompact ) INVENTORY_FILE_SIZES;
+BENCHMARK( BM_LoadRows ) INVENTORY_FILE_SIZES;
+BENCHMARK( BM_VisitCompactMapped ) INVENTORY_FILE_SIZES;
@@ -0,0 +1,281 @@
+// Sorting benchmarks of the engine-independent core, the native counterpart of Inventory.BenchmarkSort.
+// Every case checks its result once and fails the run instead of reporting the time of a wrong sort.
+// Sizes are 10k, 100k and 1M items; names are drawn from 1000 distinct ones, like a real inventory.
+// Nearly sorted inputs are the common case of a sorted inventory with 1% new items added at the end
+
+#include "InventorySortingCore/StdInventoryTraits.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace InventorySortingCore;
+
+namespace
+{
+	constexpr int32_t NamesNum = 1000;
+
+	std::vector<FStdInventoryItem> MakeRandomItems(int32_t ItemsNum)
+	{
+		std::mt19937 Random( 12345 );
+		std::uniform_int_distribution<int32_t> NameDistribution( 0, NamesNum - 1 );
+		std::uniform_int_distribution<int32_t> ValueDistribution( -1000000, 1000000 );
+
+		std::vector<FStdInventoryItem> Items( ItemsNum );
+		for ( FStdInventoryItem& Item : Items )
+		{
+			Item.Name = "Item" + std::to_string( NameDistribution( Random ) );
+			Item.Value = ValueDistribution( Random );
+		}
+		return Items;
+	}
+
+	// Generated once per size and shared by every case, so all of them sort the same input
+	const std::vector<FStdInventoryItem>& GetRandomItems(int32_t ItemsNum)
+	{
+		static std::unordered_map<int32_t, std::vector<FStdInventoryItem>> ItemsBySize;
+		auto Found = ItemsBySize.find( ItemsNum );
+		if ( Found == ItemsBySize.end() )
+		{
+			Found = ItemsBySize.emplace( ItemsNum, MakeRandomItems( ItemsNum ) ).first;
+		}
+		return Found->second;
+	}
+
+	bool IsValueLess(const FStdInventoryItem& Left, const FStdInventoryItem& Right)
+	{
+		return Left.Value < Right.Value;
+	}
+
+	const std::vector<FStdInventoryItem>& GetNearlySortedItems(int32_t ItemsNum)
+	{
+		static std::unordered_map<int32_t, std::vector<FStdInventoryItem>> ItemsBySize;
+		auto Found = ItemsBySize.find( ItemsNum );
+		if ( Found == ItemsBySize.end() )
+		{
+			const int32_t AddedNum = ItemsNum / 100;
+			std::vector<FStdInventoryItem> Items = GetRandomItems( ItemsNum );
+			std::stable_sort( Items.begin(), Items.end() - AddedNum, IsValueLess );
+			Found = ItemsBySize.emplace( ItemsNum, std::move( Items ) ).first;
+		}
+		return Found->second;
+	}
+
+	bool IsNameLess(const FStdInventoryItem& Left, const FStdInventoryItem& Right)
+	{
+		return FStdInventoryTraits::CompareNames( Left.Name, Right.Name ) < 0;
+	}
+
+	template <typename F>
+	bool IsSorted(const std::vector<FStdInventoryItem>& Items, F Less)
+	{
+		for ( size_t Index = 1; Index < Items.size(); Index++ )
+		{
+			if ( Less( Items[ Index ], Items[ Index - 1 ] ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void SetItemsProcessed(benchmark::State& State)
+	{
+		State.SetItemsProcessed( State.iterations() * State.range( 0 ) );
+	}
+
+	// Copying the input is excluded from the timing, every iteration sorts the same order
+	template <typename SortType, typename F>
+	void RunItemsSortOf(benchmark::State& State, const std::vector<FStdInventoryItem>& Source, SortType Sort, F Less)
+	{
+		std::vector<FStdInventoryItem> Items;
+		for ( auto _ : State )
+		{
+			State.PauseTiming();
+			Items = Source;
+			State.ResumeTiming();
+
+			Sort( Items );
+			benchmark::ClobberMemory();
+		}
+
+		if ( !IsSorted( Items, Less ) )
+		{
+			State.SkipWithError( "Items are not sorted" );
+		}
+		SetItemsProcessed( State );
+	}
+
+	template <typename SortType, typename F>
+	void RunItemsSort(benchmark::State& State, SortType Sort, F Less)
+	{
+		RunItemsSortOf( State, GetRandomItems( static_cast<int32_t>( State.range( 0 ) ) ), Sort, Less );
+	}
+}
+
+static void BM_MergeSortItemsByValue(benchmark::State& State)
+{
+	RunItemsSort( State, [](std::vector<FStdInventoryItem>& Items) { SortArray( Items, IsValueLess ); }, IsValueLess );
+}
+
+static void BM_MergeSortItemsByName(benchmark::State& State)
+{
+	RunItemsSort( State, [](std::vector<FStdInventoryItem>& Items) { SortArray( Items, IsNameLess ); }, IsNameLess );
+}
+
+static void BM_ParallelSortItemsByValue(benchmark::State& State)
+{
+	RunItemsSort( State, [](std::vector<FStdInventoryItem>& Items)
+	{
+		ParallelSortArray( Items, IsValueLess, GetStdTasksNum(), FStdParallelFor() );
+	}, IsValueLess );
+}
+
+// Always splits into 8 tasks, so the cost of the parallel rounds shows even on a machine with fewer cores
+static void BM_ParallelSortItemsByValue8Tasks(benchmark::State& State)
+{
+	RunItemsSort( State, [](std::vector<FStdInventoryItem>& Items)
+	{
+		ParallelSortArray( Items, IsValueLess, 8, FStdParallelFor() );
+	}, IsValueLess );
+}
+
+static void BM_RadixSortValueKeys(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem>& Items = GetRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	std::vector<FSortKey> Keys;
+	for ( auto _ : State )
+	{
+		Keys.resize( Items.size() );
+		for ( int32_t Index = 0; Index < GetNum( Items ); Index++ )
+		{
+			Keys[ Index ] = { MakeValueSortKey( Items[ Index ].Value ), Index };
+		}
+		RadixSortKeys( Keys );
+		benchmark::DoNotOptimize( Keys.data() );
+	}
+
+	for ( size_t Position = 1; Position < Keys.size(); Position++ )
+	{
+		if ( Keys[ Position ].Key < Keys[ Position - 1 ].Key )
+		{
+			State.SkipWithError( "Keys are not sorted" );
+			break;
+		}
+	}
+	SetItemsProcessed( State );
+}
+
+// Whole inventory sorts through the core: keys and indices are sorted, then every item is moved once
+static void BM_CoreSortByValue(benchmark::State& State)
+{
+	FStdInventoryCore Core;
+	RunItemsSort( State, [&Core](std::vector<FStdInventoryItem>& Items) { Core.SortByValue( Items ); }, IsValueLess );
+}
+
+// Name ranks are cached by the core, so after the first iteration this is a radix sort of integers
+static void BM_CoreSortByName(benchmark::State& State)
+{
+	FStdInventoryCore Core;
+	RunItemsSort( State, [&Core](std::vector<FStdInventoryItem>& Items) { Core.SortByName( Items ); }, IsNameLess );
+}
+
+// Every strategy of the core on random and on nearly sorted items. The strategy Auto picked is reported as a counter
+template <ESortMode SortMode>
+static void RunCoreSortByValue(benchmark::State& State, const std::vector<FStdInventoryItem>& Source)
+{
+	FStdInventoryCore Core;
+	Core.SortMode = SortMode;
+	Core.bAllowParallelSort = false;
+	RunItemsSortOf( State, Source, [&Core](std::vector<FStdInventoryItem>& Items) { Core.SortByValue( Items ); }, IsValueLess );
+	State.counters[ "strategy" ] = static_cast<double>( Core.GetLastSortStats().Strategy );
+}
+
+template <ESortMode SortMode>
+static void BM_CoreSortRandomByValue(benchmark::State& State)
+{
+	RunCoreSortByValue<SortMode>( State, GetRandomItems( static_cast<int32_t>( State.range( 0 ) ) ) );
+}
+
+template <ESortMode SortMode>
+static void BM_CoreSortNearlySortedByValue(benchmark::State& State)
+{
+	RunCoreSortByValue<SortMode>( State, GetNearlySortedItems( static_cast<int32_t>( State.range( 0 ) ) ) );
+}
+
+static void BM_CoreTopItems(benchmark::State& State)
+{
+	const std::vector<FStdInventoryItem>& Items = GetRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	const std::vector<FSortFieldOrder> Fields = { { ESortField::Value, true }, { ESortField::Name, false } };
+	FStdInventoryCore Core;
+	std::vector<int32_t> Indices;
+	for ( auto _ : State )
+	{
+		Indices.clear();
+		Core.GetTopItemIndices( Items, Fields, 20, Indices );
+		benchmark::DoNotOptimize( Indices.data() );
+	}
+
+	std::vector<FStdInventoryItem> Sorted = Items;
+	Core.SortByFields( Sorted, Fields );
+	for ( size_t Position = 0; Position < Indices.size(); Position++ )
+	{
+		if ( Items[ Indices[ Position ] ].Value != Sorted[ Position ].Value || Items[ Indices[ Position ] ].Name != Sorted[ Position ].Name )
+		{
+			State.SkipWithError( "Top items differ from the sorted order" );
+			break;
+		}
+	}
+	SetItemsProcessed( State );
+}
+
+// One value change and one sorted page, against the sorted view kept up to date
+static void BM_CoreSortedViewUpdate(benchmark::State& State)
+{
+	std::vector<FStdInventoryItem> Items = GetRandomItems( static_cast<int32_t>( State.range( 0 ) ) );
+	FStdInventoryCore Core;
+	std::vector<int32_t> Page;
+	Core.GetSortedPageByValue( Items, 0, 20, Page );
+
+	std::mt19937 Random( 54321 );
+	std::uniform_int_distribution<int32_t> IndexDistribution( 0, GetNum( Items ) - 1 );
+	std::uniform_int_distribution<int32_t> ValueDistribution( -1000000, 1000000 );
+	for ( auto _ : State )
+	{
+		Core.SetItemValue( Items, IndexDistribution( Random ), ValueDistribution( Random ) );
+		Page.clear();
+		Core.GetSortedPageByValue( Items, 0, 20, Page );
+		benchmark::DoNotOptimize( Page.data() );
+	}
+
+	for ( size_t Position = 1; Position < Page.size(); Position++ )
+	{
+		if ( Items[ Page[ Position ] ].Value < Items[ Page[ Position - 1 ] ].Value )
+		{
+			State.SkipWithError( "Sorted page is out of order" );
+			break;
+		}
+	}
+}
+
+#define INVENTORY_SORT_SIZES ->Arg( 10000 )->Arg( 100000 )->Arg( 1000000 )->Unit( benchmark::kMillisecond )
+
+BENCHMARK( BM_MergeSortItemsByValue ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_MergeSortItemsByName ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_ParallelSortItemsByValue ) INVENTORY_SORT_SIZES->UseRealTime();
+BENCHMARK( BM_ParallelSortItemsByValue8Tasks ) INVENTORY_SORT_SIZES->UseRealTime();
+BENCHMARK( BM_RadixSortValueKeys ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_CoreSortByValue ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_CoreSortByName ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortRandomByValue, ESortMode::Items ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortRandomByValue, ESortMode::Keys ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortRandomByValue, ESortMode::Runs ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortRandomByValue, ESortMode::Unstable ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortRandomByValue, ESortMode::Auto ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortNearlySortedByValue, ESortMode::Items ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortNearlySortedByValue, ESortMode::Keys ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortNearlySortedByValue, ESortMode::Runs ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortNearlySortedByValue, ESortMode::Unstable ) INVENTORY_SORT_SIZES;
+BENCHMARK_TEMPLATE( BM_CoreSortNearlySortedByValue, ESortMode::Auto ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_CoreTopItems ) INVENTORY_SORT_SIZES;
+BENCHMARK( BM_CoreSortedViewUpdate ) INVENTORY_SORT_SIZES;
+
+BENCHMARK_MAIN();
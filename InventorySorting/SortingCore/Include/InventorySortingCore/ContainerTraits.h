@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+namespace InventorySortingCore
+{
+	// What the algorithms need from a container. The default fits std::vector and anything else with
+	// size(), resize(), clear(), reserve(), push_back(), pop_back() and contiguous data(); other containers specialize it
+	template <typename ContainerType>
+	struct TContainerTraits
+	{
+		static int32_t Num(const ContainerType& Container)
+		{
+			return static_cast<int32_t>( Container.size() );
+		}
+
+		static void SetNum(ContainerType& Container, int32_t Num)
+		{
+			Container.resize( Num );
+		}
+
+		static void Reset(ContainerType& Container)
+		{
+			Container.clear();
+		}
+
+		static void Reserve(ContainerType& Container, int32_t Num)
+		{
+			Container.reserve( Num );
+		}
+
+		template <typename ElementType>
+		static void Add(ContainerType& Container, ElementType&& Element)
+		{
+			Container.push_back( std::forward<ElementType>( Element ) );
+		}
+
+		static void RemoveLast(ContainerType& Container)
+		{
+			Container.pop_back();
+		}
+
+		static auto* GetData(ContainerType& Container)
+		{
+			return Container.data();
+		}
+
+		static const auto* GetData(const ContainerType& Container)
+		{
+			return Container.data();
+		}
+	};
+
+	template <typename ContainerType>
+	int32_t GetNum(const ContainerType& Container)
+	{
+		return TContainerTraits<ContainerType>::Num( Container );
+	}
+
+	template <typename ContainerType>
+	void SetNum(ContainerType& Container, int32_t Num)
+	{
+		TContainerTraits<ContainerType>::SetNum( Container, Num );
+	}
+
+	template <typename ContainerType>
+	void ResetContainer(ContainerType& Container)
+	{
+		TContainerTraits<ContainerType>::Reset( Container );
+	}
+
+	template <typename ContainerType>
+	void ReserveContainer(ContainerType& Container, int32_t Num)
+	{
+		TContainerTraits<ContainerType>::Reserve( Container, Num );
+	}
+
+	template <typename ContainerType, typename ElementType>
+	void AddElement(ContainerType& Container, ElementType&& Element)
+	{
+		TContainerTraits<ContainerType>::Add( Container, std::forward<ElementType>( Element ) );
+	}
+
+	template <typename ContainerType>
+	auto* GetData(ContainerType& Container)
+	{
+		return TContainerTraits<ContainerType>::GetData( Container );
+	}
+
+	template <typename ContainerType>
+	const auto* GetData(const ContainerType& Container)
+	{
+		return TContainerTraits<ContainerType>::GetData( Container );
+	}
+}
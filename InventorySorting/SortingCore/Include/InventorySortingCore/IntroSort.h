@@ -0,0 +1,98 @@
+#pragma once
+
+#include "MergeSort.h"
+#include <algorithm>
+#include <functional>
+
+namespace InventorySortingCore
+{
+	// Quicksort with a median of three pivot, which turns into heap sort once the partitions go DepthLimit
+	// levels deep, so bad pivots cannot make it quadratic. Small partitions go to insertion sort
+	template <typename T, typename F>
+	void IntroSortArrayPart(T* Array, int32_t LeftBorder, int32_t RightBorder, int32_t DepthLimit, F& Comparator)
+	{
+		while ( InsertionSortThreshold <= RightBorder - LeftBorder )
+		{
+			if ( DepthLimit-- == 0 )
+			{
+				std::make_heap( Array + LeftBorder, Array + RightBorder + 1, std::ref( Comparator ) );
+				std::sort_heap( Array + LeftBorder, Array + RightBorder + 1, std::ref( Comparator ) );
+				return;
+			}
+
+			// Ordering the first, middle and last items leaves the median in the middle and an item
+			// not smaller than it at the right border, which stops the left scan
+			const int32_t MidBorder = LeftBorder + ( RightBorder - LeftBorder ) / 2;
+			if ( Comparator( Array[ MidBorder ], Array[ LeftBorder ] ) )
+			{
+				std::swap( Array[ MidBorder ], Array[ LeftBorder ] );
+			}
+			if ( Comparator( Array[ RightBorder ], Array[ MidBorder ] ) )
+			{
+				std::swap( Array[ RightBorder ], Array[ MidBorder ] );
+				if ( Comparator( Array[ MidBorder ], Array[ LeftBorder ] ) )
+				{
+					std::swap( Array[ MidBorder ], Array[ LeftBorder ] );
+				}
+			}
+
+			// Hoare partition around the pivot parked at the left border
+			std::swap( Array[ LeftBorder ], Array[ MidBorder ] );
+			int32_t LeftIndex = LeftBorder;
+			int32_t RightIndex = RightBorder + 1;
+			while ( true )
+			{
+				do
+				{
+					LeftIndex++;
+				}
+				while ( Comparator( Array[ LeftIndex ], Array[ LeftBorder ] ) );
+
+				do
+				{
+					RightIndex--;
+				}
+				while ( Comparator( Array[ LeftBorder ], Array[ RightIndex ] ) );
+
+				if ( RightIndex <= LeftIndex )
+				{
+					break;
+				}
+				std::swap( Array[ LeftIndex ], Array[ RightIndex ] );
+			}
+			std::swap( Array[ LeftBorder ], Array[ RightIndex ] );
+
+			// Recursing into the smaller side only keeps the stack at O(log n)
+			if ( RightIndex - LeftBorder < RightBorder - RightIndex )
+			{
+				IntroSortArrayPart( Array, LeftBorder, RightIndex - 1, DepthLimit, Comparator );
+				LeftBorder = RightIndex + 1;
+			}
+			else
+			{
+				IntroSortArrayPart( Array, RightIndex + 1, RightBorder, DepthLimit, Comparator );
+				RightBorder = RightIndex - 1;
+			}
+		}
+
+		InsertionSortArrayPart( Array, LeftBorder, RightBorder, Comparator );
+	}
+
+	// Unstable sort in place: no scratch memory, but equal items may change their order
+	template <typename ContainerType, typename F>
+	void IntroSortArray(ContainerType& Array, F Comparator)
+	{
+		const int32_t ArrayNum = GetNum( Array );
+		if ( ArrayNum < 2 )
+		{
+			return;
+		}
+
+		int32_t DepthLimit = 0;
+		for ( int32_t Num = ArrayNum; 1 < Num; Num /= 2 )
+		{
+			DepthLimit += 2;
+		}
+		IntroSortArrayPart( GetData( Array ), 0, ArrayNum - 1, DepthLimit, Comparator );
+	}
+}
@@ -0,0 +1,527 @@
+#pragma once
+
+#include "ContainerTraits.h"
+#include "IntroSort.h"
+#include "MergeSort.h"
+#include "NaturalMergeSort.h"
+#include "ParallelSort.h"
+#include "RadixSort.h"
+#include "SortedView.h"
+#include "TopK.h"
+#include <chrono>
+#include <type_traits>
+#include <unordered_map>
+
+namespace InventorySortingCore
+{
+	enum class ESortMode : uint8_t
+	{
+		// The comparison sort moves the items themselves, strings included, on every merge
+		Items,
+
+		// A compact array of keys and item indices is sorted instead, then every item is moved once.
+		// Composite orders have no single key and sort the items
+		Keys,
+
+		// Merges the runs already in order, TimSort style: close to linear when few items are out of place
+		Runs,
+
+		// Introsort of the items: no scratch memory, but equal items may change their order
+		Unstable,
+
+		// One pass counts the runs already in order: few runs are merged, otherwise the keys are sorted.
+		// Never picks Unstable
+		Auto
+	};
+
+	// What the last sort did. Strategy is the one that ran, never Auto
+	struct FSortStats
+	{
+		ESortMode Strategy = ESortMode::Items;
+		int32_t ItemsNum = 0;
+
+		// Runs found by Auto, counted up to one past the most it would still merge; -1 if it did not look
+		int32_t RunsNum = -1;
+
+		double Seconds = 0.0;
+	};
+
+	// Auto merges the runs when they average at least this many items
+	constexpr int32_t AutoMinAverageRunNum = 32;
+
+	enum class ESortField : uint8_t
+	{
+		Name,
+		Value
+	};
+
+	// One key of a composite order; later keys only decide between items equal in all earlier ones
+	struct FSortFieldOrder
+	{
+		ESortField Field = ESortField::Value;
+		bool bDescending = false;
+	};
+
+	// Compares items by a list of keys in order. FieldContainerType holds anything with a Field that
+	// converts to ESortField and a bDescending, so engine types with the same layout can be passed as they are
+	template <typename TraitsType, typename FieldContainerType>
+	struct TItemComparator
+	{
+		using ItemType = typename TraitsType::ItemType;
+
+		FieldContainerType Fields;
+
+		// Negative if Left comes first, positive if Right does, zero if equal in every key
+		int32_t Compare(const ItemType& Left, const ItemType& Right) const
+		{
+			for ( const auto& Order : Fields )
+			{
+				int32_t Comparison = 0;
+				if ( static_cast<ESortField>( Order.Field ) == ESortField::Name )
+				{
+					Comparison = TraitsType::CompareNames( TraitsType::GetName( Left ), TraitsType::GetName( Right ) );
+				}
+				else
+				{
+					const int32_t LeftValue = TraitsType::GetValue( Left );
+					const int32_t RightValue = TraitsType::GetValue( Right );
+					Comparison = LeftValue < RightValue ? -1 : ( RightValue < LeftValue ? 1 : 0 );
+				}
+
+				if ( Comparison != 0 )
+				{
+					return Order.bDescending ? -Comparison : Comparison;
+				}
+			}
+			return 0;
+		}
+
+		bool operator()(const ItemType& Left, const ItemType& Right) const
+		{
+			return Compare( Left, Right ) < 0;
+		}
+	};
+
+	/**
+	 * Sorting and sorted views of an inventory, independent of any engine. The items live in a container owned
+	 * by the caller and are passed to every call; the core only keeps what is derived from them: the sorted
+	 * views and the name ranks. TraitsType describes the item and the platform:
+	 *
+	 *   ItemType, NameType                         item and name types
+	 *   template <typename T> using TContainer     contiguous container with operator[] and TContainerTraits
+	 *   GetName( Item ), GetValue( Item ), SetValue( Item, Value )
+	 *   CompareNames( Left, Right )                negative, zero or positive, like strcmp
+	 *   FNameHash, FNameEqual                      hash and equality of names, for the rank cache
+	 *   GetTasksNum(), ParallelFor( Num, Body )    how parallel sorts are run
+	 */
+	template <typename TraitsType>
+	class TInventoryCore
+	{
+	public:
+		using ItemType = typename TraitsType::ItemType;
+		using NameType = typename TraitsType::NameType;
+
+		template <typename T>
+		using TContainer = typename TraitsType::template TContainer<T>;
+
+		using ItemContainerType = TContainer<ItemType>;
+		using IndexContainerType = TContainer<int32_t>;
+		using KeyContainerType = TContainer<FSortKey>;
+
+		ESortMode SortMode = ESortMode::Auto;
+
+		// Comparison sorts of at least 2 * ParallelSortChunkMin items are split over TraitsType::GetTasksNum() tasks.
+		// The result is the same as the single-threaded sort
+		bool bAllowParallelSort = true;
+
+		int32_t AddItem(ItemContainerType& Items, const ItemType& Item)
+		{
+			const int32_t Index = GetNum( Items );
+			AddElement( Items, Item );
+
+			if ( bSortedViewsBuilt )
+			{
+				NameView.Insert( Index, MakeNameViewLess( Items ) );
+				ValueView.Insert( Index, MakeValueViewLess( Items ) );
+			}
+			return Index;
+		}
+
+		// Removes the item by moving the last item into its place
+		void RemoveItem(ItemContainerType& Items, int32_t Index)
+		{
+			if ( Index < 0 || GetNum( Items ) <= Index )
+			{
+				return;
+			}
+
+			const int32_t LastIndex = GetNum( Items ) - 1;
+			auto NameLess = MakeNameViewLess( Items );
+			auto ValueLess = MakeValueViewLess( Items );
+
+			// The nodes are found by comparing items, so both leave the views before anything moves
+			if ( bSortedViewsBuilt )
+			{
+				NameView.Remove( Index, NameLess );
+				ValueView.Remove( Index, ValueLess );
+				if ( Index != LastIndex )
+				{
+					NameView.Remove( LastIndex, NameLess );
+					ValueView.Remove( LastIndex, ValueLess );
+				}
+			}
+
+			if ( Index != LastIndex )
+			{
+				Items[ Index ] = std::move( Items[ LastIndex ] );
+			}
+			TContainerTraits<ItemContainerType>::RemoveLast( Items );
+
+			// The last item now lives at Index
+			if ( bSortedViewsBuilt && Index != LastIndex )
+			{
+				NameView.Insert( Index, NameLess );
+				ValueView.Insert( Index, ValueLess );
+			}
+		}
+
+		void SetItemValue(ItemContainerType& Items, int32_t Index, int32_t Value)
+		{
+			if ( Index < 0 || GetNum( Items ) <= Index )
+			{
+				return;
+			}
+
+			auto ValueLess = MakeValueViewLess( Items );
+
+			if ( bSortedViewsBuilt )
+			{
+				ValueView.Remove( Index, ValueLess );
+			}
+
+			TraitsType::SetValue( Items[ Index ], Value );
+
+			if ( bSortedViewsBuilt )
+			{
+				ValueView.Insert( Index, ValueLess );
+			}
+		}
+
+		void SortByName(ItemContainerType& Items)
+		{
+			SortItems( Items, [](const ItemType& Left, const ItemType& Right)
+			{
+				return TraitsType::CompareNames( TraitsType::GetName( Left ), TraitsType::GetName( Right ) ) < 0;
+			}, [this](ItemContainerType& ItemsToSort)
+			{
+				KeyContainerType Keys;
+				MakeSortedNameKeys( ItemsToSort, Keys );
+				ApplySortedKeys( ItemsToSort, Keys );
+			} );
+		}
+
+		void SortByValue(ItemContainerType& Items)
+		{
+			SortItems( Items, [](const ItemType& Left, const ItemType& Right)
+			{
+				return TraitsType::GetValue( Left ) < TraitsType::GetValue( Right );
+			}, [](ItemContainerType& ItemsToSort)
+			{
+				KeyContainerType Keys;
+				MakeSortedValueKeys( ItemsToSort, Keys );
+				ApplySortedKeys( ItemsToSort, Keys );
+			} );
+		}
+
+		// Sort by several keys, e.g. value descending, then name. Stable unless SortMode is Unstable
+		template <typename FieldContainerType>
+		void SortByFields(ItemContainerType& Items, const FieldContainerType& Fields)
+		{
+			TItemComparator<TraitsType, FieldContainerType> Comparator;
+			Comparator.Fields = Fields;
+			SortItems( Items, Comparator, nullptr );
+		}
+
+		const FSortStats& GetLastSortStats() const
+		{
+			return LastSortStats;
+		}
+
+		// Sorted orders without moving any item: Items[ OutIndices[ 0 ] ] is the first item in that order
+		void GetSortedIndicesByName(const ItemContainerType& Items, IndexContainerType& OutIndices) const
+		{
+			KeyContainerType Keys;
+			MakeSortedNameKeys( Items, Keys );
+			GetKeyIndices( Keys, OutIndices );
+		}
+
+		void GetSortedIndicesByValue(const ItemContainerType& Items, IndexContainerType& OutIndices) const
+		{
+			KeyContainerType Keys;
+			MakeSortedValueKeys( Items, Keys );
+			GetKeyIndices( Keys, OutIndices );
+		}
+
+		// Indices of the first Count items in the order given by Fields, without sorting the rest. Items equal
+		// in every key are in item order, so the result is the start of what SortByFields would produce
+		template <typename FieldContainerType>
+		void GetTopItemIndices(const ItemContainerType& Items, const FieldContainerType& Fields, int32_t Count, IndexContainerType& OutIndices) const
+		{
+			TItemComparator<TraitsType, FieldContainerType> Comparator;
+			Comparator.Fields = Fields;
+
+			// Ties are broken by index, which is what makes the heap agree with the stable sort
+			GetTopIndices( GetNum( Items ), Count, [&Items, &Comparator](int32_t Left, int32_t Right)
+			{
+				const int32_t Comparison = Comparator.Compare( Items[ Left ], Items[ Right ] );
+				return Comparison != 0 ? Comparison < 0 : Left < Right;
+			}, OutIndices );
+		}
+
+		// Up to Count item indices in sorted order, starting with the item at rank First. The sorted views
+		// are built by the first call and then kept up to date by AddItem, RemoveItem and SetItemValue in
+		// O(log n) each, so a sorted page costs O(log n + Count) instead of a full sort. Any change made
+		// other than through this class needs InvalidateSortedViews; views of another number of items than
+		// Items holds are rebuilt even without it, since their indices could point past the end
+		void GetSortedPageByName(const ItemContainerType& Items, int32_t First, int32_t Count, IndexContainerType& OutIndices)
+		{
+			BuildSortedViewsIfNeeded( Items );
+			NameView.GetPage( First, Count, OutIndices );
+		}
+
+		void GetSortedPageByValue(const ItemContainerType& Items, int32_t First, int32_t Count, IndexContainerType& OutIndices)
+		{
+			BuildSortedViewsIfNeeded( Items );
+			ValueView.GetPage( First, Count, OutIndices );
+		}
+
+		void InvalidateSortedViews()
+		{
+			bSortedViewsBuilt = false;
+			NameView.Reset();
+			ValueView.Reset();
+		}
+
+		// Sorts on TraitsType's tasks when the array is big enough and parallel sorting is allowed
+		template <typename ContainerType, typename F>
+		void SortOnTasks(ContainerType& Array, F Comparator) const
+		{
+			const int32_t TasksNum = bAllowParallelSort ? TraitsType::GetTasksNum() : 1;
+			ParallelSortArray( Array, Comparator, TasksNum, [](int32_t Num, auto&& Body)
+			{
+				TraitsType::ParallelFor( Num, Body );
+			} );
+		}
+
+	private:
+		// Runs the strategy SortMode asks for and records it in LastSortStats. SortKeys( Items ) sorts through
+		// the keys, or is nullptr when the order has no single key
+		template <typename F, typename KeySortType>
+		void SortItems(ItemContainerType& Items, F Comparator, KeySortType SortKeys)
+		{
+			constexpr bool bHasKeys = !std::is_same_v<KeySortType, std::nullptr_t>;
+			const auto StartTime = std::chrono::steady_clock::now();
+
+			InvalidateSortedViews();
+			LastSortStats = FSortStats();
+			LastSortStats.ItemsNum = GetNum( Items );
+
+			ESortMode Strategy = SortMode;
+			if ( Strategy == ESortMode::Auto )
+			{
+				Strategy = ChooseStrategy( Items, Comparator, bHasKeys );
+			}
+			if ( Strategy == ESortMode::Keys && !bHasKeys )
+			{
+				Strategy = ESortMode::Items;
+			}
+
+			switch ( Strategy )
+			{
+			case ESortMode::Keys:
+				if constexpr ( bHasKeys )
+				{
+					SortKeys( Items );
+				}
+				break;
+			case ESortMode::Runs:
+				NaturalMergeSortArray( Items, Comparator );
+				break;
+			case ESortMode::Unstable:
+				IntroSortArray( Items, Comparator );
+				break;
+			default:
+				SortOnTasks( Items, Comparator );
+				break;
+			}
+
+			LastSortStats.Strategy = Strategy;
+			LastSortStats.Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - StartTime ).count();
+		}
+
+		// Runs when the items are already mostly in order, the key sort for anything else it can be used for
+		template <typename F>
+		ESortMode ChooseStrategy(const ItemContainerType& Items, F& Comparator, bool bHasKeys)
+		{
+			const int32_t ItemsNum = GetNum( Items );
+			const int32_t MaxRunsNum = std::max( 1, ItemsNum / AutoMinAverageRunNum );
+			LastSortStats.RunsNum = CountRuns( GetData( Items ), ItemsNum, Comparator, MaxRunsNum );
+			if ( LastSortStats.RunsNum <= MaxRunsNum )
+			{
+				return ESortMode::Runs;
+			}
+			return bHasKeys ? ESortMode::Keys : ESortMode::Items;
+		}
+
+		// Orders of the sorted views, ties are broken by item index like in the stable sorts
+		static auto MakeNameViewLess(const ItemContainerType& Items)
+		{
+			return [&Items](int32_t LeftIndex, int32_t RightIndex)
+			{
+				const int32_t Comparison = TraitsType::CompareNames( TraitsType::GetName( Items[ LeftIndex ] ), TraitsType::GetName( Items[ RightIndex ] ) );
+				return Comparison != 0 ? Comparison < 0 : LeftIndex < RightIndex;
+			};
+		}
+
+		static auto MakeValueViewLess(const ItemContainerType& Items)
+		{
+			return [&Items](int32_t LeftIndex, int32_t RightIndex)
+			{
+				const int32_t LeftValue = TraitsType::GetValue( Items[ LeftIndex ] );
+				const int32_t RightValue = TraitsType::GetValue( Items[ RightIndex ] );
+				return LeftValue != RightValue ? LeftValue < RightValue : LeftIndex < RightIndex;
+			};
+		}
+
+		void BuildSortedViewsIfNeeded(const ItemContainerType& Items)
+		{
+			if ( bSortedViewsBuilt && NameView.Num() == GetNum( Items ) )
+			{
+				return;
+			}
+
+			// The stable key sorts give exactly the order of the views, which then take O(n) to build
+			IndexContainerType Indices;
+			GetSortedIndicesByName( Items, Indices );
+			NameView.Build( Indices );
+
+			ResetContainer( Indices );
+			GetSortedIndicesByValue( Items, Indices );
+			ValueView.Build( Indices );
+
+			bSortedViewsBuilt = true;
+		}
+
+		// Keys and indices of all items, sorted
+		static void MakeSortedValueKeys(const ItemContainerType& Items, KeyContainerType& Keys)
+		{
+			const int32_t ItemsNum = GetNum( Items );
+			SetNum( Keys, ItemsNum );
+			FSortKey* KeysData = GetData( Keys );
+			for ( int32_t Index = 0; Index < ItemsNum; Index++ )
+			{
+				KeysData[ Index ] = { MakeValueSortKey( TraitsType::GetValue( Items[ Index ] ) ), Index };
+			}
+
+			RadixSortKeys( Keys );
+		}
+
+		void MakeSortedNameKeys(const ItemContainerType& Items, KeyContainerType& Keys) const
+		{
+			if ( !FillNameKeys( Items, Keys ) )
+			{
+				RebuildNameRanks( Items );
+				FillNameKeys( Items, Keys );
+			}
+
+			// Equal names have equal ranks and the radix sort is stable, so they keep their order
+			RadixSortKeys( Keys );
+		}
+
+		// Fills the name keys from the cached ranks, false if some name has no rank yet
+		bool FillNameKeys(const ItemContainerType& Items, KeyContainerType& Keys) const
+		{
+			const int32_t ItemsNum = GetNum( Items );
+			SetNum( Keys, ItemsNum );
+			FSortKey* KeysData = GetData( Keys );
+			for ( int32_t Index = 0; Index < ItemsNum; Index++ )
+			{
+				const auto Rank = NameRanks.find( TraitsType::GetName( Items[ Index ] ) );
+				if ( Rank == NameRanks.end() )
+				{
+					return false;
+				}
+				KeysData[ Index ] = { Rank->second, Index };
+			}
+			return true;
+		}
+
+		// Ranks every name in the inventory in alphabetical order, so sorting by name compares integers.
+		// Only names not seen before make the ranks be rebuilt, which sorts the unique names once.
+		// Names that compare equal share a rank even if the name type tells them apart
+		void RebuildNameRanks(const ItemContainerType& Items) const
+		{
+			// Starting over also forgets the names no item uses any more
+			NameRanks.clear();
+			TContainer<NameType> Names;
+			const int32_t ItemsNum = GetNum( Items );
+			for ( int32_t Index = 0; Index < ItemsNum; Index++ )
+			{
+				const NameType& Name = TraitsType::GetName( Items[ Index ] );
+				if ( NameRanks.emplace( Name, 0u ).second )
+				{
+					AddElement( Names, Name );
+				}
+			}
+
+			SortArray( Names, [](const NameType& Left, const NameType& Right)
+			{
+				return TraitsType::CompareNames( Left, Right ) < 0;
+			} );
+
+			uint32_t Rank = 0;
+			const NameType* NamesData = GetData( Names );
+			for ( int32_t Index = 0; Index < GetNum( Names ); Index++ )
+			{
+				if ( 0 < Index && TraitsType::CompareNames( NamesData[ Index - 1 ], NamesData[ Index ] ) != 0 )
+				{
+					Rank++;
+				}
+				NameRanks[ NamesData[ Index ] ] = Rank;
+			}
+		}
+
+		// Moves every item to its place in the sorted order, once
+		static void ApplySortedKeys(ItemContainerType& Items, const KeyContainerType& Keys)
+		{
+			ItemContainerType SortedItems;
+			ReserveContainer( SortedItems, GetNum( Keys ) );
+			const FSortKey* KeysData = GetData( Keys );
+			for ( int32_t Position = 0; Position < GetNum( Keys ); Position++ )
+			{
+				AddElement( SortedItems, std::move( Items[ KeysData[ Position ].Index ] ) );
+			}
+			Items = std::move( SortedItems );
+		}
+
+		static void GetKeyIndices(const KeyContainerType& Keys, IndexContainerType& OutIndices)
+		{
+			ReserveContainer( OutIndices, GetNum( OutIndices ) + GetNum( Keys ) );
+			const FSortKey* KeysData = GetData( Keys );
+			for ( int32_t Position = 0; Position < GetNum( Keys ); Position++ )
+			{
+				AddElement( OutIndices, KeysData[ Position ].Index );
+			}
+		}
+
+		using FSortedViewType = TSortedView<TContainer<FSortedViewNode>>;
+
+		FSortedViewType NameView;
+		FSortedViewType ValueView;
+		bool bSortedViewsBuilt = false;
+
+		FSortStats LastSortStats;
+
+		mutable std::unordered_map<NameType, uint32_t, typename TraitsType::FNameHash, typename TraitsType::FNameEqual> NameRanks;
+	};
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "ContainerTraits.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace InventorySortingCore
+{
+	/**
+	 * Compact inventory file, version 1. All numbers are little-endian and every section starts 4-byte aligned.
+	 *
+	 *   header    "INVC", version
+	 *   blocks    items count, new names count, name index size in bytes (2 or 4)
+	 *             the names first used in this block: byte length and UTF-8 bytes each, then padding
+	 *             name index of every item (into all names so far), then padding
+	 *             value of every item
+	 *   end       0, items count, names count
+	 *
+	 * Every distinct name is stored once and items only store its index, so an inventory full of duplicate
+	 * names costs 6 or 8 bytes per item. Blocks let the writer stream items out with bounded memory, and
+	 * the reader hands out names as views into the file, so a memory mapped file is read in place.
+	 *
+	 * Besides what TInventoryCore needs, the writer and ReadInventoryFile need from TraitsType:
+	 *   AppendNameUtf8( Name, std::string& Out ), MakeName( std::string_view Utf8Name ), MakeItem( Name, Value )
+	 *   FExactNameHash, FExactNameEqual            hash and equality of names as spelled, for the name table:
+	 *                                              names that only sort as equal are stored apart
+	 */
+	constexpr uint32_t InventoryFileMagic = 'I' | 'N' << 8 | 'V' << 16 | 'C' << 24;
+	constexpr uint32_t InventoryFileVersion = 1;
+
+	// Items per block: large enough that block headers do not matter, small enough to stay in cache
+	constexpr int32_t InventoryFileBlockItemsNum = 16384;
+
+	namespace InventoryFile
+	{
+		inline void AppendUInt32(std::string& Out, uint32_t Value)
+		{
+			const char Bytes[ 4 ] = { static_cast<char>( Value ), static_cast<char>( Value >> 8 ), static_cast<char>( Value >> 16 ), static_cast<char>( Value >> 24 ) };
+			Out.append( Bytes, 4 );
+		}
+
+		inline void AppendUInt16(std::string& Out, uint16_t Value)
+		{
+			const char Bytes[ 2 ] = { static_cast<char>( Value ), static_cast<char>( Value >> 8 ) };
+			Out.append( Bytes, 2 );
+		}
+
+		inline void AppendPadding(std::string& Out)
+		{
+			Out.append( ( 4 - Out.size() % 4 ) % 4, '\0' );
+		}
+
+		inline uint32_t LoadUInt32(const uint8_t* Data)
+		{
+			return static_cast<uint32_t>( Data[ 0 ] ) | static_cast<uint32_t>( Data[ 1 ] ) << 8 | static_cast<uint32_t>( Data[ 2 ] ) << 16 | static_cast<uint32_t>( Data[ 3 ] ) << 24;
+		}
+
+		inline uint16_t LoadUInt16(const uint8_t* Data)
+		{
+			return static_cast<uint16_t>( Data[ 0 ] | Data[ 1 ] << 8 );
+		}
+
+		inline size_t AlignUp(size_t Offset)
+		{
+			return ( Offset + 3 ) & ~static_cast<size_t>( 3 );
+		}
+	}
+
+	/**
+	 * Writes the file as items come in, one block at a time. SinkType has bool Write( const void* Data, size_t Size ).
+	 * Names are converted to UTF-8 once per distinct name
+	 */
+	template <typename TraitsType, typename SinkType>
+	class TInventoryFileWriter
+	{
+	public:
+		using ItemType = typename TraitsType::ItemType;
+		using NameType = typename TraitsType::NameType;
+
+		explicit TInventoryFileWriter(SinkType& InSink)
+			: Sink( InSink )
+		{
+			BlockNameIndices.reserve( InventoryFileBlockItemsNum );
+			BlockValues.reserve( InventoryFileBlockItemsNum );
+
+			std::string Header;
+			InventoryFile::AppendUInt32( Header, InventoryFileMagic );
+			InventoryFile::AppendUInt32( Header, InventoryFileVersion );
+			Write( Header );
+		}
+
+		void Add(const ItemType& Item)
+		{
+			const NameType& Name = TraitsType::GetName( Item );
+			auto Found = NameIndices.find( Name );
+			if ( Found == NameIndices.end() )
+			{
+				Found = NameIndices.emplace( Name, static_cast<uint32_t>( NameIndices.size() ) ).first;
+
+				// The length goes in front of the bytes, which are only known after the conversion
+				const size_t LengthOffset = NewNames.size();
+				InventoryFile::AppendUInt32( NewNames, 0 );
+				TraitsType::AppendNameUtf8( Name, NewNames );
+				const uint32_t Length = static_cast<uint32_t>( NewNames.size() - LengthOffset - 4 );
+				for ( int32_t Byte = 0; Byte < 4; Byte++ )
+				{
+					NewNames[ LengthOffset + Byte ] = static_cast<char>( Length >> ( Byte * 8 ) );
+				}
+				NewNamesNum++;
+			}
+
+			BlockNameIndices.push_back( Found->second );
+			BlockValues.push_back( TraitsType::GetValue( Item ) );
+			if ( static_cast<int32_t>( BlockValues.size() ) == InventoryFileBlockItemsNum )
+			{
+				FlushBlock();
+			}
+		}
+
+		template <typename ContainerType>
+		void AddItems(const ContainerType& Items)
+		{
+			const auto* ItemsData = GetData( Items );
+			for ( int32_t Index = 0; Index < GetNum( Items ); Index++ )
+			{
+				Add( ItemsData[ Index ] );
+			}
+		}
+
+		// Writes what is left and the end of the file. False if the sink failed at any point
+		bool Finish()
+		{
+			FlushBlock();
+
+			std::string End;
+			InventoryFile::AppendUInt32( End, 0 );
+			InventoryFile::AppendUInt32( End, static_cast<uint32_t>( ItemsNum ) );
+			InventoryFile::AppendUInt32( End, static_cast<uint32_t>( NameIndices.size() ) );
+			Write( End );
+			return bSinkOk;
+		}
+
+	private:
+		void FlushBlock()
+		{
+			if ( BlockValues.empty() )
+			{
+				return;
+			}
+
+			// Two bytes per index while there are few enough names, which is the usual case
+			const uint32_t NameIndexBytes = NameIndices.size() <= 0x10000 ? 2 : 4;
+
+			Block.clear();
+			InventoryFile::AppendUInt32( Block, static_cast<uint32_t>( BlockValues.size() ) );
+			InventoryFile::AppendUInt32( Block, NewNamesNum );
+			InventoryFile::AppendUInt32( Block, NameIndexBytes );
+			Block += NewNames;
+			InventoryFile::AppendPadding( Block );
+
+			for ( uint32_t NameIndex : BlockNameIndices )
+			{
+				if ( NameIndexBytes == 2 )
+				{
+					InventoryFile::AppendUInt16( Block, static_cast<uint16_t>( NameIndex ) );
+				}
+				else
+				{
+					InventoryFile::AppendUInt32( Block, NameIndex );
+				}
+			}
+			InventoryFile::AppendPadding( Block );
+
+			for ( int32_t Value : BlockValues )
+			{
+				InventoryFile::AppendUInt32( Block, static_cast<uint32_t>( Value ) );
+			}
+			Write( Block );
+
+			ItemsNum += BlockValues.size();
+			BlockNameIndices.clear();
+			BlockValues.clear();
+			NewNames.clear();
+			NewNamesNum = 0;
+		}
+
+		void Write(const std::string& Bytes)
+		{
+			bSinkOk = bSinkOk && Sink.Write( Bytes.data(), Bytes.size() );
+		}
+
+		SinkType& Sink;
+		bool bSinkOk = true;
+		size_t ItemsNum = 0;
+
+		std::unordered_map<NameType, uint32_t, typename TraitsType::FExactNameHash, typename TraitsType::FExactNameEqual> NameIndices;
+
+		// Everything of the block being filled; sizes are multiples of 4 up to where padding is added
+		std::string NewNames;
+		uint32_t NewNamesNum = 0;
+		std::vector<uint32_t> BlockNameIndices;
+		std::vector<int32_t> BlockValues;
+		std::string Block;
+	};
+
+	/**
+	 * Reads a whole file from memory without copying it: OnName( std::string_view Utf8Name ) is called once
+	 * per distinct name, in index order, with a view into Data; OnItem( uint32_t NameIndex, int32_t Value )
+	 * once per item. False if Data is not a complete file of a known version, which can happen after some
+	 * calls were already made
+	 */
+	template <typename NameVisitorType, typename ItemVisitorType>
+	bool VisitInventoryFile(const uint8_t* Data, size_t Size, NameVisitorType&& OnName, ItemVisitorType&& OnItem)
+	{
+		using InventoryFile::AlignUp;
+		using InventoryFile::LoadUInt32;
+
+		if ( Size < 8 || LoadUInt32( Data ) != InventoryFileMagic || LoadUInt32( Data + 4 ) != InventoryFileVersion )
+		{
+			return false;
+		}
+
+		size_t Offset = 8;
+		uint64_t NamesNum = 0;
+		uint64_t ItemsNum = 0;
+		while ( Offset + 12 <= Size )
+		{
+			const uint32_t BlockItemsNum = LoadUInt32( Data + Offset );
+			if ( BlockItemsNum == 0 )
+			{
+				return Offset + 12 == Size && LoadUInt32( Data + Offset + 4 ) == ItemsNum && LoadUInt32( Data + Offset + 8 ) == NamesNum;
+			}
+
+			const uint32_t NewNamesNum = LoadUInt32( Data + Offset + 4 );
+			const uint32_t NameIndexBytes = LoadUInt32( Data + Offset + 8 );
+			if ( NameIndexBytes != 2 && NameIndexBytes != 4 )
+			{
+				return false;
+			}
+			Offset += 12;
+
+			for ( uint32_t Name = 0; Name < NewNamesNum; Name++ )
+			{
+				if ( Size < Offset + 4 || Size - Offset - 4 < LoadUInt32( Data + Offset ) )
+				{
+					return false;
+				}
+				const uint32_t Length = LoadUInt32( Data + Offset );
+				OnName( std::string_view( reinterpret_cast<const char*>( Data + Offset + 4 ), Length ) );
+				Offset += 4 + Length;
+			}
+			NamesNum += NewNamesNum;
+			Offset = AlignUp( Offset );
+
+			const size_t NameIndicesOffset = Offset;
+			const size_t ValuesOffset = AlignUp( NameIndicesOffset + static_cast<size_t>( BlockItemsNum ) * NameIndexBytes );
+			const size_t BlockEnd = ValuesOffset + static_cast<size_t>( BlockItemsNum ) * 4;
+			if ( Size < BlockEnd )
+			{
+				return false;
+			}
+
+			for ( uint32_t Item = 0; Item < BlockItemsNum; Item++ )
+			{
+				const uint8_t* NameIndexData = Data + NameIndicesOffset + static_cast<size_t>( Item ) * NameIndexBytes;
+				const uint32_t NameIndex = NameIndexBytes == 2 ? InventoryFile::LoadUInt16( NameIndexData ) : LoadUInt32( NameIndexData );
+				if ( NamesNum <= NameIndex )
+				{
+					return false;
+				}
+				OnItem( NameIndex, static_cast<int32_t>( LoadUInt32( Data + ValuesOffset + static_cast<size_t>( Item ) * 4 ) ) );
+			}
+
+			ItemsNum += BlockItemsNum;
+			Offset = BlockEnd;
+		}
+		return false;
+	}
+
+	// Appends the items of a file in memory to OutItems, making one NameType per distinct name
+	template <typename TraitsType, typename ContainerType>
+	bool ReadInventoryFile(const uint8_t* Data, size_t Size, ContainerType& OutItems)
+	{
+		typename TraitsType::template TContainer<typename TraitsType::NameType> Names;
+		return VisitInventoryFile( Data, Size,
+			[&Names](std::string_view Utf8Name)
+			{
+				AddElement( Names, TraitsType::MakeName( Utf8Name ) );
+			},
+			[&Names, &OutItems](uint32_t NameIndex, int32_t Value)
+			{
+				AddElement( OutItems, TraitsType::MakeItem( GetData( Names )[ NameIndex ], Value ) );
+			} );
+	}
+
+	// Sink collecting the file in memory
+	struct FStringSink
+	{
+		std::string Bytes;
+
+		bool Write(const void* Data, size_t Size)
+		{
+			Bytes.append( static_cast<const char*>( Data ), Size );
+			return true;
+		}
+	};
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ContainerTraits.h"
+
+namespace InventorySortingCore
+{
+	// Parts up to this size are sorted by insertion, which beats splitting and merging on small inputs
+	constexpr int32_t InsertionSortThreshold = 16;
+
+	template <typename T, typename F>
+	void InsertionSortArrayPart(T* Array, int32_t LeftBorder, int32_t RightBorder, F& Comparator)
+	{
+		for ( int32_t Index = LeftBorder + 1; Index <= RightBorder; Index++ )
+		{
+			// Equal items are never moved past each other, which keeps the sort stable
+			if ( !Comparator( Array[ Index ], Array[ Index - 1 ] ) )
+			{
+				continue;
+			}
+
+			T CurrentItem = std::move( Array[ Index ] );
+			int32_t InsertIndex = Index;
+			do
+			{
+				Array[ InsertIndex ] = std::move( Array[ InsertIndex - 1 ] );
+				InsertIndex--;
+			}
+			while ( LeftBorder < InsertIndex && Comparator( CurrentItem, Array[ InsertIndex - 1 ] ) );
+
+			Array[ InsertIndex ] = std::move( CurrentItem );
+		}
+	}
+
+	template <typename T, typename F>
+	void MergeTwoSortedArrayParts(T* Array, int32_t LeftBorder, int32_t MidBorder, int32_t RightBorder, F& Comparator, T* Scratch)
+	{
+		// Only the left part has to leave the array, the right part is merged in place from behind it
+		int32_t LeftPartNum = MidBorder - LeftBorder + 1;
+		for ( int32_t Index = 0; Index < LeftPartNum; Index++ )
+		{
+			Scratch[ Index ] = std::move( Array[ LeftBorder + Index ] );
+		}
+
+		// Merging the left and right parts using provided comparator.
+		// The right item is only taken when it is strictly smaller, so equal items keep their order
+
+		int32_t CurrentLeftItemIndex = 0;
+		int32_t CurrentRightItemIndex = MidBorder + 1;
+
+		int32_t CurrentMainItemIndex = LeftBorder;
+
+		while ( CurrentLeftItemIndex < LeftPartNum && CurrentRightItemIndex <= RightBorder )
+		{
+			if ( Comparator( Array[ CurrentRightItemIndex ], Scratch[ CurrentLeftItemIndex ] ) )
+			{
+				Array[ CurrentMainItemIndex++ ] = std::move( Array[ CurrentRightItemIndex++ ] );
+			}
+			else
+			{
+				Array[ CurrentMainItemIndex++ ] = std::move( Scratch[ CurrentLeftItemIndex++ ] );
+			}
+		}
+
+		// Moving the remaining items of the left part, the remaining right items are already in place
+
+		while ( CurrentLeftItemIndex < LeftPartNum )
+		{
+			Array[ CurrentMainItemIndex++ ] = std::move( Scratch[ CurrentLeftItemIndex++ ] );
+		}
+	}
+
+	// Sorts Array[ LeftBorder .. RightBorder ]. Scratch has to hold at least half of that, rounded up
+	template <typename T, typename F>
+	void SortArrayPart(T* Array, int32_t LeftBorder, int32_t RightBorder, F& Comparator, T* Scratch)
+	{
+		// Small parts (including single items, which are already sorted) go to insertion sort
+		if ( RightBorder - LeftBorder < InsertionSortThreshold )
+		{
+			InsertionSortArrayPart( Array, LeftBorder, RightBorder, Comparator );
+			return;
+		}
+
+		// Dividing the array into two parts and sorting them separately
+		int32_t MidBorder = LeftBorder + ( RightBorder - LeftBorder ) / 2;
+		SortArrayPart( Array, LeftBorder, MidBorder, Comparator, Scratch );
+		SortArrayPart( Array, MidBorder + 1, RightBorder, Comparator, Scratch );
+
+		// If the last item of the left part does not come after the first item of the right part, both parts are already in order
+		if ( !Comparator( Array[ MidBorder + 1 ], Array[ MidBorder ] ) )
+		{
+			return;
+		}
+
+		// Merging two sorted parts
+		MergeTwoSortedArrayParts( Array, LeftBorder, MidBorder, RightBorder, Comparator, Scratch );
+	}
+
+	// Stable merge sort of the whole container. The scratch buffer is allocated once per sort and
+	// holds at most the left half of a merge, items are moved in and out of it instead of copied
+	template <typename ContainerType, typename F>
+	void SortArray(ContainerType& Array, F Comparator)
+	{
+		const int32_t ArrayNum = GetNum( Array );
+		if ( ArrayNum < 2 )
+		{
+			return;
+		}
+
+		ContainerType Scratch;
+		SetNum( Scratch, ( ArrayNum + 1 ) / 2 );
+		SortArrayPart( GetData( Array ), 0, ArrayNum - 1, Comparator, GetData( Scratch ) );
+	}
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "MergeSort.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace InventorySortingCore
+{
+	// Runs shorter than this are extended by insertion sort, so random stretches do not turn into many tiny merges
+	constexpr int32_t NaturalMergeMinRun = 32;
+
+	// When one run is this many times longer than the other, the items of the short run are placed by binary
+	// search and the long run is moved in blocks between them, like TimSort's galloping, instead of comparing
+	// every item of the long run
+	constexpr int32_t NaturalMergeSearchRatio = 8;
+
+	// Length of the run that starts at Begin. A strictly descending run is reversed in place; strictly,
+	// so equal items never trade places and the sort stays stable
+	template <typename T, typename F>
+	int32_t FindRunAndMakeAscending(T* Array, int32_t Begin, int32_t End, F& Comparator)
+	{
+		int32_t RunEnd = Begin + 1;
+		if ( RunEnd == End )
+		{
+			return 1;
+		}
+
+		if ( Comparator( Array[ RunEnd ], Array[ Begin ] ) )
+		{
+			while ( RunEnd + 1 < End && Comparator( Array[ RunEnd + 1 ], Array[ RunEnd ] ) )
+			{
+				RunEnd++;
+			}
+			std::reverse( Array + Begin, Array + RunEnd + 1 );
+		}
+		else
+		{
+			while ( RunEnd + 1 < End && !Comparator( Array[ RunEnd + 1 ], Array[ RunEnd ] ) )
+			{
+				RunEnd++;
+			}
+		}
+		return RunEnd + 1 - Begin;
+	}
+
+	// Number of runs the natural merge sort would find, without changing anything. Stops counting
+	// past MaxRunsNum, so telling random items from nearly sorted ones is cheap
+	template <typename T, typename F>
+	int32_t CountRuns(const T* Array, int32_t Num, F& Comparator, int32_t MaxRunsNum)
+	{
+		int32_t RunsNum = 0;
+		for ( int32_t Begin = 0; Begin < Num && RunsNum <= MaxRunsNum; RunsNum++ )
+		{
+			int32_t RunEnd = Begin + 1;
+			if ( RunEnd < Num && Comparator( Array[ RunEnd ], Array[ Begin ] ) )
+			{
+				while ( RunEnd + 1 < Num && Comparator( Array[ RunEnd + 1 ], Array[ RunEnd ] ) )
+				{
+					RunEnd++;
+				}
+			}
+			else
+			{
+				while ( RunEnd + 1 < Num && !Comparator( Array[ RunEnd + 1 ], Array[ RunEnd ] ) )
+				{
+					RunEnd++;
+				}
+			}
+			Begin = RunEnd + 1;
+		}
+		return RunsNum;
+	}
+
+	// Merges the sorted runs Array[ Begin .. Mid - 1 ] and Array[ Mid .. End - 1 ]. Items already in their
+	// place at either end are found by binary search and left alone, and only the smaller of the remaining
+	// parts goes to the scratch buffer, so adding a few items to a long sorted run costs little
+	template <typename ContainerType, typename F>
+	void MergeAdjacentRuns(ContainerType& Array, int32_t Begin, int32_t Mid, int32_t End, F& Comparator, ContainerType& Scratch)
+	{
+		auto* Data = GetData( Array );
+
+		// Left items that do not come after the first right item, and right items that do not come before
+		// the last left item, are already in place
+		Begin = static_cast<int32_t>( std::upper_bound( Data + Begin, Data + Mid, Data[ Mid ], std::ref( Comparator ) ) - Data );
+		if ( Begin == Mid )
+		{
+			return;
+		}
+		End = static_cast<int32_t>( std::lower_bound( Data + Mid, Data + End, Data[ Mid - 1 ], std::ref( Comparator ) ) - Data );
+
+		const int32_t LeftNum = Mid - Begin;
+		const int32_t RightNum = End - Mid;
+		if ( GetNum( Scratch ) < std::min( LeftNum, RightNum ) )
+		{
+			SetNum( Scratch, std::min( LeftNum, RightNum ) );
+		}
+		auto* ScratchData = GetData( Scratch );
+
+		if ( LeftNum <= RightNum )
+		{
+			if ( LeftNum * NaturalMergeSearchRatio < RightNum )
+			{
+				for ( int32_t Index = 0; Index < LeftNum; Index++ )
+				{
+					ScratchData[ Index ] = std::move( Data[ Begin + Index ] );
+				}
+
+				// Right items strictly before each left item go first, so equal items keep their order
+				auto* Out = Data + Begin;
+				auto* Right = Data + Mid;
+				for ( int32_t Index = 0; Index < LeftNum; Index++ )
+				{
+					auto* RightEnd = std::lower_bound( Right, Data + End, ScratchData[ Index ], std::ref( Comparator ) );
+					Out = std::move( Right, RightEnd, Out );
+					Right = RightEnd;
+					*Out++ = std::move( ScratchData[ Index ] );
+				}
+				return;
+			}
+
+			MergeTwoSortedArrayParts( Data, Begin, Mid - 1, End - 1, Comparator, ScratchData );
+			return;
+		}
+
+		// The right part is the smaller one: it leaves the array and the merge runs from the back
+		for ( int32_t Index = 0; Index < RightNum; Index++ )
+		{
+			ScratchData[ Index ] = std::move( Data[ Mid + Index ] );
+		}
+
+		if ( RightNum * NaturalMergeSearchRatio < LeftNum )
+		{
+			// Left items not after each right item stay before it, so equal items keep their order
+			auto* Out = Data + End;
+			auto* LeftEnd = Data + Mid;
+			for ( int32_t Index = RightNum - 1; 0 <= Index; Index-- )
+			{
+				auto* LeftBegin = std::upper_bound( Data + Begin, LeftEnd, ScratchData[ Index ], std::ref( Comparator ) );
+				Out = std::move_backward( LeftBegin, LeftEnd, Out );
+				LeftEnd = LeftBegin;
+				*--Out = std::move( ScratchData[ Index ] );
+			}
+			return;
+		}
+
+		int32_t CurrentLeftItemIndex = Mid - 1;
+		int32_t CurrentRightItemIndex = RightNum - 1;
+		int32_t CurrentMainItemIndex = End - 1;
+		while ( Begin <= CurrentLeftItemIndex && 0 <= CurrentRightItemIndex )
+		{
+			// Going backwards the left item is only taken when the right one is strictly smaller, so equal items keep their order
+			if ( Comparator( ScratchData[ CurrentRightItemIndex ], Data[ CurrentLeftItemIndex ] ) )
+			{
+				Data[ CurrentMainItemIndex-- ] = std::move( Data[ CurrentLeftItemIndex-- ] );
+			}
+			else
+			{
+				Data[ CurrentMainItemIndex-- ] = std::move( ScratchData[ CurrentRightItemIndex-- ] );
+			}
+		}
+
+		// The remaining left items are already in place
+		while ( 0 <= CurrentRightItemIndex )
+		{
+			Data[ CurrentMainItemIndex-- ] = std::move( ScratchData[ CurrentRightItemIndex-- ] );
+		}
+	}
+
+	struct FRun
+	{
+		int32_t Begin;
+		int32_t Num;
+	};
+
+	// Merges the run at Run on the stack with the one above it
+	template <typename ContainerType, typename F>
+	void MergeRunsAt(ContainerType& Array, std::vector<FRun>& Runs, size_t Run, F& Comparator, ContainerType& Scratch)
+	{
+		FRun& Left = Runs[ Run ];
+		const FRun& Right = Runs[ Run + 1 ];
+		MergeAdjacentRuns( Array, Left.Begin, Right.Begin, Right.Begin + Right.Num, Comparator, Scratch );
+		Left.Num += Right.Num;
+		Runs.erase( Runs.begin() + Run + 1 );
+	}
+
+	// Stable merge sort over the runs already in the array, in the style of TimSort: sorted items cost one
+	// pass of comparisons, a sorted array with a few items added costs little more, random items cost about
+	// as much as the plain merge sort
+	template <typename ContainerType, typename F>
+	void NaturalMergeSortArray(ContainerType& Array, F Comparator)
+	{
+		const int32_t ArrayNum = GetNum( Array );
+		if ( ArrayNum < 2 )
+		{
+			return;
+		}
+
+		ContainerType Scratch;
+		std::vector<FRun> Runs;
+		for ( int32_t Begin = 0; Begin < ArrayNum; )
+		{
+			int32_t RunNum = FindRunAndMakeAscending( GetData( Array ), Begin, ArrayNum, Comparator );
+			if ( RunNum < NaturalMergeMinRun )
+			{
+				// Insertion sort passes over the part already in order without moving anything
+				RunNum = std::min( NaturalMergeMinRun, ArrayNum - Begin );
+				InsertionSortArrayPart( GetData( Array ), Begin, Begin + RunNum - 1, Comparator );
+			}
+			Runs.push_back( { Begin, RunNum } );
+			Begin += RunNum;
+
+			// TimSort's invariants: every run on the stack is longer than the two above it together. Runs of
+			// similar length are merged, and a long run is only merged once, instead of once per pass
+			while ( 1 < Runs.size() )
+			{
+				size_t Run = Runs.size() - 2;
+				if ( ( 0 < Run && Runs[ Run - 1 ].Num <= Runs[ Run ].Num + Runs[ Run + 1 ].Num )
+					|| ( 1 < Run && Runs[ Run - 2 ].Num <= Runs[ Run - 1 ].Num + Runs[ Run ].Num ) )
+				{
+					if ( Runs[ Run - 1 ].Num < Runs[ Run + 1 ].Num )
+					{
+						Run--;
+					}
+				}
+				else if ( Runs[ Run + 1 ].Num < Runs[ Run ].Num )
+				{
+					break;
+				}
+				MergeRunsAt( Array, Runs, Run, Comparator, Scratch );
+			}
+		}
+
+		while ( 1 < Runs.size() )
+		{
+			size_t Run = Runs.size() - 2;
+			if ( 0 < Run && Runs[ Run - 1 ].Num < Runs[ Run + 1 ].Num )
+			{
+				Run--;
+			}
+			MergeRunsAt( Array, Runs, Run, Comparator, Scratch );
+		}
+	}
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "MergeSort.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace InventorySortingCore
+{
+	// Smallest part a task sorts or merges on its own; below this the cost of a task outweighs the work
+	constexpr int32_t ParallelSortChunkMin = 16384;
+
+	// Runs Body( 0 ) .. Body( Num - 1 ) on one std::thread each, the last one on the calling thread.
+	// The executor of standalone builds; an engine passes its own task system instead
+	struct FStdParallelFor
+	{
+		template <typename F>
+		void operator()(int32_t Num, F&& Body) const
+		{
+			std::vector<std::thread> Threads;
+			Threads.reserve( Num > 0 ? Num - 1 : 0 );
+			for ( int32_t Index = 0; Index + 1 < Num; Index++ )
+			{
+				Threads.emplace_back( [&Body, Index]() { Body( Index ); } );
+			}
+			if ( 0 < Num )
+			{
+				Body( Num - 1 );
+			}
+			for ( std::thread& Thread : Threads )
+			{
+				Thread.join();
+			}
+		}
+	};
+
+	inline int32_t GetStdTasksNum()
+	{
+		return std::max( 1, static_cast<int32_t>( std::thread::hardware_concurrency() ) );
+	}
+
+	// Number of left run items among the first OutputIndex items of the stable merge of both runs,
+	// found by binary search so every piece of a merge can start without merging what comes before it
+	template <typename T, typename F>
+	int32_t FindMergeSplit(const T* LeftRun, int32_t LeftRunNum, const T* RightRun, int32_t RightRunNum, int32_t OutputIndex, F& Comparator)
+	{
+		int32_t Low = std::max( 0, OutputIndex - RightRunNum );
+		int32_t High = std::min( OutputIndex, LeftRunNum );
+		while ( Low < High )
+		{
+			// Taking LeftRun[ Middle ] too is right if it does not come after the right item it would displace
+			const int32_t Middle = Low + ( High - Low ) / 2;
+			if ( !Comparator( RightRun[ OutputIndex - Middle - 1 ], LeftRun[ Middle ] ) )
+			{
+				Low = Middle + 1;
+			}
+			else
+			{
+				High = Middle;
+			}
+		}
+		return Low;
+	}
+
+	// Stable parallel merge sort, bottom-up: a power-of-two number of chunks is sorted with the serial
+	// merge sort, one task each, then pairs of sorted runs are merged round after round. Every round is
+	// cut into as many output pieces as there are chunks, so the last merge is as parallel as the first.
+	// ParallelFor( Num, Body ) has to run Body( 0 ) .. Body( Num - 1 ) and return once all are done
+	template <typename ContainerType, typename F, typename ParallelForType>
+	void ParallelSortArray(ContainerType& Array, F Comparator, int32_t TasksNum, ParallelForType&& ParallelFor)
+	{
+		using T = std::remove_reference_t<decltype( *GetData( Array ) )>;
+
+		const int32_t ArrayNum = GetNum( Array );
+
+		int32_t ChunksNum = 1;
+		while ( ChunksNum < TasksNum && ParallelSortChunkMin <= ArrayNum / ( ChunksNum * 2 ) )
+		{
+			ChunksNum *= 2;
+		}
+
+		if ( ChunksNum == 1 )
+		{
+			SortArray( Array, Comparator );
+			return;
+		}
+
+		auto GetChunkBegin = [ArrayNum, ChunksNum](int32_t Chunk)
+		{
+			return static_cast<int32_t>( static_cast<int64_t>( ArrayNum ) * Chunk / ChunksNum );
+		};
+
+		ParallelFor( ChunksNum, [&Array, &Comparator, &GetChunkBegin](int32_t Chunk)
+		{
+			const int32_t LeftBorder = GetChunkBegin( Chunk );
+			const int32_t RightBorder = GetChunkBegin( Chunk + 1 ) - 1;
+
+			ContainerType Scratch;
+			SetNum( Scratch, ( RightBorder - LeftBorder + 2 ) / 2 );
+			SortArrayPart( GetData( Array ), LeftBorder, RightBorder, Comparator, GetData( Scratch ) );
+		} );
+
+		// Runs are merged from one array into the other, so every merge has somewhere to write without
+		// moving its inputs out of the way first
+		ContainerType Buffer;
+		SetNum( Buffer, ArrayNum );
+		T* Source = GetData( Array );
+		T* Destination = GetData( Buffer );
+
+		// Where each piece starts in the left run of its pair. Found for the whole round before any item
+		// is moved, since the searches of one piece read items the piece before it moves
+		std::vector<int32_t> PieceLeftBegins( ChunksNum );
+
+		for ( int32_t RunChunksNum = 1; RunChunksNum < ChunksNum; RunChunksNum *= 2 )
+		{
+			const int32_t PiecesPerPair = RunChunksNum * 2;
+
+			// The pair of runs a piece belongs to and which slice of their merged output it writes
+			auto GetPieceOutputBegin = [&GetChunkBegin, PiecesPerPair](int32_t Piece)
+			{
+				const int32_t PairChunk = Piece / PiecesPerPair * PiecesPerPair;
+				const int32_t PairNum = GetChunkBegin( PairChunk + PiecesPerPair ) - GetChunkBegin( PairChunk );
+				return static_cast<int32_t>( static_cast<int64_t>( PairNum ) * ( Piece - PairChunk ) / PiecesPerPair );
+			};
+
+			ParallelFor( ChunksNum, [Source, &Comparator, &GetChunkBegin, &GetPieceOutputBegin, &PieceLeftBegins, RunChunksNum, PiecesPerPair](int32_t Piece)
+			{
+				const int32_t PairChunk = Piece / PiecesPerPair * PiecesPerPair;
+				const int32_t PairBegin = GetChunkBegin( PairChunk );
+				const int32_t PairMid = GetChunkBegin( PairChunk + RunChunksNum );
+				const int32_t PairEnd = GetChunkBegin( PairChunk + PiecesPerPair );
+
+				PieceLeftBegins[ Piece ] = FindMergeSplit( Source + PairBegin, PairMid - PairBegin, Source + PairMid, PairEnd - PairMid,
+				                                           GetPieceOutputBegin( Piece ), Comparator );
+			} );
+
+			ParallelFor( ChunksNum, [Source, Destination, &Comparator, &GetChunkBegin, &GetPieceOutputBegin, &PieceLeftBegins, RunChunksNum, PiecesPerPair](int32_t Piece)
+			{
+				const int32_t PairChunk = Piece / PiecesPerPair * PiecesPerPair;
+				const int32_t PairBegin = GetChunkBegin( PairChunk );
+				const int32_t PairMid = GetChunkBegin( PairChunk + RunChunksNum );
+				const int32_t PairEnd = GetChunkBegin( PairChunk + PiecesPerPair );
+
+				// The last piece of a pair ends with both runs
+				const bool bLastPieceInPair = Piece + 1 == PairChunk + PiecesPerPair;
+				const int32_t OutputBegin = GetPieceOutputBegin( Piece );
+				const int32_t OutputEnd = bLastPieceInPair ? PairEnd - PairBegin : GetPieceOutputBegin( Piece + 1 );
+
+				T* LeftRun = Source + PairBegin;
+				T* RightRun = Source + PairMid;
+
+				int32_t LeftIndex = PieceLeftBegins[ Piece ];
+				int32_t RightIndex = OutputBegin - LeftIndex;
+				const int32_t LeftEnd = bLastPieceInPair ? PairMid - PairBegin : PieceLeftBegins[ Piece + 1 ];
+				const int32_t RightEnd = OutputEnd - LeftEnd;
+
+				T* Output = Destination + PairBegin;
+				for ( int32_t OutputIndex = OutputBegin; OutputIndex < OutputEnd; OutputIndex++ )
+				{
+					// Same tie rule as the serial merge: the right item only goes first when strictly smaller
+					if ( RightIndex < RightEnd && ( LeftIndex == LeftEnd || Comparator( RightRun[ RightIndex ], LeftRun[ LeftIndex ] ) ) )
+					{
+						Output[ OutputIndex ] = std::move( RightRun[ RightIndex++ ] );
+					}
+					else
+					{
+						Output[ OutputIndex ] = std::move( LeftRun[ LeftIndex++ ] );
+					}
+				}
+			} );
+
+			std::swap( Source, Destination );
+		}
+
+		if ( Source != GetData( Array ) )
+		{
+			Array = std::move( Buffer );
+		}
+	}
+}
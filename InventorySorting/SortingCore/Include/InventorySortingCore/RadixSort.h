@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ContainerTraits.h"
+
+namespace InventorySortingCore
+{
+	// Sort key of one item and the index of that item. Value keys are the int32 value with the sign bit
+	// flipped, so they sort as unsigned integers in the same order; name keys are collation ranks
+	struct FSortKey
+	{
+		uint32_t Key;
+		int32_t Index;
+	};
+
+	inline uint32_t MakeValueSortKey(int32_t Value)
+	{
+		return static_cast<uint32_t>( Value ) ^ 0x80000000u;
+	}
+
+	// Stable LSD radix sort of FSortKey, one byte per pass; passes where every key has the same byte are skipped
+	template <typename ContainerType>
+	void RadixSortKeys(ContainerType& Keys)
+	{
+		const int32_t KeysNum = GetNum( Keys );
+		if ( KeysNum < 2 )
+		{
+			return;
+		}
+
+		constexpr int32_t BucketsNum = 256;
+		constexpr int32_t PassesNum = 4;
+
+		// All four histograms in one read of the keys
+		int32_t Counts[ PassesNum ][ BucketsNum ] = {};
+		const FSortKey* KeysData = GetData( Keys );
+		for ( int32_t Index = 0; Index < KeysNum; Index++ )
+		{
+			for ( int32_t Pass = 0; Pass < PassesNum; Pass++ )
+			{
+				Counts[ Pass ][ ( KeysData[ Index ].Key >> ( Pass * 8 ) ) & 0xFF ]++;
+			}
+		}
+
+		ContainerType Scratch;
+		SetNum( Scratch, KeysNum );
+
+		FSortKey* Source = GetData( Keys );
+		FSortKey* Destination = GetData( Scratch );
+
+		for ( int32_t Pass = 0; Pass < PassesNum; Pass++ )
+		{
+			const int32_t Shift = Pass * 8;
+
+			// Small values leave the high bytes equal, a pass over them would only copy the keys
+			if ( Counts[ Pass ][ ( Source[ 0 ].Key >> Shift ) & 0xFF ] == KeysNum )
+			{
+				continue;
+			}
+
+			int32_t Offsets[ BucketsNum ];
+			int32_t Offset = 0;
+			for ( int32_t Bucket = 0; Bucket < BucketsNum; Bucket++ )
+			{
+				Offsets[ Bucket ] = Offset;
+				Offset += Counts[ Pass ][ Bucket ];
+			}
+
+			for ( int32_t Index = 0; Index < KeysNum; Index++ )
+			{
+				Destination[ Offsets[ ( Source[ Index ].Key >> Shift ) & 0xFF ]++ ] = Source[ Index ];
+			}
+
+			std::swap( Source, Destination );
+		}
+
+		if ( Source != GetData( Keys ) )
+		{
+			Keys = std::move( Scratch );
+		}
+	}
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "ContainerTraits.h"
+#include <vector>
+
+namespace InventorySortingCore
+{
+	struct FSortedViewNode
+	{
+		int32_t Left = -1;
+		int32_t Right = -1;
+		int32_t Size = 1;
+	};
+
+	/**
+	 * Item indices in sorted order, kept up to date one item at a time instead of re-sorting.
+	 * It is a treap: node I belongs to item I, the nodes are ordered by the comparator passed to Insert and
+	 * Remove and heap-ordered by a priority hashed from the index, which keeps the tree balanced in expectation.
+	 * Every node knows the size of its subtree, so the item at any rank is found in O(log n).
+	 * The comparator takes two item indices and must never report two different items as equal,
+	 * so ties are broken by index. NodeContainerType holds FSortedViewNode
+	 */
+	template <typename NodeContainerType>
+	class TSortedView
+	{
+	public:
+		static constexpr int32_t NoNode = -1;
+
+		void Reset()
+		{
+			ResetContainer( Nodes );
+			Root = NoNode;
+		}
+
+		int32_t Num() const
+		{
+			return GetSize( Root );
+		}
+
+		// Builds the view in O(n) from item indices that are already in sorted order
+		template <typename IndexContainerType>
+		void Build(const IndexContainerType& SortedIndices)
+		{
+			Reset();
+			const int32_t* Indices = GetData( SortedIndices );
+			const int32_t IndicesNum = GetNum( SortedIndices );
+			for ( int32_t Position = 0; Position < IndicesNum; Position++ )
+			{
+				if ( GetNum( Nodes ) <= Indices[ Position ] )
+				{
+					SetNum( Nodes, Indices[ Position ] + 1 );
+				}
+			}
+
+			// Cartesian tree construction: the stack holds the right spine of the tree built so far. A node is
+			// popped once a later node with a higher priority takes it as left child, so its subtree is complete
+			// and its size final
+			FSortedViewNode* NodesData = GetData( Nodes );
+			std::vector<int32_t> Spine;
+			for ( int32_t Position = 0; Position < IndicesNum; Position++ )
+			{
+				const int32_t ItemIndex = Indices[ Position ];
+				NodesData[ ItemIndex ] = FSortedViewNode();
+
+				int32_t LastPopped = NoNode;
+				while ( !Spine.empty() && GetPriority( Spine.back() ) < GetPriority( ItemIndex ) )
+				{
+					LastPopped = Spine.back();
+					Spine.pop_back();
+					UpdateSize( LastPopped );
+				}
+
+				NodesData[ ItemIndex ].Left = LastPopped;
+				if ( !Spine.empty() )
+				{
+					NodesData[ Spine.back() ].Right = ItemIndex;
+				}
+				Spine.push_back( ItemIndex );
+			}
+
+			while ( !Spine.empty() )
+			{
+				Root = Spine.back();
+				Spine.pop_back();
+				UpdateSize( Root );
+			}
+		}
+
+		template <typename F>
+		void Insert(int32_t ItemIndex, F Less)
+		{
+			if ( GetNum( Nodes ) <= ItemIndex )
+			{
+				SetNum( Nodes, ItemIndex + 1 );
+			}
+			Root = InsertNode( Root, ItemIndex, Less );
+		}
+
+		// The item has to be in the view and compare the same way as when it was inserted
+		template <typename F>
+		void Remove(int32_t ItemIndex, F Less)
+		{
+			Root = RemoveNode( Root, ItemIndex, Less );
+		}
+
+		// Appends up to Count item indices, starting with the item at rank First, in O(log n + Count)
+		template <typename IndexContainerType>
+		void GetPage(int32_t First, int32_t Count, IndexContainerType& OutIndices) const
+		{
+			// Walking down to rank First leaves every node that still has to be visited, in order, on the stack
+			std::vector<int32_t> Stack;
+			int32_t Node = Root;
+			int32_t Rank = First;
+			while ( Node != NoNode )
+			{
+				const int32_t LeftSize = GetSize( GetNode( Node ).Left );
+				if ( Rank < LeftSize )
+				{
+					Stack.push_back( Node );
+					Node = GetNode( Node ).Left;
+				}
+				else if ( Rank == LeftSize )
+				{
+					Stack.push_back( Node );
+					break;
+				}
+				else
+				{
+					Rank -= LeftSize + 1;
+					Node = GetNode( Node ).Right;
+				}
+			}
+
+			for ( ; 0 < Count && !Stack.empty(); Count-- )
+			{
+				Node = Stack.back();
+				Stack.pop_back();
+				AddElement( OutIndices, Node );
+
+				for ( Node = GetNode( Node ).Right; Node != NoNode; Node = GetNode( Node ).Left )
+				{
+					Stack.push_back( Node );
+				}
+			}
+		}
+
+	private:
+		static uint32_t GetPriority(int32_t Node)
+		{
+			// Finalizer of MurmurHash3, so neighbouring indices get unrelated priorities
+			uint32_t Hash = static_cast<uint32_t>( Node );
+			Hash ^= Hash >> 16;
+			Hash *= 0x85EBCA6Bu;
+			Hash ^= Hash >> 13;
+			Hash *= 0xC2B2AE35u;
+			Hash ^= Hash >> 16;
+			return Hash;
+		}
+
+		FSortedViewNode& GetNode(int32_t Node)
+		{
+			return GetData( Nodes )[ Node ];
+		}
+
+		const FSortedViewNode& GetNode(int32_t Node) const
+		{
+			return GetData( Nodes )[ Node ];
+		}
+
+		int32_t GetSize(int32_t Node) const
+		{
+			return Node == NoNode ? 0 : GetNode( Node ).Size;
+		}
+
+		void UpdateSize(int32_t Node)
+		{
+			GetNode( Node ).Size = 1 + GetSize( GetNode( Node ).Left ) + GetSize( GetNode( Node ).Right );
+		}
+
+		int32_t RotateLeftChildUp(int32_t Node)
+		{
+			const int32_t Child = GetNode( Node ).Left;
+			GetNode( Node ).Left = GetNode( Child ).Right;
+			GetNode( Child ).Right = Node;
+			UpdateSize( Node );
+			UpdateSize( Child );
+			return Child;
+		}
+
+		int32_t RotateRightChildUp(int32_t Node)
+		{
+			const int32_t Child = GetNode( Node ).Right;
+			GetNode( Node ).Right = GetNode( Child ).Left;
+			GetNode( Child ).Left = Node;
+			UpdateSize( Node );
+			UpdateSize( Child );
+			return Child;
+		}
+
+		// Joins two subtrees where every node of Left comes before every node of Right
+		int32_t MergeNodes(int32_t Left, int32_t Right)
+		{
+			if ( Left == NoNode )
+			{
+				return Right;
+			}
+			if ( Right == NoNode )
+			{
+				return Left;
+			}
+
+			if ( GetPriority( Right ) < GetPriority( Left ) )
+			{
+				GetNode( Left ).Right = MergeNodes( GetNode( Left ).Right, Right );
+				UpdateSize( Left );
+				return Left;
+			}
+
+			GetNode( Right ).Left = MergeNodes( Left, GetNode( Right ).Left );
+			UpdateSize( Right );
+			return Right;
+		}
+
+		// Each returns the new root of the subtree
+		template <typename F>
+		int32_t InsertNode(int32_t Node, int32_t ItemIndex, F& Less)
+		{
+			if ( Node == NoNode )
+			{
+				GetNode( ItemIndex ) = FSortedViewNode();
+				return ItemIndex;
+			}
+
+			if ( Less( ItemIndex, Node ) )
+			{
+				const int32_t Child = InsertNode( GetNode( Node ).Left, ItemIndex, Less );
+				GetNode( Node ).Left = Child;
+				if ( GetPriority( Node ) < GetPriority( Child ) )
+				{
+					return RotateLeftChildUp( Node );
+				}
+			}
+			else
+			{
+				const int32_t Child = InsertNode( GetNode( Node ).Right, ItemIndex, Less );
+				GetNode( Node ).Right = Child;
+				if ( GetPriority( Node ) < GetPriority( Child ) )
+				{
+					return RotateRightChildUp( Node );
+				}
+			}
+
+			UpdateSize( Node );
+			return Node;
+		}
+
+		template <typename F>
+		int32_t RemoveNode(int32_t Node, int32_t ItemIndex, F& Less)
+		{
+			if ( Node == NoNode )
+			{
+				return NoNode;
+			}
+
+			if ( Node == ItemIndex )
+			{
+				return MergeNodes( GetNode( Node ).Left, GetNode( Node ).Right );
+			}
+
+			if ( Less( ItemIndex, Node ) )
+			{
+				const int32_t Child = RemoveNode( GetNode( Node ).Left, ItemIndex, Less );
+				GetNode( Node ).Left = Child;
+			}
+			else
+			{
+				const int32_t Child = RemoveNode( GetNode( Node ).Right, ItemIndex, Less );
+				GetNode( Node ).Right = Child;
+			}
+
+			UpdateSize( Node );
+			return Node;
+		}
+
+		NodeContainerType Nodes;
+		int32_t Root = NoNode;
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "InventoryCore.h"
+#include "InventoryFile.h"
+#include <algorithm>
+#include <string>
+
+namespace InventorySortingCore
+{
+	struct FStdInventoryItem
+	{
+		std::string Name;
+		int32_t Value = 0;
+	};
+
+	// Inventory of standard library types, sorted on std::threads. Names compare case-insensitively
+	// in ASCII, like engine names do
+	struct FStdInventoryTraits
+	{
+		using ItemType = FStdInventoryItem;
+		using NameType = std::string;
+
+		template <typename T>
+		using TContainer = std::vector<T>;
+
+		using FNameHash = std::hash<std::string>;
+		using FNameEqual = std::equal_to<std::string>;
+		using FExactNameHash = std::hash<std::string>;
+		using FExactNameEqual = std::equal_to<std::string>;
+
+		static const std::string& GetName(const FStdInventoryItem& Item)
+		{
+			return Item.Name;
+		}
+
+		static int32_t GetValue(const FStdInventoryItem& Item)
+		{
+			return Item.Value;
+		}
+
+		static void SetValue(FStdInventoryItem& Item, int32_t Value)
+		{
+			Item.Value = Value;
+		}
+
+		static void AppendNameUtf8(const std::string& Name, std::string& Out)
+		{
+			Out += Name;
+		}
+
+		static std::string MakeName(std::string_view Utf8Name)
+		{
+			return std::string( Utf8Name );
+		}
+
+		static FStdInventoryItem MakeItem(const std::string& Name, int32_t Value)
+		{
+			return { Name, Value };
+		}
+
+		static int32_t CompareNames(const std::string& Left, const std::string& Right)
+		{
+			const size_t CommonNum = std::min( Left.size(), Right.size() );
+			for ( size_t Index = 0; Index < CommonNum; Index++ )
+			{
+				const int32_t LeftChar = ToLowerAscii( Left[ Index ] );
+				const int32_t RightChar = ToLowerAscii( Right[ Index ] );
+				if ( LeftChar != RightChar )
+				{
+					return LeftChar - RightChar;
+				}
+			}
+			return Left.size() < Right.size() ? -1 : ( Right.size() < Left.size() ? 1 : 0 );
+		}
+
+		static int32_t GetTasksNum()
+		{
+			return GetStdTasksNum();
+		}
+
+		template <typename F>
+		static void ParallelFor(int32_t Num, F&& Body)
+		{
+			FStdParallelFor()( Num, std::forward<F>( Body ) );
+		}
+
+	private:
+		static int32_t ToLowerAscii(char Char)
+		{
+			const int32_t Code = static_cast<unsigned char>( Char );
+			return 'A' <= Code && Code <= 'Z' ? Code + ( 'a' - 'A' ) : Code;
+		}
+	};
+
+	using FStdInventoryCore = TInventoryCore<FStdInventoryTraits>;
+}
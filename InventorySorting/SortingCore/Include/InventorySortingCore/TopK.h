@@ -0,0 +1,45 @@
+#pragma once
+
+#include "MergeSort.h"
+#include <algorithm>
+
+namespace InventorySortingCore
+{
+	// Appends to OutIndices the first Count of the indices 0 .. Num - 1 in the order given by ComesBefore,
+	// without sorting the rest: a heap of the best Count indices seen so far is kept, O(n log Count).
+	// ComesBefore has to break ties between different indices, e.g. by the index itself
+	template <typename IndexContainerType, typename F>
+	void GetTopIndices(int32_t Num, int32_t Count, F ComesBefore, IndexContainerType& OutIndices)
+	{
+		Count = std::min( Count, Num );
+		if ( Count <= 0 )
+		{
+			return;
+		}
+
+		// A max heap by ComesBefore keeps the worst of the kept indices on top, ready to be replaced
+		IndexContainerType Heap;
+		ReserveContainer( Heap, Count );
+		for ( int32_t Index = 0; Index < Num; Index++ )
+		{
+			if ( GetNum( Heap ) < Count )
+			{
+				AddElement( Heap, Index );
+				std::push_heap( GetData( Heap ), GetData( Heap ) + GetNum( Heap ), ComesBefore );
+			}
+			else if ( ComesBefore( Index, GetData( Heap )[ 0 ] ) )
+			{
+				int32_t* HeapData = GetData( Heap );
+				std::pop_heap( HeapData, HeapData + Count, ComesBefore );
+				HeapData[ Count - 1 ] = Index;
+				std::push_heap( HeapData, HeapData + Count, ComesBefore );
+			}
+		}
+
+		SortArray( Heap, ComesBefore );
+		for ( int32_t Position = 0; Position < Count; Position++ )
+		{
+			AddElement( OutIndices, GetData( Heap )[ Position ] );
+		}
+	}
+}
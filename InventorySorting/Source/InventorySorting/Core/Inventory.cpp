@@ -1,37 +1,398 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Inventory.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+UInventory::FInventoryCore& UInventory::GetCore() const
+{
+	Core.SortMode = static_cast<InventorySortingCore::ESortMode>( SortMode );
+	Core.bAllowParallelSort = bAllowParallelSort;
+	return Core;
+}
+
+bool UInventory::AreItemsScriptWritable() const
+{
+	return !GetClass()->HasAnyClassFlags( CLASS_Native );
+}
+
+uint64 UInventory::GetItemFingerprint(const FInventoryItem& Item)
+{
+	return static_cast<uint64>( GetTypeHash( Item.Name ) ) << 32 | static_cast<uint32>( Item.Value );
+}
+
+void UInventory::CheckScriptItemWrites()
+{
+	if ( !AreItemsScriptWritable() )
+	{
+		return;
+	}
+
+	bool bMatches = ItemFingerprints.Num() == Items.Num();
+	for ( int32 Index = 0; bMatches && Index < Items.Num(); Index++ )
+	{
+		bMatches = ItemFingerprints[ Index ] == GetItemFingerprint( Items[ Index ] );
+	}
+	if ( bMatches )
+	{
+		return;
+	}
+
+	GetCore().InvalidateSortedViews();
+	ItemFingerprints.SetNumUninitialized( Items.Num() );
+	for ( int32 Index = 0; Index < Items.Num(); Index++ )
+	{
+		ItemFingerprints[ Index ] = GetItemFingerprint( Items[ Index ] );
+	}
+}
+
+// The changes below keep the views up to date, so the fingerprints follow them, after a check that the views
+// still match the items they are about to be compared with
 
 void UInventory::AddItem(const FInventoryItem& Item)
 {
-	Items.Add( Item );
+	CheckScriptItemWrites();
+	GetCore().AddItem( Items, Item );
+	if ( AreItemsScriptWritable() )
+	{
+		ItemFingerprints.Add( GetItemFingerprint( Item ) );
+	}
 }
 
-void UInventory::DisplayInventory()
+void UInventory::SetItems(const TArray<FInventoryItem>& NewItems)
+{
+	Items = NewItems;
+	GetCore().InvalidateSortedViews();
+}
+
+void UInventory::RemoveItem(int32 Index)
 {
-	FString SeparationLine{"----------------"};
-	UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+	CheckScriptItemWrites();
+	GetCore().RemoveItem( Items, Index );
+	if ( AreItemsScriptWritable() && ItemFingerprints.IsValidIndex( Index ) )
+	{
+		// The core moves the last item into the place of the removed one too
+		ItemFingerprints.RemoveAtSwap( Index );
+	}
+}
 
-	for ( auto Item : Items )
+void UInventory::SetItemValue(int32 Index, int32 Value)
+{
+	CheckScriptItemWrites();
+	GetCore().SetItemValue( Items, Index, Value );
+	if ( AreItemsScriptWritable() && Items.IsValidIndex( Index ) )
 	{
-		UE_LOG( LogTemp, Warning, TEXT( "%s" ), *Item.ToString() );
+		ItemFingerprints[ Index ] = GetItemFingerprint( Items[ Index ] );
 	}
+}
 
-	UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+TArray<int32> UInventory::GetSortedPageByName(int32 First, int32 Count)
+{
+	CheckScriptItemWrites();
+	TArray<int32> Indices;
+	GetCore().GetSortedPageByName( Items, First, Count, Indices );
+	return Indices;
 }
 
-void UInventory::SortItemsByName_Implementation()
+TArray<int32> UInventory::GetSortedPageByValue(int32 First, int32 Count)
 {
-	SortItemsArrayPart( 0, Items.Num() - 1, [](const FInventoryItem& Left, const FInventoryItem& Right)
+	CheckScriptItemWrites();
+	TArray<int32> Indices;
+	GetCore().GetSortedPageByValue( Items, First, Count, Indices );
+	return Indices;
+}
+
+void UInventory::InvalidateSortedViews()
+{
+	GetCore().InvalidateSortedViews();
+}
+
+namespace
+{
+	// Logs one line per item, DisplayLinesPerLog lines per log call; GetItem returns null for lines to leave empty
+	template <typename F>
+	void DisplayItems(FString& DisplayBuffer, int32 ItemsNum, F GetItem)
+	{
+		// Nothing is formatted when the lines would be thrown away
+		if ( !UE_LOG_ACTIVE( LogTemp, Warning ) )
+		{
+			return;
+		}
+
+		FString SeparationLine{"----------------"};
+		UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+
+		DisplayBuffer.Reset();
+		for ( int32 Line = 0; Line < ItemsNum; Line++ )
+		{
+			if ( 0 < Line && Line % UInventory::DisplayLinesPerLog == 0 )
+			{
+				UE_LOG( LogTemp, Warning, TEXT( "%s" ), *DisplayBuffer );
+				DisplayBuffer.Reset();
+			}
+			else if ( 0 < Line )
+			{
+				DisplayBuffer.AppendChar( TEXT( '\n' ) );
+			}
+
+			if ( const FInventoryItem* Item = GetItem( Line ) )
+			{
+				Item->AppendToString( DisplayBuffer );
+			}
+		}
+
+		if ( 0 < ItemsNum )
+		{
+			UE_LOG( LogTemp, Warning, TEXT( "%s" ), *DisplayBuffer );
+		}
+
+		UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+	}
+}
+
+void UInventory::DisplayInventory()
+{
+	DisplayItemRange( 0, Items.Num() );
+}
+
+void UInventory::DisplayItemRange(int32 First, int32 Count)
+{
+	First = FMath::Clamp( First, 0, Items.Num() );
+	Count = FMath::Clamp( Count, 0, Items.Num() - First );
+	DisplayItems( DisplayBuffer, Count, [this, First](int32 Line) -> const FInventoryItem* { return &Items[ First + Line ]; } );
+}
+
+void UInventory::DisplayItemsAt(const TArray<int32>& Indices)
+{
+	DisplayItems( DisplayBuffer, Indices.Num(), [this, &Indices](int32 Line) -> const FInventoryItem*
 	{
-		return Left.Name < Right.Name;
+		return Items.IsValidIndex( Indices[ Line ] ) ? &Items[ Indices[ Line ] ] : nullptr;
 	} );
 }
 
+void UInventory::WriteCsv(FString& Out, int32 First, int32 Count) const
+{
+	First = FMath::Clamp( First, 0, Items.Num() );
+	Count = FMath::Clamp( Count, 0, Items.Num() - First );
+
+	// About 16 characters per line, so most exports never grow the string twice
+	Out.Reserve( Out.Len() + 16 * ( Count + 1 ) );
+	Out.Append( TEXT( "Name,Value\n" ) );
+
+	for ( int32 Index = First; Index < First + Count; Index++ )
+	{
+		const FString& Name = Items[ Index ].Name;
+
+		// Quoted only when the name would otherwise break the line apart, quotes inside are doubled
+		int32 SpecialCharIndex;
+		if ( Name.FindChar( TEXT( ',' ), SpecialCharIndex ) || Name.FindChar( TEXT( '"' ), SpecialCharIndex ) || Name.FindChar( TEXT( '\n' ), SpecialCharIndex ) )
+		{
+			Out.AppendChar( TEXT( '"' ) );
+			Out.Append( Name.Replace( TEXT( "\"" ), TEXT( "\"\"" ) ) );
+			Out.AppendChar( TEXT( '"' ) );
+		}
+		else
+		{
+			Out.Append( Name );
+		}
+
+		Out.AppendChar( TEXT( ',' ) );
+		Out.AppendInt( Items[ Index ].Value );
+		Out.AppendChar( TEXT( '\n' ) );
+	}
+}
+
+namespace
+{
+	void AppendUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		for ( int32 Byte = 0; Byte < 4; Byte++ )
+		{
+			Out.Add( static_cast<uint8>( Value >> ( Byte * 8 ) ) );
+		}
+	}
+}
+
+void UInventory::WriteBinary(TArray<uint8>& Out, int32 First, int32 Count) const
+{
+	constexpr uint32 Magic = 'I' | 'N' << 8 | 'V' << 16 | 'D' << 24;
+	constexpr uint32 Version = 1;
+
+	First = FMath::Clamp( First, 0, Items.Num() );
+	Count = FMath::Clamp( Count, 0, Items.Num() - First );
+
+	Out.Reserve( Out.Num() + 12 + 24 * Count );
+	AppendUInt32( Out, Magic );
+	AppendUInt32( Out, Version );
+	AppendUInt32( Out, static_cast<uint32>( Count ) );
+
+	for ( int32 Index = First; Index < First + Count; Index++ )
+	{
+		const FString& Name = Items[ Index ].Name;
+
+		const FTCHARToUTF8 Utf8Name( *Name );
+		AppendUInt32( Out, static_cast<uint32>( Utf8Name.Length() ) );
+		Out.Append( reinterpret_cast<const uint8*>( Utf8Name.Get() ), Utf8Name.Length() );
+		AppendUInt32( Out, static_cast<uint32>( Items[ Index ].Value ) );
+	}
+}
+
+bool UInventory::ExportInventory(const FString& FilePath, EInventoryExportFormat Format) const
+{
+	if ( Format == EInventoryExportFormat::Csv )
+	{
+		FString Csv;
+		WriteCsv( Csv, 0, Items.Num() );
+		return FFileHelper::SaveStringToFile( Csv, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM );
+	}
+
+	TArray<uint8> Bytes;
+	WriteBinary( Bytes, 0, Items.Num() );
+	return FFileHelper::SaveArrayToFile( Bytes, *FilePath );
+}
+
+namespace
+{
+	// Sinks of the compact file writer
+	struct FFileHandleSink
+	{
+		IFileHandle& File;
+
+		bool Write(const void* Data, size_t Size)
+		{
+			return File.Write( static_cast<const uint8*>( Data ), static_cast<int64>( Size ) );
+		}
+	};
+
+	struct FByteArraySink
+	{
+		TArray<uint8>& Bytes;
+
+		bool Write(const void* Data, size_t Size)
+		{
+			Bytes.Append( static_cast<const uint8*>( Data ), static_cast<int32>( Size ) );
+			return true;
+		}
+	};
+}
+
+bool UInventory::SaveToFile(const FString& FilePath) const
+{
+	TUniquePtr<IFileHandle> File( FPlatformFileManager::Get().GetPlatformFile().OpenWrite( *FilePath ) );
+	if ( !File )
+	{
+		return false;
+	}
+
+	FFileHandleSink Sink{ *File };
+	InventorySortingCore::TInventoryFileWriter<FUnrealInventoryTraits, FFileHandleSink> Writer( Sink );
+	Writer.AddItems( Items );
+	return Writer.Finish() && File->Flush();
+}
+
+bool UInventory::LoadFromFile(const FString& FilePath)
+{
+	// The region has to be unmapped before the file is closed, so it is declared after it
+	TUniquePtr<IMappedFileHandle> MappedFile( FPlatformFileManager::Get().GetPlatformFile().OpenMapped( *FilePath ) );
+	if ( MappedFile )
+	{
+		TUniquePtr<IMappedFileRegion> Region( MappedFile->MapRegion() );
+		if ( Region )
+		{
+			return LoadFromMemory( Region->GetMappedPtr(), Region->GetMappedSize() );
+		}
+	}
+
+	// Platforms without mapping read the file into memory first
+	TArray<uint8> Bytes;
+	if ( !FFileHelper::LoadFileToArray( Bytes, *FilePath ) )
+	{
+		return false;
+	}
+	return LoadFromMemory( Bytes.GetData(), Bytes.Num() );
+}
+
+void UInventory::SaveToMemory(TArray<uint8>& Out) const
+{
+	FByteArraySink Sink{ Out };
+	InventorySortingCore::TInventoryFileWriter<FUnrealInventoryTraits, FByteArraySink> Writer( Sink );
+	Writer.AddItems( Items );
+	Writer.Finish();
+}
+
+bool UInventory::LoadFromMemory(const uint8* Data, int64 Size)
+{
+	TArray<FInventoryItem> LoadedItems;
+	if ( !InventorySortingCore::ReadInventoryFile<FUnrealInventoryTraits>( Data, static_cast<size_t>( Size ), LoadedItems ) )
+	{
+		return false;
+	}
+
+	Items = MoveTemp( LoadedItems );
+	GetCore().InvalidateSortedViews();
+	return true;
+}
+
+void UInventory::SortItemsByName_Implementation()
+{
+	GetCore().SortByName( Items );
+	LogSortStats( TEXT( "name" ) );
+}
+
 void UInventory::SortItemsByValue_Implementation()
 {
-	SortItemsArrayPart( 0, Items.Num() - 1, [](const FInventoryItem& Left, const FInventoryItem& Right)
+	GetCore().SortByValue( Items );
+	LogSortStats( TEXT( "value" ) );
+}
+
+void UInventory::SortItemsByFields(const TArray<FInventorySortFieldOrder>& Fields)
+{
+	GetCore().SortByFields( Items, Fields );
+	LogSortStats( TEXT( "fields" ) );
+}
+
+FInventorySortStats UInventory::GetLastSortStats() const
+{
+	const InventorySortingCore::FSortStats& CoreStats = Core.GetLastSortStats();
+
+	FInventorySortStats Stats;
+	Stats.Strategy = static_cast<EInventorySortMode>( CoreStats.Strategy );
+	Stats.ItemsNum = CoreStats.ItemsNum;
+	Stats.RunsNum = CoreStats.RunsNum;
+	Stats.Milliseconds = static_cast<float>( CoreStats.Seconds * 1000.0 );
+	return Stats;
+}
+
+void UInventory::LogSortStats(const TCHAR* Order) const
+{
+	if ( !bLogSortStats )
 	{
-		return Left.Value < Right.Value;
-	} );
+		return;
+	}
+
+	const FInventorySortStats Stats = GetLastSortStats();
+	UE_LOG( LogTemp, Display, TEXT( "Sorted %d items by %s with %s in %.3f ms, %d runs found" ), Stats.ItemsNum, Order,
+		*UEnum::GetValueAsString( Stats.Strategy ), Stats.Milliseconds, Stats.RunsNum );
+}
+
+TArray<int32> UInventory::GetTopItemIndices(const TArray<FInventorySortFieldOrder>& Fields, int32 Count) const
+{
+	TArray<int32> Indices;
+	GetCore().GetTopItemIndices( Items, Fields, Count, Indices );
+	return Indices;
+}
+
+TArray<int32> UInventory::GetSortedIndicesByName() const
+{
+	TArray<int32> Indices;
+	GetCore().GetSortedIndicesByName( Items, Indices );
+	return Indices;
+}
+
+TArray<int32> UInventory::GetSortedIndicesByValue() const
+{
+	TArray<int32> Indices;
+	GetCore().GetSortedIndicesByValue( Items, Indices );
+	return Indices;
 }
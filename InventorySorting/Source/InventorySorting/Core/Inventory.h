@@ -4,13 +4,79 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "Async/ParallelFor.h"
+#include "InventorySortingCore/InventoryCore.h"
+#include "InventorySortingCore/InventoryFile.h"
+#include <functional>
+#include <type_traits>
 #include "Inventory.generated.h"
 
+namespace InventorySortingCore
+{
+	// Lets the core sort engine arrays directly
+	template <typename T, typename AllocatorType>
+	struct TContainerTraits<TArray<T, AllocatorType>>
+	{
+		using ContainerType = TArray<T, AllocatorType>;
+
+		static int32 Num(const ContainerType& Container)
+		{
+			return Container.Num();
+		}
+
+		// Keys and indices are overwritten right away, there is no point in zeroing them first
+		static void SetNum(ContainerType& Container, int32 Num)
+		{
+			if constexpr ( std::is_trivially_default_constructible_v<T> )
+			{
+				Container.SetNumUninitialized( Num );
+			}
+			else
+			{
+				Container.SetNum( Num );
+			}
+		}
+
+		static void Reset(ContainerType& Container)
+		{
+			Container.Reset();
+		}
+
+		static void Reserve(ContainerType& Container, int32 Num)
+		{
+			Container.Reserve( Num );
+		}
+
+		template <typename ElementType>
+		static void Add(ContainerType& Container, ElementType&& Element)
+		{
+			Container.Add( Forward<ElementType>( Element ) );
+		}
+
+		static void RemoveLast(ContainerType& Container)
+		{
+			Container.Pop();
+		}
+
+		static T* GetData(ContainerType& Container)
+		{
+			return Container.GetData();
+		}
+
+		static const T* GetData(const ContainerType& Container)
+		{
+			return Container.GetData();
+		}
+	};
+}
+
 USTRUCT( BlueprintType )
 struct FInventoryItem
 {
 	GENERATED_BODY()
 
+	// Kept as typed, for display and export. Sorts compare it case-insensitively, through a rank per
+	// distinct name cached by the inventory rather than through the string itself
 	UPROPERTY( EditDefaultsOnly, BlueprintReadWrite )
 	FString Name;
 
@@ -19,12 +85,197 @@ struct FInventoryItem
 
 	FString ToString() const
 	{
-		return Name + " " + FString::FromInt( Value );
+		FString String;
+		AppendToString( String );
+		return String;
+	}
+
+	// Formats into an existing string, so a caller reusing one buffer allocates nothing per item
+	void AppendToString(FString& Out) const
+	{
+		Out.Append( Name );
+		Out.AppendChar( TEXT( ' ' ) );
+		Out.AppendInt( Value );
 	}
 };
 
+UENUM( BlueprintType )
+enum class EInventoryExportFormat : uint8
+{
+	// "Name,Value" lines, UTF-8, names quoted when they need it
+	Csv,
+
+	// "INVD", version, item count, then per item the UTF-8 name length and bytes and the value, little-endian
+	Binary
+};
+
+UENUM( BlueprintType )
+enum class EInventorySortMode : uint8
+{
+	// The comparison sort moves the items themselves, strings included, on every merge
+	Items,
+
+	// A compact array of keys and item indices is sorted instead, then every item is moved once.
+	// Composite orders have no single key and sort the items
+	Keys,
+
+	// Merges the runs already in order, TimSort style: close to linear when few items are out of place,
+	// like after adding a few items to a sorted inventory
+	Runs,
+
+	// Introsort of the items: no scratch memory, but equal items may change their order
+	Unstable,
+
+	// One pass counts the runs already in order: few runs are merged, otherwise the keys are sorted.
+	// Never picks Unstable
+	Auto
+};
+
+// What the last sort of an inventory did
+USTRUCT( BlueprintType )
+struct FInventorySortStats
+{
+	GENERATED_BODY()
+
+	// The strategy that ran, never Auto
+	UPROPERTY( BlueprintReadOnly )
+	EInventorySortMode Strategy = EInventorySortMode::Items;
+
+	UPROPERTY( BlueprintReadOnly )
+	int32 ItemsNum = 0;
+
+	// Runs found by Auto, counted up to one past the most it would still merge; -1 if it did not look
+	UPROPERTY( BlueprintReadOnly )
+	int32 RunsNum = -1;
+
+	UPROPERTY( BlueprintReadOnly )
+	float Milliseconds = 0.0f;
+};
+
+UENUM( BlueprintType )
+enum class EInventorySortField : uint8
+{
+	Name,
+	Value
+};
+
+// One key of a composite order; later keys only decide between items equal in all earlier ones
+USTRUCT( BlueprintType )
+struct FInventorySortFieldOrder
+{
+	GENERATED_BODY()
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite )
+	EInventorySortField Field = EInventorySortField::Value;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite )
+	bool bDescending = false;
+};
+
+// How the engine-independent sorting core sees FInventoryItem: engine arrays, engine strings and the task graph
+struct FUnrealInventoryTraits
+{
+	using ItemType = FInventoryItem;
+	using NameType = FString;
+
+	template <typename T>
+	using TContainer = TArray<T>;
+
+	struct FNameHash
+	{
+		// Case-insensitive, like FString::operator==, so names that sort as equal share one rank
+		size_t operator()(const FString& Name) const
+		{
+			return GetTypeHash( Name );
+		}
+	};
+
+	using FNameEqual = std::equal_to<FString>;
+
+	// Case-sensitive, for the name table of saved files, which has to give back every name as it was spelled
+	struct FExactNameHash
+	{
+		size_t operator()(const FString& Name) const
+		{
+			return FCrc::StrCrc32( *Name );
+		}
+	};
+
+	struct FExactNameEqual
+	{
+		bool operator()(const FString& Left, const FString& Right) const
+		{
+			return Left.Equals( Right, ESearchCase::CaseSensitive );
+		}
+	};
+
+	static const FString& GetName(const FInventoryItem& Item)
+	{
+		return Item.Name;
+	}
+
+	static int32 GetValue(const FInventoryItem& Item)
+	{
+		return Item.Value;
+	}
+
+	static void SetValue(FInventoryItem& Item, int32 Value)
+	{
+		Item.Value = Value;
+	}
+
+	static void AppendNameUtf8(const FString& Name, std::string& Out)
+	{
+		const FTCHARToUTF8 Utf8Name( *Name );
+		Out.append( Utf8Name.Get(), Utf8Name.Length() );
+	}
+
+	static FString MakeName(std::string_view Utf8Name)
+	{
+		const FUTF8ToTCHAR Name( Utf8Name.data(), static_cast<int32>( Utf8Name.size() ) );
+		return FString( Name.Length(), Name.Get() );
+	}
+
+	static FInventoryItem MakeItem(const FString& Name, int32 Value)
+	{
+		FInventoryItem Item;
+		Item.Name = Name;
+		Item.Value = Value;
+		return Item;
+	}
+
+	// The same case-insensitive order as FString::operator<
+	static int32 CompareNames(const FString& Left, const FString& Right)
+	{
+		return Left.Compare( Right, ESearchCase::IgnoreCase );
+	}
+
+	static int32 GetTasksNum()
+	{
+		return FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	}
+
+	template <typename F>
+	static void ParallelFor(int32 Num, F&& Body)
+	{
+		::ParallelFor( Num, Forward<F>( Body ) );
+	}
+};
+
+// Compares items by a list of keys in order, for the comparator based sorts
+using FInventoryItemComparator = InventorySortingCore::TItemComparator<FUnrealInventoryTraits, TArray<FInventorySortFieldOrder>>;
+
+static_assert( static_cast<uint8>( EInventorySortMode::Items ) == static_cast<uint8>( InventorySortingCore::ESortMode::Items )
+	&& static_cast<uint8>( EInventorySortMode::Keys ) == static_cast<uint8>( InventorySortingCore::ESortMode::Keys )
+	&& static_cast<uint8>( EInventorySortMode::Runs ) == static_cast<uint8>( InventorySortingCore::ESortMode::Runs )
+	&& static_cast<uint8>( EInventorySortMode::Unstable ) == static_cast<uint8>( InventorySortingCore::ESortMode::Unstable )
+	&& static_cast<uint8>( EInventorySortMode::Auto ) == static_cast<uint8>( InventorySortingCore::ESortMode::Auto ), "Sort modes have to match the core" );
+static_assert( static_cast<uint8>( EInventorySortField::Name ) == static_cast<uint8>( InventorySortingCore::ESortField::Name )
+	&& static_cast<uint8>( EInventorySortField::Value ) == static_cast<uint8>( InventorySortingCore::ESortField::Value ), "Sort fields have to match the core" );
+
 /**
- *
+ * Blueprint face of the inventory. Items are kept here; sorting, sorted views and top items are done by
+ * InventorySortingCore, which does not depend on the engine and is benchmarked natively in SortingCore/
  */
 UCLASS(BlueprintType, Blueprintable)
 class INVENTORYSORTING_API UInventory : public UObject
@@ -32,6 +283,8 @@ class INVENTORYSORTING_API UInventory : public UObject
 	GENERATED_BODY()
 
 protected:
+	// Blueprint subclasses may write the items directly, e.g. a SortItemsByValue override; the sorted
+	// views notice that, see CheckScriptItemWrites
 	UPROPERTY( BlueprintReadWrite )
 	TArray<FInventoryItem> Items;
 
@@ -39,82 +292,138 @@ public:
 	UFUNCTION( BlueprintCallable )
 	void AddItem(const FInventoryItem& Item);
 
+	// Replaces every item and marks the sorted views as out of date
+	UFUNCTION( BlueprintCallable )
+	void SetItems(const TArray<FInventoryItem>& NewItems);
+
 	UFUNCTION( BlueprintCallable )
 	void DisplayInventory();
 
+	// Logs Items[ First .. First + Count - 1 ], clamped to the inventory. Lines are formatted into one
+	// reused buffer and logged DisplayLinesPerLog at a time instead of one log call per item
+	UFUNCTION( BlueprintCallable )
+	void DisplayItemRange(int32 First, int32 Count);
+
+	// Logs the items at the given indices in that order, e.g. a page from GetSortedPageByValue
+	UFUNCTION( BlueprintCallable )
+	void DisplayItemsAt(const TArray<int32>& Indices);
+
+	// Writes every item to a file, for diffing inventories offline
+	UFUNCTION( BlueprintCallable )
+	bool ExportInventory(const FString& FilePath, EInventoryExportFormat Format) const;
+
+	// Append the export formats of Items[ First .. First + Count - 1 ] to Out
+	void WriteCsv(FString& Out, int32 First, int32 Count) const;
+	void WriteBinary(TArray<uint8>& Out, int32 First, int32 Count) const;
+
+	static constexpr int32 DisplayLinesPerLog = 256;
+
+	// Saves every item in the compact format of InventorySortingCore/InventoryFile.h: each distinct name
+	// once, then a name index and a value per item. Written block by block straight to the file
+	UFUNCTION( BlueprintCallable )
+	bool SaveToFile(const FString& FilePath) const;
+
+	// Replaces the items with the ones saved in the file. The file is memory mapped where the platform
+	// allows it and read in place, with one string made per distinct name. The items are left as they
+	// were if the file cannot be read or is not a valid inventory file
+	UFUNCTION( BlueprintCallable )
+	bool LoadFromFile(const FString& FilePath);
+
+	// The same format in memory
+	void SaveToMemory(TArray<uint8>& Out) const;
+	bool LoadFromMemory(const uint8* Data, int64 Size);
+
 	UFUNCTION( BlueprintCallable, BlueprintNativeEvent )
 	void SortItemsByName();
 
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void SortItemsByValue();
 
-private:
-	template <typename F>
-	void SortItemsArrayPart(int32 LeftBorder, int32 RightBorder, F Comparator)
-	{
-		// If the left border is greater or equal to the right border, then the array can be considered already sorted
-		if ( RightBorder <= LeftBorder )
-		{
-			return;
-		}
+	// Sorted orders without moving any item: Items[ Indices[ 0 ] ] is the first item in that order
+	UFUNCTION( BlueprintCallable )
+	TArray<int32> GetSortedIndicesByName() const;
 
-		// Dividing the array into two parts and sorting them separately
-		int32 MidBorder = LeftBorder + ( RightBorder - LeftBorder ) / 2;
-		SortItemsArrayPart( LeftBorder, MidBorder, Comparator );
-		SortItemsArrayPart( MidBorder + 1, RightBorder, Comparator );
+	UFUNCTION( BlueprintCallable )
+	TArray<int32> GetSortedIndicesByValue() const;
 
-		// Merging two sorted parts
-		MergeTwoSortedItemArrayParts( LeftBorder, MidBorder, RightBorder, Comparator );
-	};
+	// Sort by several keys, e.g. value descending, then name. Stable unless SortMode is Unstable
+	UFUNCTION( BlueprintCallable )
+	void SortItemsByFields(const TArray<FInventorySortFieldOrder>& Fields);
 
-	template <typename F>
-	void MergeTwoSortedItemArrayParts(int32 LeftBorder, int32 MidBorder, int32 RightBorder, F Comparator)
-	{
-		// Copying the left and right parts to separate arrays
-		TArray<FInventoryItem> LeftPart;
-		TArray<FInventoryItem> RightPart;
+	// Indices of the first Count items in the order given by Fields, without sorting the rest: a heap of
+	// the best Count items seen so far is kept, O(n log Count). Items equal in every key are in item order,
+	// so the result is the start of what SortItemsByFields would produce
+	UFUNCTION( BlueprintCallable )
+	TArray<int32> GetTopItemIndices(const TArray<FInventorySortFieldOrder>& Fields, int32 Count) const;
 
-		for ( int32 Index = LeftBorder; Index <= MidBorder; Index++ )
-		{
-			LeftPart.Add( Items[ Index ] );
-		}
+	// Removes the item by moving the last item into its place
+	UFUNCTION( BlueprintCallable )
+	void RemoveItem(int32 Index);
 
-		for ( int32 Index = MidBorder + 1; Index <= RightBorder; Index++ )
-		{
-			RightPart.Add( Items[ Index ] );
-		}
+	UFUNCTION( BlueprintCallable )
+	void SetItemValue(int32 Index, int32 Value);
 
-		// Merging the left and right parts using provided comparator
+	// Up to Count item indices in sorted order, starting with the item at rank First. The sorted views
+	// are built by the first call and then kept up to date by AddItem, RemoveItem and SetItemValue in
+	// O(log n) each, so showing a sorted page costs O(log n + Count) instead of a full sort. In a Blueprint
+	// subclass, which may change Items directly, every call also costs one pass over the items to find such changes
+	UFUNCTION( BlueprintCallable )
+	TArray<int32> GetSortedPageByName(int32 First, int32 Count);
 
-		int32 CurrentLeftItemIndex = 0;
-		int32 CurrentRightItemIndex = 0;
+	UFUNCTION( BlueprintCallable )
+	TArray<int32> GetSortedPageByValue(int32 First, int32 Count);
 
-		int32 CurrentMainItemIndex = LeftBorder;
+	// Marks the sorted views as out of date, for native code that changes Items other than through this class
+	UFUNCTION( BlueprintCallable )
+	void InvalidateSortedViews();
 
-		while ( CurrentLeftItemIndex < LeftPart.Num() && CurrentRightItemIndex < RightPart.Num() )
-		{
-			if ( Comparator( LeftPart[ CurrentLeftItemIndex ], RightPart[ CurrentRightItemIndex ] ) )
-			{
-				Items[ CurrentMainItemIndex++ ] = LeftPart[ CurrentLeftItemIndex++ ];
-			}
-			else
-			{
-				Items[ CurrentMainItemIndex++ ] = RightPart[ CurrentRightItemIndex++ ];
-			}
-		}
+	UPROPERTY( EditDefaultsOnly, BlueprintReadWrite )
+	EInventorySortMode SortMode = EInventorySortMode::Auto;
 
-		// Copying the remaining items from the left and right parts
+	// Which strategy the last native sort ran, on how many items and how long it took
+	UFUNCTION( BlueprintCallable )
+	FInventorySortStats GetLastSortStats() const;
 
-		while ( CurrentLeftItemIndex < LeftPart.Num() )
-		{
-			Items[ CurrentMainItemIndex++ ] = LeftPart[ CurrentLeftItemIndex++ ];
-		}
+	// Logs the stats after every native sort
+	UPROPERTY( EditDefaultsOnly, BlueprintReadWrite )
+	bool bLogSortStats = false;
 
-		while ( CurrentRightItemIndex < RightPart.Num() )
-		{
-			Items[ CurrentMainItemIndex++ ] = RightPart[ CurrentRightItemIndex++ ];
-		}
-	};
+	// Comparison sorts of at least 2 * InventorySortingCore::ParallelSortChunkMin items are split over the task graph workers.
+	// The result is the same as the single-threaded sort
+	UPROPERTY( EditDefaultsOnly, BlueprintReadWrite )
+	bool bAllowParallelSort = true;
+
+	const TArray<FInventoryItem>& GetItems() const
+	{
+		return Items;
+	}
+
+private:
+	// Kept between calls, so displaying again reuses the memory of the last display
+	FString DisplayBuffer;
+
+	using FInventoryCore = InventorySortingCore::TInventoryCore<FUnrealInventoryTraits>;
+
+	// The core with the current settings of this inventory
+	FInventoryCore& GetCore() const;
+
+	// Whether Blueprint code of this object's class can write Items behind the core's back
+	bool AreItemsScriptWritable() const;
+
+	// What the views know about an item; equal names hash equally, and case does not change the order
+	static uint64 GetItemFingerprint(const FInventoryItem& Item);
+
+	// For Blueprint subclasses: compares every item with its fingerprint from when the views last saw it,
+	// and marks the views as out of date if any differs. One pass without allocating, so a changed item is
+	// found whatever it was changed to, at far less than the rebuild it prevents
+	void CheckScriptItemWrites();
+
+	void LogSortStats(const TCHAR* Order) const;
 
+	// Only holds what is derived from Items: the sorted views and the name ranks. Mutable since
+	// the const queries refresh the name rank cache
+	mutable FInventoryCore Core;
 
+	// GetItemFingerprint of every item as the views know it, only kept for Blueprint subclasses
+	TArray<uint64> ItemFingerprints;
 };
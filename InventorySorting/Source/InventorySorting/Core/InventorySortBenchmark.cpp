@@ -0,0 +1,615 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Inventory.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+// Development benchmark for the inventory sorts, run from the console:
+//   Inventory.BenchmarkSort [ItemsNum...]
+// Without arguments it measures 10k, 100k and 1M items. Every size is sorted by name and by value
+// with the original merge sort (copied below as the baseline) and with UInventory in every sort mode,
+// and the results are compared so a faster but wrong sort does not go unnoticed. Every sort mode is
+// also run on random items and on sorted items with 1% new ones added, as reported by GetLastSortStats.
+//   Inventory.BenchmarkExport [ItemsNum...]
+// Times DisplayInventory as it used to be against the buffered display, and the CSV and binary exports.
+// Up to 10k items are really logged by both displays; the formatting alone is measured at every size.
+//   Inventory.BenchmarkSave [ItemsNum...]
+// Times saving and loading the compact file against UInventory::Serialize, the UPROPERTY serialization
+// save games use, both through a file in the Saved directory.
+
+namespace InventorySortBenchmark
+{
+	// The item the original sort worked on, kept apart so the baseline does not change with FInventoryItem
+	struct FLegacyInventoryItem
+	{
+		FString Name;
+		int32 Value;
+	};
+
+	// The merge sort UInventory used before the scratch buffer: two new arrays per merge,
+	// items copied in and out, and the right item taken on ties
+	template <typename T, typename F>
+	void LegacyMergeTwoSortedItemArrayParts(TArray<T>& Items, int32 LeftBorder, int32 MidBorder, int32 RightBorder, F Comparator)
+	{
+		TArray<T> LeftPart;
+		TArray<T> RightPart;
+
+		for ( int32 Index = LeftBorder; Index <= MidBorder; Index++ )
+		{
+			LeftPart.Add( Items[ Index ] );
+		}
+
+		for ( int32 Index = MidBorder + 1; Index <= RightBorder; Index++ )
+		{
+			RightPart.Add( Items[ Index ] );
+		}
+
+		int32 CurrentLeftItemIndex = 0;
+		int32 CurrentRightItemIndex = 0;
+
+		int32 CurrentMainItemIndex = LeftBorder;
+
+		while ( CurrentLeftItemIndex < LeftPart.Num() && CurrentRightItemIndex < RightPart.Num() )
+		{
+			if ( Comparator( LeftPart[ CurrentLeftItemIndex ], RightPart[ CurrentRightItemIndex ] ) )
+			{
+				Items[ CurrentMainItemIndex++ ] = LeftPart[ CurrentLeftItemIndex++ ];
+			}
+			else
+			{
+				Items[ CurrentMainItemIndex++ ] = RightPart[ CurrentRightItemIndex++ ];
+			}
+		}
+
+		while ( CurrentLeftItemIndex < LeftPart.Num() )
+		{
+			Items[ CurrentMainItemIndex++ ] = LeftPart[ CurrentLeftItemIndex++ ];
+		}
+
+		while ( CurrentRightItemIndex < RightPart.Num() )
+		{
+			Items[ CurrentMainItemIndex++ ] = RightPart[ CurrentRightItemIndex++ ];
+		}
+	}
+
+	template <typename T, typename F>
+	void LegacySortItemsArrayPart(TArray<T>& Items, int32 LeftBorder, int32 RightBorder, F Comparator)
+	{
+		if ( RightBorder <= LeftBorder )
+		{
+			return;
+		}
+
+		int32 MidBorder = LeftBorder + ( RightBorder - LeftBorder ) / 2;
+		LegacySortItemsArrayPart( Items, LeftBorder, MidBorder, Comparator );
+		LegacySortItemsArrayPart( Items, MidBorder + 1, RightBorder, Comparator );
+
+		LegacyMergeTwoSortedItemArrayParts( Items, LeftBorder, MidBorder, RightBorder, Comparator );
+	}
+
+	// Names are drawn from NamesNum different ones, so inventories full of duplicates can be measured too
+	TArray<FInventoryItem> MakeRandomItems(int32 ItemsNum, int32 NamesNum, int32 Seed)
+	{
+		FRandomStream Random( Seed );
+
+		TArray<FInventoryItem> Items;
+		Items.Reserve( ItemsNum );
+		for ( int32 Index = 0; Index < ItemsNum; Index++ )
+		{
+			// Names of a realistic length with plenty of shared prefixes, values with plenty of ties
+			const int32 NameIndex = Random.RandRange( 0, NamesNum - 1 );
+			FInventoryItem Item;
+			Item.Name = FString::Printf( TEXT( "Item_%c%c_%d" ), TEXT( 'A' ) + NameIndex % 26, TEXT( 'a' ) + NameIndex / 26 % 26, NameIndex );
+			Item.Value = Random.RandRange( 0, FMath::Max( ItemsNum / 10, 1 ) );
+			Items.Add( MoveTemp( Item ) );
+		}
+		return Items;
+	}
+
+	TArray<FInventoryItem> MakeRandomItems(int32 ItemsNum, int32 Seed)
+	{
+		return MakeRandomItems( ItemsNum, ItemsNum, Seed );
+	}
+
+	TArray<FLegacyInventoryItem> MakeLegacyItems(const TArray<FInventoryItem>& Items)
+	{
+		TArray<FLegacyInventoryItem> LegacyItems;
+		LegacyItems.Reserve( Items.Num() );
+		for ( const FInventoryItem& Item : Items )
+		{
+			LegacyItems.Add( { Item.Name, Item.Value } );
+		}
+		return LegacyItems;
+	}
+
+	// Same order of both names and values; the legacy sort is not stable, so ties may differ in the other field
+	template <typename F>
+	bool HaveSameKeys(const TArray<FInventoryItem>& Left, const TArray<FLegacyInventoryItem>& Right, F SameKey)
+	{
+		if ( Left.Num() != Right.Num() )
+		{
+			return false;
+		}
+
+		for ( int32 Index = 0; Index < Left.Num(); Index++ )
+		{
+			if ( !SameKey( Left[ Index ], Right[ Index ] ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	UInventory* MakeInventory(const TArray<FInventoryItem>& Items, EInventorySortMode SortMode, bool bAllowParallelSort)
+	{
+		UInventory* Inventory = NewObject<UInventory>();
+		Inventory->SortMode = SortMode;
+		Inventory->bAllowParallelSort = bAllowParallelSort;
+		for ( const FInventoryItem& Item : Items )
+		{
+			Inventory->AddItem( Item );
+		}
+		return Inventory;
+	}
+
+	bool SameName(const FInventoryItem& Left, const FLegacyInventoryItem& Right)
+	{
+		return Left.Name == Right.Name;
+	}
+
+	bool SameValue(const FInventoryItem& Left, const FLegacyInventoryItem& Right)
+	{
+		return Left.Value == Right.Value;
+	}
+
+	struct FSortTiming
+	{
+		double Seconds = 0.0;
+		bool bMatches = true;
+	};
+
+	FSortTiming TimeInventorySort(const TArray<FInventoryItem>& SourceItems, const TArray<FLegacyInventoryItem>& Expected, EInventorySortMode SortMode, bool bAllowParallelSort, bool bByName)
+	{
+		UInventory* Inventory = MakeInventory( SourceItems, SortMode, bAllowParallelSort );
+
+		FSortTiming Timing;
+		const double StartSeconds = FPlatformTime::Seconds();
+		if ( bByName )
+		{
+			Inventory->SortItemsByName();
+		}
+		else
+		{
+			Inventory->SortItemsByValue();
+		}
+		Timing.Seconds = FPlatformTime::Seconds() - StartSeconds;
+		Timing.bMatches = HaveSameKeys( Inventory->GetItems(), Expected, bByName ? &SameName : &SameValue );
+		return Timing;
+	}
+
+	// Only the sorted index array is produced, the items stay where they are
+	FSortTiming TimeSortedIndices(const TArray<FInventoryItem>& SourceItems, const TArray<FLegacyInventoryItem>& Expected, bool bByName)
+	{
+		UInventory* Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+
+		FSortTiming Timing;
+		const double StartSeconds = FPlatformTime::Seconds();
+		const TArray<int32> Indices = bByName ? Inventory->GetSortedIndicesByName() : Inventory->GetSortedIndicesByValue();
+		Timing.Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+		TArray<FInventoryItem> Viewed;
+		Viewed.Reserve( Indices.Num() );
+		for ( int32 Index : Indices )
+		{
+			Viewed.Add( SourceItems[ Index ] );
+		}
+		Timing.bMatches = HaveSameKeys( Viewed, Expected, bByName ? &SameName : &SameValue );
+		return Timing;
+	}
+
+	void LogTiming(const TCHAR* Label, double LegacySeconds, const FSortTiming& Timing)
+	{
+		UE_LOG( LogTemp, Display, TEXT( "    %-18s %9.2f ms (x%.2f)%s" ),
+		        Label, Timing.Seconds * 1000.0, LegacySeconds / FMath::Max( Timing.Seconds, 1e-9 ), Timing.bMatches ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+	}
+
+	void RunSize(int32 ItemsNum, int32 NamesNum)
+	{
+		const TArray<FInventoryItem> SourceItems = MakeRandomItems( ItemsNum, NamesNum, ItemsNum );
+		const TArray<FLegacyInventoryItem> LegacyItems = MakeLegacyItems( SourceItems );
+
+		// Sorting by name ranks each distinct name once, so fewer distinct names make it cheaper
+		TSet<FString> DistinctNames;
+		for ( const FInventoryItem& Item : SourceItems )
+		{
+			DistinctNames.Add( Item.Name );
+		}
+		UE_LOG( LogTemp, Display, TEXT( "%d items, %d distinct names:" ), ItemsNum, DistinctNames.Num() );
+
+		auto ByName = [](const FLegacyInventoryItem& Left, const FLegacyInventoryItem& Right)
+		{
+			return Left.Name < Right.Name;
+		};
+		auto ByValue = [](const FLegacyInventoryItem& Left, const FLegacyInventoryItem& Right)
+		{
+			return Left.Value < Right.Value;
+		};
+
+		for ( bool bByName : { true, false } )
+		{
+			TArray<FLegacyInventoryItem> LegacySorted = LegacyItems;
+			const double StartSeconds = FPlatformTime::Seconds();
+			if ( bByName )
+			{
+				LegacySortItemsArrayPart( LegacySorted, 0, LegacySorted.Num() - 1, ByName );
+			}
+			else
+			{
+				LegacySortItemsArrayPart( LegacySorted, 0, LegacySorted.Num() - 1, ByValue );
+			}
+			const double LegacySeconds = FPlatformTime::Seconds() - StartSeconds;
+
+			UE_LOG( LogTemp, Display, TEXT( "  by %s: legacy %.2f ms" ), bByName ? TEXT( "name" ) : TEXT( "value" ), LegacySeconds * 1000.0 );
+			LogTiming( TEXT( "items" ), LegacySeconds, TimeInventorySort( SourceItems, LegacySorted, EInventorySortMode::Items, false, bByName ) );
+			LogTiming( TEXT( "items, parallel" ), LegacySeconds, TimeInventorySort( SourceItems, LegacySorted, EInventorySortMode::Items, true, bByName ) );
+			LogTiming( TEXT( "keys" ), LegacySeconds, TimeInventorySort( SourceItems, LegacySorted, EInventorySortMode::Keys, false, bByName ) );
+			LogTiming( TEXT( "keys, parallel" ), LegacySeconds, TimeInventorySort( SourceItems, LegacySorted, EInventorySortMode::Keys, true, bByName ) );
+			LogTiming( TEXT( "indices only" ), LegacySeconds, TimeSortedIndices( SourceItems, LegacySorted, bByName ) );
+		}
+	}
+
+	// The UI case: one item changes, then the first page in value order is shown again.
+	// Re-sorting everything each time is compared with the incrementally kept sorted view
+	void RunUpdates(int32 ItemsNum)
+	{
+		constexpr int32 PageSize = 50;
+		const TArray<FInventoryItem> SourceItems = MakeRandomItems( ItemsNum, ItemsNum );
+		const int32 MaxValue = FMath::Max( ItemsNum / 10, 1 );
+		FRandomStream Random( ItemsNum );
+
+		UInventory* Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+		constexpr int32 ResortUpdatesNum = 20;
+		double StartSeconds = FPlatformTime::Seconds();
+		for ( int32 Update = 0; Update < ResortUpdatesNum; Update++ )
+		{
+			Inventory->SetItemValue( Random.RandRange( 0, ItemsNum - 1 ), Random.RandRange( 0, MaxValue ) );
+			Inventory->SortItemsByValue();
+		}
+		const double ResortSeconds = ( FPlatformTime::Seconds() - StartSeconds ) / ResortUpdatesNum;
+
+		Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+		StartSeconds = FPlatformTime::Seconds();
+		Inventory->GetSortedPageByValue( 0, PageSize );
+		const double BuildSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		constexpr int32 ViewUpdatesNum = 10000;
+		int32 PageItemsNum = 0;
+		StartSeconds = FPlatformTime::Seconds();
+		for ( int32 Update = 0; Update < ViewUpdatesNum; Update++ )
+		{
+			Inventory->SetItemValue( Random.RandRange( 0, ItemsNum - 1 ), Random.RandRange( 0, MaxValue ) );
+			PageItemsNum += Inventory->GetSortedPageByValue( 0, PageSize ).Num();
+		}
+		const double ViewSeconds = ( FPlatformTime::Seconds() - StartSeconds ) / ViewUpdatesNum;
+
+		UE_LOG( LogTemp, Display, TEXT( "%d items, change one value and show %d: re-sort %.3f ms, sorted view %.4f ms (x%.0f, built once in %.2f ms)%s" ),
+		        ItemsNum, PageSize, ResortSeconds * 1000.0, ViewSeconds * 1000.0, ResortSeconds / FMath::Max( ViewSeconds, 1e-9 ), BuildSeconds * 1000.0,
+		        PageItemsNum == ViewUpdatesNum * FMath::Min( PageSize, ItemsNum ) ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+	}
+
+	// "Top 20 by value, ties broken by name": the heap based top-K against sorting everything by both keys
+	void RunTopItems(int32 ItemsNum)
+	{
+		constexpr int32 TopNum = 20;
+		const TArray<FInventoryItem> SourceItems = MakeRandomItems( ItemsNum, ItemsNum );
+
+		TArray<FInventorySortFieldOrder> Fields;
+		Fields.AddDefaulted_GetRef().bDescending = true;
+		Fields.AddDefaulted_GetRef().Field = EInventorySortField::Name;
+
+		UInventory* Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+		double StartSeconds = FPlatformTime::Seconds();
+		Inventory->SortItemsByFields( Fields );
+		const double SortSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+		StartSeconds = FPlatformTime::Seconds();
+		const TArray<int32> TopIndices = Inventory->GetTopItemIndices( Fields, TopNum );
+		const double TopSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		Inventory->SortItemsByFields( Fields );
+		bool bMatches = TopIndices.Num() == FMath::Min( TopNum, ItemsNum );
+		for ( int32 Rank = 0; bMatches && Rank < TopIndices.Num(); Rank++ )
+		{
+			const FInventoryItem& TopItem = SourceItems[ TopIndices[ Rank ] ];
+			bMatches = TopItem.Name == Inventory->GetItems()[ Rank ].Name && TopItem.Value == Inventory->GetItems()[ Rank ].Value;
+		}
+
+		UE_LOG( LogTemp, Display, TEXT( "%d items, top %d by value then name: full sort %.2f ms, top-K %.2f ms (x%.1f)%s" ),
+		        ItemsNum, TopNum, SortSeconds * 1000.0, TopSeconds * 1000.0, SortSeconds / FMath::Max( TopSeconds, 1e-9 ), bMatches ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+	}
+
+	// Every sort mode on random items and on the common re-sort: a sorted inventory with 1% new items added at the end.
+	// The strategy and time come from the inventory's own sort stats
+	void RunStrategies(int32 ItemsNum)
+	{
+		const TArray<FInventoryItem> RandomItems = MakeRandomItems( ItemsNum, FMath::Min( ItemsNum, 1000 ), ItemsNum );
+
+		for ( bool bByName : { true, false } )
+		{
+			UInventory* Inventory = MakeInventory( RandomItems, EInventorySortMode::Keys, true );
+			bByName ? Inventory->SortItemsByName() : Inventory->SortItemsByValue();
+			TArray<FInventoryItem> NearlySortedItems = Inventory->GetItems();
+			NearlySortedItems.Append( MakeRandomItems( ItemsNum / 100, FMath::Min( ItemsNum, 1000 ), ItemsNum + 1 ) );
+
+			for ( bool bNearlySorted : { false, true } )
+			{
+				UE_LOG( LogTemp, Display, TEXT( "%d %s items by %s:" ), ItemsNum, bNearlySorted ? TEXT( "nearly sorted" ) : TEXT( "random" ), bByName ? TEXT( "name" ) : TEXT( "value" ) );
+				for ( EInventorySortMode SortMode : { EInventorySortMode::Items, EInventorySortMode::Keys, EInventorySortMode::Runs, EInventorySortMode::Unstable, EInventorySortMode::Auto } )
+				{
+					Inventory = MakeInventory( bNearlySorted ? NearlySortedItems : RandomItems, SortMode, true );
+					bByName ? Inventory->SortItemsByName() : Inventory->SortItemsByValue();
+
+					bool bSorted = true;
+					const TArray<FInventoryItem>& Sorted = Inventory->GetItems();
+					for ( int32 Index = 1; bSorted && Index < Sorted.Num(); Index++ )
+					{
+						bSorted = bByName ? Sorted[ Index - 1 ].Name.Compare( Sorted[ Index ].Name, ESearchCase::IgnoreCase ) <= 0 : Sorted[ Index - 1 ].Value <= Sorted[ Index ].Value;
+					}
+
+					const FInventorySortStats Stats = Inventory->GetLastSortStats();
+					UE_LOG( LogTemp, Display, TEXT( "    %-30s ran %-30s %9.2f ms%s" ), *UEnum::GetValueAsString( SortMode ), *UEnum::GetValueAsString( Stats.Strategy ),
+					        Stats.Milliseconds, bSorted ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+				}
+			}
+		}
+	}
+
+	// DisplayInventory before the reusable buffer: every item copied, one temporary string and one log call per item
+	void LegacyDisplayInventory(const TArray<FInventoryItem>& Items)
+	{
+		FString SeparationLine{"----------------"};
+		UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+
+		for ( auto Item : Items )
+		{
+			UE_LOG( LogTemp, Warning, TEXT( "%s" ), *( Item.Name + " " + FString::FromInt( Item.Value ) ) );
+		}
+
+		UE_LOG( LogTemp, Warning, TEXT( "%s" ), *SeparationLine );
+	}
+
+	void RunExport(int32 ItemsNum)
+	{
+		const TArray<FInventoryItem> SourceItems = MakeRandomItems( ItemsNum, FMath::Min( ItemsNum, 1000 ), ItemsNum );
+		UInventory* Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+
+		const int32 LoggedItemsNum = FMath::Min( ItemsNum, 10000 );
+		TArray<FInventoryItem> LoggedItems( SourceItems.GetData(), LoggedItemsNum );
+		UInventory* LoggedInventory = MakeInventory( LoggedItems, EInventorySortMode::Keys, true );
+
+		double StartSeconds = FPlatformTime::Seconds();
+		LegacyDisplayInventory( LoggedItems );
+		const double LegacyLoggedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		StartSeconds = FPlatformTime::Seconds();
+		LoggedInventory->DisplayInventory();
+		const double LoggedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		UE_LOG( LogTemp, Display, TEXT( "%d items logged: legacy %.2f ms in %d log calls, buffered %.2f ms in %d (x%.2f)" ),
+		        LoggedItemsNum, LegacyLoggedSeconds * 1000.0, LoggedItemsNum + 2, LoggedSeconds * 1000.0,
+		        ( LoggedItemsNum + UInventory::DisplayLinesPerLog - 1 ) / UInventory::DisplayLinesPerLog + 2, LegacyLoggedSeconds / FMath::Max( LoggedSeconds, 1e-9 ) );
+
+		// What the display does before the log call: a copy and a new string per item, against lines
+		// appended to one buffer that is reused for every batch
+		int64 LegacyChars = 0;
+		StartSeconds = FPlatformTime::Seconds();
+		for ( auto Item : SourceItems )
+		{
+			const FString Line = Item.Name + " " + FString::FromInt( Item.Value );
+			LegacyChars += Line.Len();
+		}
+		const double LegacyFormatSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		int64 BufferedChars = 0;
+		FString Buffer;
+		StartSeconds = FPlatformTime::Seconds();
+		for ( int32 Index = 0; Index < ItemsNum; Index++ )
+		{
+			if ( Index % UInventory::DisplayLinesPerLog == 0 )
+			{
+				Buffer.Reset();
+			}
+			const int32 LineBegin = Buffer.Len();
+			SourceItems[ Index ].AppendToString( Buffer );
+			BufferedChars += Buffer.Len() - LineBegin;
+			Buffer.AppendChar( TEXT( '\n' ) );
+		}
+		const double BufferedFormatSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		UE_LOG( LogTemp, Display, TEXT( "%d items formatted for display: legacy %.2f ms, buffered %.2f ms (x%.2f)%s" ),
+		        ItemsNum, LegacyFormatSeconds * 1000.0, BufferedFormatSeconds * 1000.0, LegacyFormatSeconds / FMath::Max( BufferedFormatSeconds, 1e-9 ),
+		        LegacyChars == BufferedChars ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+
+		// Formatting alone, then formatting and writing the file
+		FString Csv;
+		StartSeconds = FPlatformTime::Seconds();
+		Inventory->WriteCsv( Csv, 0, ItemsNum );
+		const double CsvSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		TArray<uint8> Bytes;
+		StartSeconds = FPlatformTime::Seconds();
+		Inventory->WriteBinary( Bytes, 0, ItemsNum );
+		const double BinarySeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		// Every item is one line, every name at least one byte
+		int32 LinesNum = 0;
+		for ( int32 CharIndex = 0; CharIndex < Csv.Len(); CharIndex++ )
+		{
+			LinesNum += Csv[ CharIndex ] == TEXT( '\n' ) ? 1 : 0;
+		}
+		const bool bMatches = LinesNum == ItemsNum + 1 && 12 + 9 * ItemsNum <= Bytes.Num();
+
+		const FString CsvPath = FPaths::ProjectSavedDir() / TEXT( "InventoryExport.csv" );
+		const FString BinaryPath = FPaths::ProjectSavedDir() / TEXT( "InventoryExport.bin" );
+
+		StartSeconds = FPlatformTime::Seconds();
+		const bool bCsvSaved = Inventory->ExportInventory( CsvPath, EInventoryExportFormat::Csv );
+		const double CsvExportSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		StartSeconds = FPlatformTime::Seconds();
+		const bool bBinarySaved = Inventory->ExportInventory( BinaryPath, EInventoryExportFormat::Binary );
+		const double BinaryExportSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		UE_LOG( LogTemp, Display, TEXT( "%d items, export: CSV %.2f ms to format, %.2f ms with the file (%d chars), binary %.2f ms to format, %.2f ms with the file (%d bytes)%s%s" ),
+		        ItemsNum, CsvSeconds * 1000.0, CsvExportSeconds * 1000.0, Csv.Len(), BinarySeconds * 1000.0, BinaryExportSeconds * 1000.0, Bytes.Num(),
+		        bMatches ? TEXT( "" ) : TEXT( " MISMATCH" ), bCsvSaved && bBinarySaved ? TEXT( "" ) : TEXT( " NOT SAVED" ) );
+	}
+
+	bool HaveSameItems(const TArray<FInventoryItem>& Left, const TArray<FInventoryItem>& Right)
+	{
+		if ( Left.Num() != Right.Num() )
+		{
+			return false;
+		}
+
+		for ( int32 Index = 0; Index < Left.Num(); Index++ )
+		{
+			// Spelled exactly the same: FString::operator== would let a save that changes the case pass
+			if ( !Left[ Index ].Name.Equals( Right[ Index ].Name, ESearchCase::CaseSensitive ) || Left[ Index ].Value != Right[ Index ].Value )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void LogSaveTiming(const TCHAR* Label, int32 ItemsNum, double SaveSeconds, double LoadSeconds, int64 FileSize, bool bMatches)
+	{
+		UE_LOG( LogTemp, Display, TEXT( "    %-12s save %8.2f ms, load %8.2f ms, %10lld bytes (%.1f per item)%s" ),
+		        Label, SaveSeconds * 1000.0, LoadSeconds * 1000.0, static_cast<long long>( FileSize ),
+		        static_cast<double>( FileSize ) / FMath::Max( ItemsNum, 1 ), bMatches ? TEXT( "" ) : TEXT( " MISMATCH" ) );
+	}
+
+	void RunSave(int32 ItemsNum)
+	{
+		TArray<FInventoryItem> SourceItems = MakeRandomItems( ItemsNum, FMath::Min( ItemsNum, 1000 ), ItemsNum );
+
+		// Every eighth item spelled in capitals, so names that only differ in case have to survive the round trip
+		for ( int32 Index = 0; Index < SourceItems.Num(); Index += 8 )
+		{
+			SourceItems[ Index ].Name = SourceItems[ Index ].Name.ToUpper();
+		}
+		UInventory* Inventory = MakeInventory( SourceItems, EInventorySortMode::Keys, true );
+		UE_LOG( LogTemp, Display, TEXT( "%d items, 1000 distinct names and their capitalized spellings:" ), ItemsNum );
+
+		const FString CompactPath = FPaths::ProjectSavedDir() / TEXT( "InventoryBenchmark.invc" );
+		double StartSeconds = FPlatformTime::Seconds();
+		const bool bCompactSaved = Inventory->SaveToFile( CompactPath );
+		const double CompactSaveSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		UInventory* CompactLoaded = NewObject<UInventory>();
+		StartSeconds = FPlatformTime::Seconds();
+		const bool bCompactLoaded = CompactLoaded->LoadFromFile( CompactPath );
+		const double CompactLoadSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		TArray<uint8> CompactBytes;
+		Inventory->SaveToMemory( CompactBytes );
+		LogSaveTiming( TEXT( "compact" ), ItemsNum, CompactSaveSeconds, CompactLoadSeconds, CompactBytes.Num(),
+		               bCompactSaved && bCompactLoaded && HaveSameItems( SourceItems, CompactLoaded->GetItems() ) );
+
+		// The reflection based serialization a save game would use
+		const FString PropertyPath = FPaths::ProjectSavedDir() / TEXT( "InventoryBenchmark.uprop" );
+		TArray<uint8> PropertyBytes;
+		StartSeconds = FPlatformTime::Seconds();
+		{
+			FMemoryWriter MemoryWriter( PropertyBytes, true );
+			FObjectAndNameAsStringProxyArchive Archive( MemoryWriter, false );
+			Inventory->Serialize( Archive );
+		}
+		const bool bPropertySaved = FFileHelper::SaveArrayToFile( PropertyBytes, *PropertyPath );
+		const double PropertySaveSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		UInventory* PropertyLoaded = NewObject<UInventory>();
+		StartSeconds = FPlatformTime::Seconds();
+		TArray<uint8> LoadedBytes;
+		const bool bPropertyLoaded = FFileHelper::LoadFileToArray( LoadedBytes, *PropertyPath );
+		{
+			FMemoryReader MemoryReader( LoadedBytes, true );
+			FObjectAndNameAsStringProxyArchive Archive( MemoryReader, true );
+			PropertyLoaded->Serialize( Archive );
+		}
+		const double PropertyLoadSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		LogSaveTiming( TEXT( "UPROPERTY" ), ItemsNum, PropertySaveSeconds, PropertyLoadSeconds, PropertyBytes.Num(),
+		               bPropertySaved && bPropertyLoaded && HaveSameItems( SourceItems, PropertyLoaded->GetItems() ) );
+	}
+
+	TArray<int32> ParseSizes(const TArray<FString>& Arguments)
+	{
+		TArray<int32> Sizes;
+		for ( const FString& Argument : Arguments )
+		{
+			const int32 ItemsNum = FCString::Atoi( *Argument );
+			if ( 0 < ItemsNum )
+			{
+				Sizes.Add( ItemsNum );
+			}
+		}
+		if ( Sizes.Num() == 0 )
+		{
+			Sizes = { 10000, 100000, 1000000 };
+		}
+		return Sizes;
+	}
+
+	void Run(const TArray<FString>& Arguments)
+	{
+		for ( int32 ItemsNum : ParseSizes( Arguments ) )
+		{
+			RunSize( ItemsNum, ItemsNum );
+			RunSize( ItemsNum, FMath::Min( ItemsNum, 1000 ) );
+			RunStrategies( ItemsNum );
+			RunUpdates( ItemsNum );
+			RunTopItems( ItemsNum );
+		}
+	}
+
+	void RunExports(const TArray<FString>& Arguments)
+	{
+		for ( int32 ItemsNum : ParseSizes( Arguments ) )
+		{
+			RunExport( ItemsNum );
+		}
+	}
+
+	void RunSaves(const TArray<FString>& Arguments)
+	{
+		for ( int32 ItemsNum : ParseSizes( Arguments ) )
+		{
+			RunSave( ItemsNum );
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkSortCommand(
+		TEXT( "Inventory.BenchmarkSort" ),
+		TEXT( "Times the inventory sorts against the original merge sort. Usage: Inventory.BenchmarkSort [ItemsNum...]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &Run ) );
+
+	FAutoConsoleCommand BenchmarkExportCommand(
+		TEXT( "Inventory.BenchmarkExport" ),
+		TEXT( "Times DisplayInventory and the CSV and binary exports. Usage: Inventory.BenchmarkExport [ItemsNum...]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &RunExports ) );
+
+	FAutoConsoleCommand BenchmarkSaveCommand(
+		TEXT( "Inventory.BenchmarkSave" ),
+		TEXT( "Times the compact inventory file against UPROPERTY serialization. Usage: Inventory.BenchmarkSave [ItemsNum...]" ),
+		FConsoleCommandWithArgsDelegate::CreateStatic( &RunSaves ) );
+}
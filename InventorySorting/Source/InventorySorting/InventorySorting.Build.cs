@@ -1,5 +1,6 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class InventorySorting : ModuleRules
@@ -12,6 +13,9 @@ public class InventorySorting : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
+		// Header-only sorting core, shared with the native CMake build in SortingCore/
+		PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "..", "SortingCore", "Include"));
+
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
 		